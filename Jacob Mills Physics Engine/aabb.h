@@ -0,0 +1,36 @@
+#ifndef AABBH
+#define AABBH
+
+// Includes //
+#include "core.h"
+#include "vector2.h"
+
+// AABB //
+//axis aligned bounding box, used to quickly rule out pairs of shapes that can't be touching
+struct AABB
+{
+	Vector2 min;
+	Vector2 max;
+
+	bool Overlaps(const AABB &other) const
+	{
+		return min.x <= other.max.x && other.min.x <= max.x && min.y <= other.max.y && other.min.y <= max.y;
+	}
+
+	//false if the shape it was made from has blown up to infinity or NaN
+	bool IsFinite() const
+	{
+		return ::IsFinite(min.x) && ::IsFinite(min.y) && ::IsFinite(max.x) && ::IsFinite(max.y);
+	}
+
+	//the box grown by margin on every side
+	AABB Grown(const Real margin) const
+	{
+		AABB grown;
+		grown.min = Vector2(min.x - margin, min.y - margin);
+		grown.max = Vector2(max.x + margin, max.y + margin);
+		return grown;
+	}
+};
+
+#endif //AABBH
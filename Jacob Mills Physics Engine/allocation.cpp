@@ -0,0 +1,66 @@
+#include "allocation.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Counters //
+static std::atomic<uint64_t> allocations(0);
+static std::atomic<uint64_t> frees(0);
+static std::atomic<uint64_t> bytes(0);
+
+AllocationCounts GetAllocationCounts()
+{
+	AllocationCounts counts;
+	counts.allocations = allocations.load(std::memory_order_relaxed);
+	counts.frees = frees.load(std::memory_order_relaxed);
+	counts.bytes = bytes.load(std::memory_order_relaxed);
+	return counts;
+}
+
+bool IsCountingAllocations()
+{
+#ifdef PHYSICS_ALLOCATION_COUNTING
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Operator New and Delete //
+//the nothrow and array forms that aren't here all end up calling these ones
+#ifdef PHYSICS_ALLOCATION_COUNTING
+
+void* operator new( std::size_t size )
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	bytes.fetch_add(size, std::memory_order_relaxed);
+
+	//new has to give back a unique pointer even for 0 bytes
+	void *memory = malloc(size > 0 ? size : 1);
+	if (!memory)
+		throw std::bad_alloc();
+
+	return memory;
+}
+
+void* operator new[]( std::size_t size )
+{
+	return operator new(size);
+}
+
+void operator delete( void *memory ) noexcept
+{
+	if (!memory)
+		return;
+
+	frees.fetch_add(1, std::memory_order_relaxed);
+	free(memory);
+}
+
+void operator delete[]( void *memory ) noexcept
+{
+	operator delete(memory);
+}
+
+#endif //PHYSICS_ALLOCATION_COUNTING
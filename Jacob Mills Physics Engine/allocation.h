@@ -0,0 +1,31 @@
+#ifndef ALLOCATIONH
+#define ALLOCATIONH
+
+// Includes //
+#include <stdint.h>
+
+// Allocation Counting //
+//with PHYSICS_ALLOCATION_COUNTING defined, the library replaces the global operator new and delete with versions that
+//count every call (from any thread, anywhere in the program) before passing it on to malloc and free. World uses the
+//counts to find how often each phase of a step allocated, and scalebench --check-allocations fails if a step does at
+//all once the scene has warmed up.
+//
+//Without it nothing is replaced and every count stays at 0. The counters are shared atomics, so counting is not free
+//when lots of threads allocate at once - it is meant for finding allocations, not for release builds.
+
+//totals since the program started
+struct AllocationCounts
+{
+	uint64_t allocations;	//calls to operator new and new[]
+	uint64_t frees;			//calls to operator delete and delete[] with anything to free
+	uint64_t bytes;			//bytes asked for by all the allocations
+
+	AllocationCounts(): allocations(0), frees(0), bytes(0) {}
+};
+
+AllocationCounts GetAllocationCounts();
+
+//whether the counting operator new was compiled in
+bool IsCountingAllocations();
+
+#endif //ALLOCATIONH
@@ -1,8 +1,25 @@
 #include "body.h"
 
 // Calculate a torque for a body from a point (relative to the body) and a force
-float CalculateLocalTorque( const Vector2 localPoint, const Vector2 force )
+Real CalculateLocalTorque( const Vector2 localPoint, const Vector2 force )
 {
 	//Derived from torque in 3D, wich uses cross product: torque = pxfy - pyfx
 	return localPoint.x*force.y - localPoint.y*force.x;
 }
+
+// Move the body on by one time step
+void Body::Integrate( const Real duration, const Vector2 gravity )
+{
+	if (inverseMass <= 0)
+		return;
+
+	velocity += gravity*duration;
+	position += velocity*duration;
+	orientation += rotation*duration;
+
+	//keep it small
+	if (orientation >= 360.0f)
+		orientation -= 360.0f;
+	if (orientation < 0)
+		orientation += 360.0f;
+}
@@ -14,23 +14,23 @@ private:
 	Vector2 velocity;
 
 	//inverse mass of the body
-	float inverseMass;
+	Real inverseMass;
 
 	//inverse moment of inertia for the body
-	float inverseMomentOfInertia;
+	Real inverseMomentOfInertia;
 
 	//current rotation of the body, in degrees - take care not to go over 360 or under 0
-	float orientation;
+	Real orientation;
 
 	//current angular velocity of the body
-	float rotation;
+	Real rotation;
 
-	float GetMass() const{return 1.0f/inverseMass; }
+	Real GetMass() const{return 1.0f/inverseMass; }
 
 public:
 	Body(): position(Vector2(3,3)), inverseMass(0.1f), inverseMomentOfInertia(0.08f), orientation(0), rotation(1), velocity(10,0){};
 	Body(const Vector2 newPos): position(newPos), inverseMass(0.1f), inverseMomentOfInertia(0.08f), orientation(0), rotation(1), velocity(10,0){};
-	Body(const Vector2 newPos, const float newOrientation): position(newPos), orientation(newOrientation), inverseMass(0.1f), inverseMomentOfInertia(0.08f), rotation(1), velocity(10, 0){};
+	Body(const Vector2 newPos, const Real newOrientation): position(newPos), orientation(newOrientation), inverseMass(0.1f), inverseMomentOfInertia(0.08f), rotation(1), velocity(10, 0){};
 	//Body(const Vector2 newPos, const float newInvMass): position(newPos), inverseMass(newInvMass), inverseMomentOfInertia(0.08f), orientation(0){};
 	
 
@@ -38,6 +38,10 @@ public:
 //	Body(const Vector2 newPos, const float newInvMass, const float newInvInertia):
 //		position(newPos), inverseMass(newInvMass), inverseMomentOfInertia(newInvInertia){};
 
+	//moves the body on by its velocity and rotation over the duration (seconds), after adding on gravity.
+	//bodies with infinite mass (inverse mass of 0) never move
+	void Integrate(const Real duration, const Vector2 gravity);
+
 	// Make data available to collidable objects
 	friend class Shape;
 	friend class Line;
@@ -46,11 +50,14 @@ public:
 	//friend class UserCircle;
 	friend class Box;
 	//friend class UserBox;
+	friend class Polygon;
 	
 	friend class Contact;
+	friend class World;
+	friend class MemberSizes;
 };
 
 // Functions
-float CalculateLocalTorque(const Vector2 localPoint, const Vector2 force); //TODO: move to core?
+Real CalculateLocalTorque(const Vector2 localPoint, const Vector2 force); //TODO: move to core?
 
 #endif
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include "broadphase.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <climits>
+
+// Bounds //
+AABB GetBounds( const Box &box, const Real margin )
+{
+	return box.GetBounds().Grown(margin);
+}
+
+AABB GetBounds( const Circle &circle, const Real margin )
+{
+	return circle.GetBounds().Grown(margin);
+}
+
+AABB GetBounds( const Polygon &polygon, const Real margin )
+{
+	return polygon.GetBounds().Grown(margin);
+}
+
+// Uniform Grid //
+//true if the box goes in the grid
+static bool IsFiled( const std::vector<AABB> &bounds, const std::vector<unsigned char> *leaveOut, const unsigned index )
+{
+	return bounds[index].IsFinite() && !(leaveOut && (*leaveOut)[index]);
+}
+
+void UniformGrid::Build( const std::vector<AABB> &bounds, const float newCellSize, const std::vector<unsigned char> *leaveOut )
+{
+	TRACE_SCOPE("UniformGrid::Build");
+
+	const unsigned count = bounds.size();
+	ranges.resize(count);
+
+	//find the area covered by everything
+	float minX = FLT_MAX, minY = FLT_MAX;
+	float maxX = -FLT_MAX, maxY = -FLT_MAX;
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		if (!IsFiled(bounds, leaveOut, i))
+			continue;
+
+		minX = std::min(minX, ToFloat(bounds[i].min.x));
+		minY = std::min(minY, ToFloat(bounds[i].min.y));
+		maxX = std::max(maxX, ToFloat(bounds[i].max.x));
+		maxY = std::max(maxY, ToFloat(bounds[i].max.y));
+	}
+
+	//nothing to file
+	if (minX > maxX)
+	{
+		columns = 0;
+		rows = 0;
+		cellStarts.assign(1, 0);
+		cellEntries.clear();
+		for (unsigned i = 0; i < count; i++)
+		{
+			CellRange empty = {0, 0, -1, -1};
+			ranges[i] = empty;
+		}
+		return;
+	}
+
+	//size the grid, keeping the number of cells to a few per box so a tiny cell size can't eat all the memory
+	const double maxCells = 4.0*count + 64;
+
+	//make room for the most cells there can be, and a few entries per box, so the buffers don't grow a little at a
+	//time as the scene spreads out
+	cellStarts.reserve((unsigned)maxCells + 1);
+	cellEntries.reserve(4*count);
+	cellSize = newCellSize > 0 ? newCellSize : 1.0f;
+
+	for (;;)
+	{
+		double width = floor((maxX - minX) / cellSize) + 1;
+		double height = floor((maxY - minY) / cellSize) + 1;
+
+		if (width*height <= maxCells)
+		{
+			columns = (int)width;
+			rows = (int)height;
+			break;
+		}
+
+		cellSize *= 2;
+	}
+
+	originX = minX;
+	originY = minY;
+	inverseCellSize = 1.0f / cellSize;
+
+	//work out the cells covered by each box and count how many boxes land in each cell
+	const unsigned cellCount = columns*rows;
+	cellStarts.assign(cellCount + 1, 0);
+	unsigned entryCount = 0;
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		CellRange &range = ranges[i];
+
+		if (!IsFiled(bounds, leaveOut, i))
+		{
+			CellRange empty = {0, 0, -1, -1};
+			range = empty;
+			continue;
+		}
+
+		range.minX = CellX(ToFloat(bounds[i].min.x));
+		range.minY = CellY(ToFloat(bounds[i].min.y));
+		range.maxX = CellX(ToFloat(bounds[i].max.x));
+		range.maxY = CellY(ToFloat(bounds[i].max.y));
+
+		for (int y = range.minY; y <= range.maxY; y++)
+		{
+			for (int x = range.minX; x <= range.maxX; x++)
+			{
+				cellStarts[y*columns + x]++;
+			}
+		}
+
+		entryCount += (range.maxX - range.minX + 1) * (range.maxY - range.minY + 1);
+	}
+
+	//running total, so each cell's count becomes where its entries end
+	for (unsigned cell = 1; cell <= cellCount; cell++)
+	{
+		cellStarts[cell] += cellStarts[cell-1];
+	}
+
+	//fill from the back, walking each cell's end down to its start - going through the boxes backwards leaves each
+	//cell's entries in index order
+	cellEntries.resize(entryCount);
+
+	for (unsigned i = count; i-- > 0; )
+	{
+		const CellRange &range = ranges[i];
+
+		for (int y = range.minY; y <= range.maxY; y++)
+		{
+			for (int x = range.minX; x <= range.maxX; x++)
+			{
+				cellEntries[--cellStarts[y*columns + x]] = i;
+			}
+		}
+	}
+}
+
+void UniformGrid::Query( const unsigned index, const std::vector<AABB> &bounds, std::vector<ShapePair> &pairs, std::vector<unsigned> &scratch ) const
+{
+	scratch.clear();
+	FindOverlaps(bounds[index], ranges[index], index, bounds, scratch);
+
+	std::sort(scratch.begin(), scratch.end());
+
+	for (unsigned i = 0; i < scratch.size(); i++)
+	{
+		ShapePair pair = {index, scratch[i]};
+		pairs.push_back(pair);
+	}
+}
+
+void UniformGrid::Query( const AABB &box, const std::vector<AABB> &bounds, std::vector<unsigned> &found ) const
+{
+	found.clear();
+
+	if (columns == 0 || !box.IsFinite())
+		return;
+
+	CellRange range;
+	range.minX = CellX(ToFloat(box.min.x));
+	range.minY = CellY(ToFloat(box.min.y));
+	range.maxX = CellX(ToFloat(box.max.x));
+	range.maxY = CellY(ToFloat(box.max.y));
+
+	//UINT_MAX for no index of its own, so no boxes are skipped
+	FindOverlaps(box, range, UINT_MAX, bounds, found);
+
+	std::sort(found.begin(), found.end());
+}
+
+void UniformGrid::FindOverlaps( const AABB &box, const CellRange &range, const unsigned index, const std::vector<AABB> &bounds, std::vector<unsigned> &found ) const
+{
+	for (int y = range.minY; y <= range.maxY; y++)
+	{
+		for (int x = range.minX; x <= range.maxX; x++)
+		{
+			const unsigned cell = y*columns + x;
+
+			//entries are in index order, so skip straight past everything up to and including this box
+			const unsigned *end = &cellEntries[0] + cellStarts[cell+1];
+			const unsigned *entry = index == UINT_MAX ? &cellEntries[0] + cellStarts[cell] : std::upper_bound(&cellEntries[0] + cellStarts[cell], end, index);
+
+			for (; entry != end; entry++)
+			{
+				const AABB &other = bounds[*entry];
+
+				if (!box.Overlaps(other))
+					continue;
+
+				//only the cell holding the corner where the overlap starts reports the pair
+				if (CellX(ToFloat(std::max(box.min.x, other.min.x))) != x || CellY(ToFloat(std::max(box.min.y, other.min.y))) != y)
+					continue;
+
+				found.push_back(*entry);
+			}
+		}
+	}
+}
+
+bool UniformGrid::ClipToGrid( const float start, const float delta, const float size, float &enter, float &exit )
+{
+	if (delta == 0)
+		return start >= 0 && start <= size;
+
+	float near = -start / delta;
+	float far = (size - start) / delta;
+	if (near > far)
+		std::swap(near, far);
+
+	enter = std::max(enter, near);
+	exit = std::min(exit, far);
+	return enter <= exit;
+}
+
+//clamped to the grid while still a float - a huge query region or a distant ray end is too far out to convert to an
+//int. Not a number goes to the first cell
+int UniformGrid::CellX( const float x ) const
+{
+	const float cell = (x - originX) * inverseCellSize;
+	return !(cell > 0) ? 0 : (cell >= (float)columns ? columns-1 : (int)cell);
+}
+
+int UniformGrid::CellY( const float y ) const
+{
+	const float cell = (y - originY) * inverseCellSize;
+	return !(cell > 0) ? 0 : (cell >= (float)rows ? rows-1 : (int)cell);
+}
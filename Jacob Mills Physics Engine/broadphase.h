@@ -0,0 +1,156 @@
+#ifndef BROADPHASEH
+#define BROADPHASEH
+
+// Includes //
+#include <algorithm>
+
+#include "core.h"
+#include "vector2.h"
+#include "shape.h"
+#include "aabb.h"
+
+//bounds of a shape, grown by margin on every side so rounding in the narrowphase can never put a contact outside them
+AABB GetBounds(const Box &box, const Real margin);
+AABB GetBounds(const Circle &circle, const Real margin);
+AABB GetBounds(const Polygon &polygon, const Real margin);
+
+// Shape Pair //
+//two shapes that might be touching, as indices into the world's list of shapes. a is always less than b
+struct ShapePair
+{
+	unsigned a;
+	unsigned b;
+};
+
+// Uniform Grid //
+//splits the world into square cells and files every bounding box under each cell it covers - shapes only need
+//checking against the shapes sharing a cell with them. Cells are stored densely (one counting sort per build), so
+//building allocates nothing once the buffers have grown to fit the scene.
+class UniformGrid
+{
+public:
+	UniformGrid(): originX(0), originY(0), inverseCellSize(1), cellSize(1), columns(0), rows(0) {}
+
+	//files every finite bounding box into the grid, apart from those with a non-zero entry in leaveOut (if given). If
+	//cells of the size given would make an unreasonable number of cells for the number of boxes they are made bigger
+	void Build(const std::vector<AABB> &bounds, const float newCellSize, const std::vector<unsigned char> *leaveOut = NULL);
+
+	//appends a pair for every box after index that overlaps it, in order of the other box's index. Each pair is
+	//only found by one of the cells the two boxes share, so there are no duplicates. scratch is working space
+	void Query(const unsigned index, const std::vector<AABB> &bounds, std::vector<ShapePair> &pairs, std::vector<unsigned> &scratch) const;
+
+	//fills found with every filed box that overlaps box, which doesn't have to be in the grid itself, in index order
+	void Query(const AABB &box, const std::vector<AABB> &bounds, std::vector<unsigned> &found) const;
+
+	//calls visit(entry, end) with the entries of each cell the segment from (fromX, fromY) to (toX, toY) passes through,
+	//in the order it reaches them, as far as limit along it (0 at its start, 1 at its end). visit returns the nearest
+	//hit so far as a fraction along the segment, and the walk stops at the first cell that hit comes before the end of
+	//- nothing filed only in cells further on can be nearer. Boxes covering several cells are visited in each of them
+	template <typename Visitor>
+	void Walk(const float fromX, const float fromY, const float toX, const float toY, const float limit, Visitor visit) const;
+
+	//the cell a position is in, clamped into the grid (0 for an empty grid)
+	unsigned GetCell(const float x, const float y) const { return columns == 0 ? 0 : CellY(y)*columns + CellX(x); }
+
+	float GetCellSize() const { return cellSize; }
+	unsigned GetCellCount() const { return columns*rows; }
+
+	//bytes reserved by the grid's buffers
+	size_t GetMemoryUsed() const
+	{
+		return ranges.capacity()*sizeof(CellRange) + (cellStarts.capacity() + cellEntries.capacity())*sizeof(unsigned);
+	}
+
+	//bytes the grid keeps for every box filed in it (besides its entries in the cells)
+	static size_t GetBytesPerBox() { return sizeof(CellRange); }
+
+private:
+	// Cell Range
+	//the cells a bounding box covers, inclusive. Empty for boxes that weren't filed
+	struct CellRange
+	{
+		int minX, minY, maxX, maxY;
+	};
+
+	//cell coordinate of a position, clamped into the grid
+	int CellX(const float x) const;
+	int CellY(const float y) const;
+
+	//narrows enter and exit, fractions along a segment, to the part inside the grid along one axis, given where the
+	//segment starts relative to the grid's edge, how far it goes, and the grid's size. False if none of it is inside
+	static bool ClipToGrid(const float start, const float delta, const float size, float &enter, float &exit);
+
+	//finds the boxes overlapping box that come after index (all of them for UINT_MAX), into found (unsorted)
+	void FindOverlaps(const AABB &box, const CellRange &range, const unsigned index, const std::vector<AABB> &bounds, std::vector<unsigned> &found) const;
+
+	float originX;
+	float originY;
+	float inverseCellSize;
+	float cellSize;
+	int columns;
+	int rows;
+
+	std::vector<CellRange> ranges;		//one per bounding box
+	std::vector<unsigned> cellStarts;	//where each cell's entries start in cellEntries, plus one on the end
+	std::vector<unsigned> cellEntries;	//bounding box indices, grouped by cell, in index order within each cell
+};
+
+template <typename Visitor>
+void UniformGrid::Walk( const float fromX, const float fromY, const float toX, const float toY, const float limit, Visitor visit ) const
+{
+	const float deltaX = toX - fromX;
+	const float deltaY = toY - fromY;
+
+	//only the part of the segment over the grid
+	float enter = 0, exit = limit;
+	if (columns == 0 || !ClipToGrid(fromX - originX, deltaX, columns*cellSize, enter, exit) || !ClipToGrid(fromY - originY, deltaY, rows*cellSize, enter, exit))
+		return;
+
+	int x = CellX(fromX + deltaX*enter);
+	int y = CellY(fromY + deltaY*enter);
+	const int stepX = deltaX > 0 ? 1 : -1;
+	const int stepY = deltaY > 0 ? 1 : -1;
+
+	//fractions where the segment crosses into the next column and row, and how much they grow with each one crossed
+	float nextX = FLT_MAX, nextY = FLT_MAX;
+	float acrossX = 0, acrossY = 0;
+
+	if (deltaX != 0)
+	{
+		nextX = (originX + (x + (deltaX > 0))*cellSize - fromX) / deltaX;
+		acrossX = cellSize / fabs(deltaX);
+	}
+	if (deltaY != 0)
+	{
+		nextY = (originY + (y + (deltaY > 0))*cellSize - fromY) / deltaY;
+		acrossY = cellSize / fabs(deltaY);
+	}
+
+	const unsigned *entries = cellEntries.data();
+
+	for (;;)
+	{
+		const unsigned cell = y*columns + x;
+		const float cellExit = std::min(nextX, nextY);
+
+		if (visit(entries + cellStarts[cell], entries + cellStarts[cell+1]) <= cellExit || cellExit >= exit)
+			return;
+
+		if (nextX < nextY)
+		{
+			x += stepX;
+			nextX += acrossX;
+			if (x < 0 || x >= columns)
+				return;
+		}
+		else
+		{
+			y += stepY;
+			nextY += acrossY;
+			if (y < 0 || y >= rows)
+				return;
+		}
+	}
+}
+
+#endif //BROADPHASEH
@@ -7,10 +7,23 @@
 #include "body.h"
 #include "vector2.h"
 #include "shape.h"
+#include "trace.h"
+#include "counters.h"
+#include "broadphase.h"
+#include "gjk.h"
+
+#include <climits>
 
 // Constants //
 //in final physics engine each object could have its own co-efficient of restitution. 
-const float restitution = 1/*0.4f*/;
+const Real restitution = 1/*0.4f*/;
+
+//a swept shape stops this far short of what it hits (metres), so moving it by the hit's fraction leaves a sliver of
+//space rather than an overlap for the resolution to push apart
+const Real castTolerance = 0.005f;
+
+//most steps conservative advancement takes towards a shape before settling for where it has got to
+const unsigned maxCastIterations = 20;
 
 // Contact Generation //
 
@@ -21,32 +34,38 @@ private:
 	//information about the contact
 	Vector2 contactPoint;
 	Vector2 contactNormal;
-	float penetration;
+	Real penetration;
 
 	//the bodies involved
 	Body* body[2] ; 
 
+	//GetTypeLayouts counts the members
+	friend class MemberSizes;
+
 
 public:
 	Contact():contactPoint(-1,-1){};
 	//accessors
 	void SetContactPoint(Vector2 newPoint) { contactPoint = newPoint; }
 	void SetContactNormal(Vector2 newNormal) { contactNormal = newNormal; }
-	void SetPenetration(float newPenetration) { penetration = newPenetration; }
+	void SetPenetration(Real newPenetration) { penetration = newPenetration; }
 	void SetBodyData( Body *newBody1, Body *newBody2) { body[0] = newBody1; body[1] = newBody2; }
 
 	Body* GetBody(const unsigned index) const {if (index > 1) return new Body(Vector2(-1,-1));	return body[index];}
 	Vector2 GetContactPoint() const { return contactPoint;}
 	Vector2 GetContactNormal() const { return contactNormal; }
+	Real GetPenetration() const { return penetration; }
 
-	// Resolves position of the bodies in contact
-	void ResolvePosition()
+	// Resolves position of the bodies in contact, returning how many were moved
+	unsigned ResolvePosition()
 	{
+		TRACE_SCOPE("Contact::ResolvePosition");
+
 		//Linear inertia for the two bodies
-		float linearInertia[2] = {0,0};
+		Real linearInertia[2] = {0,0};
 
 		//inverse of total inertia in the collision
-		float inverseInertia = 0;
+		Real inverseInertia = 0;
 
 		//for each body, if there is one (halfspaces input NULL as they will never move)
 		for (unsigned i=0; i<2; i++)
@@ -61,20 +80,28 @@ public:
 			}
 		}
 
+		//two immovable bodies, nothing to do
+		if (inverseInertia <= 0)
+			return 0;
+
 		//invert it
 		inverseInertia = 1/inverseInertia;
 
 		//calculate amount to move based on above values
-		float linearMove[2] = {penetration * linearInertia[0] * inverseInertia, -penetration * linearInertia[1] * inverseInertia};
+		Real linearMove[2] = {penetration * linearInertia[0] * inverseInertia, -penetration * linearInertia[1] * inverseInertia};
 
 		//if body is present, move it
+		unsigned moved = 0;
 		for (unsigned i=0; i<2; i++)
 		{
-			if (body[i])
+			if (body[i] && linearMove[i] != 0)
 			{
 				body[i]->position += contactNormal*linearMove[i];
+				moved++;
 			}
 		}
+
+		return moved;
 	}
 
 	//TODO: Thought doing velocity resolution with rotation would enlighten me on what's wrong with this.
@@ -82,14 +109,16 @@ public:
 	//resolves position of bodies in contact... trying to do it nonlinearly
 	void ResolvePositionWithRotation()
 	{	
+		TRACE_SCOPE("Contact::ResolvePositionWithRotation");
+
 		//Linear inertia for the two bodies
-		float linearInertia[2] = {0,0};
+		Real linearInertia[2] = {0,0};
 
 		//inverse of total inertia in the collision
-		float inverseInertia = 0;
+		Real inverseInertia = 0;
 		
 		//angular inertia for the two bodies
-		float angularInertia[2] = {0,0};
+		Real angularInertia[2] = {0,0};
 
 
 		//for each body, if there is one (halfspaces input NULL as they will never move)
@@ -103,7 +132,7 @@ public:
 				//get angular inertia by transforming contact point to local coordinates for the body,
 				//then finding some weird pseudo-torque using the contact normal
 				Vector2 translation = body[i]->position.GetInvert();
-				float rotation = -body[i]->orientation;
+				Real rotation = -body[i]->orientation;
 
 				Vector2 localContactPosition = contactPoint + translation;
 				localContactPosition.RotateAboutWorldOrigin(rotation);
@@ -125,13 +154,13 @@ public:
 
 		//calculate amount to move based on above values
 
-		float linearMove[2] = {penetration * linearInertia[0] * inverseInertia, -penetration * linearInertia[1] * inverseInertia};
+		Real linearMove[2] = {penetration * linearInertia[0] * inverseInertia, -penetration * linearInertia[1] * inverseInertia};
 
 			//this number is meant to be the distance it needs to rotate, not the rotation? is it? -> how to turn this into #of degrees?
 				//-> i have the body's position and the relative position of the contact - must be able to get amount of rotation around that point to get a certain distance?
 				//-> doesn't matter because this value still looks wrong.
 				//-> to sort this out, would need to figure out the impulse to move it the amount.
-		float angularMove[2] = {penetration * angularInertia[0] * inverseInertia, -penetration * angularInertia[1] * inverseInertia};
+		Real angularMove[2] = {penetration * angularInertia[0] * inverseInertia, -penetration * angularInertia[1] * inverseInertia};
 		
 		//if body is present, move it
 		for (unsigned i=0; i<2; i++)
@@ -151,12 +180,14 @@ public:
 	//I'm applying the change at the end could be. Rotation seems to steal most of the linear velocity change anyway. 
 	void ResolveVelocitiesAndRotations()
 	{
+		TRACE_SCOPE("Contact::ResolveVelocitiesAndRotations");
+
 		//figuring out an impulse that changes the linear velocity causing the intersection to go away and rotate the body accordingly
 
 		//firstly want to find the velocity change per impulse applied for the contacts - linear and angular
 			//linear change in velocity for a unit impulse is in direction of impulse, magnitude of which is inverse mass
 
-		float linearChangeInVelocityPerUnitImpulse = 0;
+		Real linearChangeInVelocityPerUnitImpulse = 0;
 		Vector2 relativeContact[2] ;
 
 		for (unsigned i = 0; i<2; i++)
@@ -173,7 +204,7 @@ public:
 
 		
 		//angular change is difficult.
-		float rotationalChangeInVelocityPerUnitImpulse = 0;
+		Real rotationalChangeInVelocityPerUnitImpulse = 0;
 		for (unsigned i = 0; i<2; i++)
 		{
 			if (body[i])
@@ -182,10 +213,10 @@ public:
 				relativeContactNormal.RotateAboutWorldOrigin(-body[i]->orientation);
 
 					//get impulsive torque generated by one unit's impulse (contact normal)
-				float impulsiveTorquePerUnitImpulse = CalculateLocalTorque(relativeContact[i], relativeContactNormal); 
+				Real impulsiveTorquePerUnitImpulse = CalculateLocalTorque(relativeContact[i], relativeContactNormal); 
 
 					//get change in angular velocity that you get from a unit of impuslive torque
-				float changeInAngularVelocityPerUnitImpulsiveTorque = impulsiveTorquePerUnitImpulse * body[i]->inverseMomentOfInertia;
+				Real changeInAngularVelocityPerUnitImpulsiveTorque = impulsiveTorquePerUnitImpulse * body[i]->inverseMomentOfInertia;
 
 					//get linear velocity of point due to rotation only
 					//Velocity of point on rotating body: vx = -ry*w, vy = rx*w (http://www.euclideanspace.com/physics/kinematics/combinedVelocity/index.htm)
@@ -195,14 +226,14 @@ public:
 				//only interested in magnitude relative to contact normal 
 				//finding proportion of vector relative to other vector: a.b = |a||b|cos(theta), and |a|cos(theta) = |projection of a onto b|, so a.b/|b| = |projection of a onto b|
 				//(Khan Academy http://youtu.be/KDHuWxy53uM?t=4m12s)
-				float projection =  relativeContactNormal * velocityOfPointDueToRotation; 
+				Real projection =  relativeContactNormal * velocityOfPointDueToRotation; 
 				projection /= velocityOfPointDueToRotation.Magnitude();
 				
 				rotationalChangeInVelocityPerUnitImpulse += (velocityOfPointDueToRotation * projection).Magnitude();
 			}
 		}
 
-		float velocityChangePerUnitImpulse = linearChangeInVelocityPerUnitImpulse + rotationalChangeInVelocityPerUnitImpulse;
+		Real velocityChangePerUnitImpulse = linearChangeInVelocityPerUnitImpulse + rotationalChangeInVelocityPerUnitImpulse;
 
 
 
@@ -221,7 +252,7 @@ public:
 			}
 		}
 			//need to know how much is in direction of contact normal (and how much is at a tangent to it for friction)
-		float linearClosingVelocityProjection =  contactNormal * linearClosingVelocity ; 
+		Real linearClosingVelocityProjection =  contactNormal * linearClosingVelocity ; 
 		linearClosingVelocityProjection /= linearClosingVelocity.Magnitude();
 		
 		linearClosingVelocity *= linearClosingVelocityProjection;
@@ -247,19 +278,19 @@ public:
 		//TODO: could skip getting them separately and get them both at the same time using velocity.x-ry*w and velocity.y+rx*w
 
 		//how much is in direciton of contact normal?
-		float rotationClosingVelocityProjection = contactNormal * rotationalClosingVelocity ;
+		Real rotationClosingVelocityProjection = contactNormal * rotationalClosingVelocity ;
 		rotationClosingVelocityProjection /= rotationalClosingVelocity.Magnitude();
 
 		rotationalClosingVelocity *= rotationClosingVelocityProjection;
 
-		float contactVelocity = linearClosingVelocity.Magnitude() + rotationalClosingVelocity.Magnitude();
+		Real contactVelocity = linearClosingVelocity.Magnitude() + rotationalClosingVelocity.Magnitude();
 		
 		//change velocity: change in velocity = -(1+restitution coefficient)* closing velocity
-		float deltaVelocity = -contactVelocity * (1+restitution); //might be right so far
+		Real deltaVelocity = -contactVelocity * (1+restitution); //might be right so far
 
 
 		//impulse needed to achieve a given velocity = velocity/velocity change per unit impulse
-		float impulseMag = deltaVelocity / velocityChangePerUnitImpulse; //problem with velocityChangePerUnitImpulse?
+		Real impulseMag = deltaVelocity / velocityChangePerUnitImpulse; //problem with velocityChangePerUnitImpulse?
 		Vector2 impulse = contactNormal.GetInvert() * impulseMag;
 		
 		//I THINK THE PROBLEM IS HERE: rotationalChangeInVelocityPerImpulse is about as big as the linear one, yet deltaVelocity is only .1 bigger
@@ -274,8 +305,8 @@ public:
 
 				Vector2 velocityChange = impulse * body[i]->inverseMass;
 
-				float impulsiveTorque = CalculateLocalTorque(relativeContact[i], impulse);
-				float rotationChange = impulsiveTorque*body[i]->inverseMomentOfInertia;
+				Real impulsiveTorque = CalculateLocalTorque(relativeContact[i], impulse);
+				Real rotationChange = impulsiveTorque*body[i]->inverseMomentOfInertia;
 				//rotationChange = RadiansToDegrees(rotationChange); //TODO: big error? rotations are way too big if in degrees? 
 
 				body[i]->velocity += velocityChange;
@@ -287,14 +318,17 @@ public:
  	}
 
 
-	void ResolveVelocities()
+	//returns the number of bodies given an impulse
+	unsigned ResolveVelocities()
 	{
+		TRACE_SCOPE("Contact::ResolveVelocities");
+
 		//figuring out an impulse that changes the linear velocity causing the intersection to go away accordingly
 
 		//firstly want to find the velocity change per impulse applied for the contacts - linear and angular
 		//linear change in velocity for a unit impulse is in direction of impulse, magnitude of which is inverse mass
 
-		float linearChangeInVelocityPerUnitImpulse = 0;
+		Real linearChangeInVelocityPerUnitImpulse = 0;
 
 		for (unsigned i = 0; i<2; i++)
 		{
@@ -318,18 +352,23 @@ public:
 					linearClosingVelocity -= body[i]->velocity;
 			}
 		}
+		//normal points towards body[0], so if the bodies are already separating (or not moving relative
+		//to each other at all) there's nothing to resolve - carrying on would add energy every frame they touch
+		if (contactNormal * linearClosingVelocity >= 0 || linearChangeInVelocityPerUnitImpulse <= 0)
+			return 0;
+
 		//need to know how much is in direction of contact normal and how much is at a tangent to it
-		float linearClosingVelocityProjection =  contactNormal * linearClosingVelocity ;
+		Real linearClosingVelocityProjection =  contactNormal * linearClosingVelocity ;
 		linearClosingVelocityProjection /= linearClosingVelocity.Magnitude();
 
 		linearClosingVelocity *= linearClosingVelocityProjection;
 
 		//change velocity: change in velocity = -(1+restitution coefficient)* closing velocity
-		float deltaVelocity = -linearClosingVelocity.Magnitude() * (1+restitution); //might be right so far
+		Real deltaVelocity = -linearClosingVelocity.Magnitude() * (1+restitution); //might be right so far
 
 
 		//impulse needed to achieve a given velocity = velocity/velocity change per unit impulse
-		float impulseMag = deltaVelocity / linearChangeInVelocityPerUnitImpulse;
+		Real impulseMag = deltaVelocity / linearChangeInVelocityPerUnitImpulse;
 		Vector2 impulse = contactNormal.GetInvert() * impulseMag;
 
 		Vector2 velocityChange = impulse * body[0]->inverseMass;
@@ -341,8 +380,10 @@ public:
 		{
 			velocityChange = impulse.GetInvert() * body[1]->inverseMass;
 			body[1]->velocity += velocityChange;
+			return 2;
 		}
 		
+		return 1;
 	}
 
 
@@ -371,12 +412,14 @@ class ObjectList
 private:
 	std::vector<Box*> boxes;
 	std::vector<Circle*> circles;
+	std::vector<Polygon*> polygons;
 	std::vector<HalfSpace*> halfSpaces;
 
 public:
 	// Add Items
 	void Add( Box &box) { boxes.push_back(&box); }
 	void Add( Circle &circle) { circles.push_back(&circle); }
+	void Add( Polygon &polygon) { polygons.push_back(&polygon); }
 	void Add( HalfSpace &halfSpace) { halfSpaces.push_back(&halfSpace); }
 
 	void Remove(Box &box)
@@ -401,43 +444,268 @@ public:
 		}
 	}
 
+	void Remove(Polygon &polygon)
+	{
+		for (unsigned i = 0; i<polygons.size(); i++)
+		{
+			if (polygons[i]->IsTheSameAs(polygon))
+			{
+				polygons.erase(polygons.begin() + i);
+			}
+		}
+	}
+
 	// Accessors
-	Box GetBoxAt(const unsigned index) const { return *boxes[index]; }
-	Circle GetCircleAt(const unsigned index) const { return *circles[index]; }
-	HalfSpace GetHalfSpaceAt(const unsigned index) const {return *halfSpaces[index]; }
+	Box& GetBoxAt(const unsigned index) const { return *boxes[index]; }
+	Circle& GetCircleAt(const unsigned index) const { return *circles[index]; }
+	Polygon& GetPolygonAt(const unsigned index) const { return *polygons[index]; }
+	HalfSpace& GetHalfSpaceAt(const unsigned index) const {return *halfSpaces[index]; }
+
+	//numbered as in World: boxes, then circles, then polygons, then halfspaces
+	Shape& GetShapeAt(const unsigned index) const
+	{
+		if (index < boxes.size())
+			return *boxes[index];
+		if (index < boxes.size() + circles.size())
+			return *circles[index - boxes.size()];
+		if (index < FiniteSize())
+			return *polygons[index - boxes.size() - circles.size()];
+		return *halfSpaces[index - FiniteSize()];
+	}
 
 	// List Sizes 
 	unsigned BoxesSize() const { return boxes.size(); }
 	unsigned CirclesSize() const { return circles.size(); }
+	unsigned PolygonsSize() const { return polygons.size(); }
 	unsigned HalfSpacesSize() const {return halfSpaces.size(); }
-	unsigned Size() const { return boxes.size() + circles.size() + halfSpaces.size(); }
+	unsigned Size() const { return FiniteSize() + halfSpaces.size(); }
+
+	//everything but the halfspaces - the shapes with bounds, which come first in the numbering
+	unsigned FiniteSize() const { return boxes.size() + circles.size() + polygons.size(); }
+
+	//bytes reserved for the pointers to the shapes (not the shapes themselves)
+	size_t GetMemoryUsed() const { return (boxes.capacity() + circles.capacity() + polygons.capacity() + halfSpaces.capacity()) * sizeof(Shape*); }
+
+};
+
+// Pair Cache //
+//what the narrowphase found for one box pair (box and box, or box and circle) the last time it was tested, or the
+//simplex GJK finished with for a polygon pair. The caller keeps one for each pair from step to step (see World) and
+//hands it back the next time the pair comes up
+struct PairCache
+{
+	unsigned axis;					//BoxAndBox's axis from last time, or CollisionDetector::noCachedAxis
+	bool tested;					//false until the rest has been filled in
+	unsigned char contacts;			//contacts made when tested, 0 or 1
+	bool boxSecond;					//the contact had the box as its second body (BoxAndBox found it on box2's side)
+
+	//where the second shape was relative to the box when tested, in the box's own coordinates and orientation (0 for
+	//circles)
+	Vector2 relativePosition;
+	Real relativeOrientation;
 
+	//the contact made, in the box's own coordinates
+	Vector2 localPoint;
+	Vector2 localNormal;
+	Real penetration;
+
+	//the simplex GJK finished with last time, for pairs with a polygon in
+	SimplexCache simplex;
+
+	PairCache(): axis(4), tested(false), contacts(0), boxSecond(false), relativeOrientation(0), penetration(0) {}
+};
+
+// Ray //
+//a line segment to cast from its start to its end. Rays pass through sensors and anything their filter rules out
+struct Ray
+{
+	Vector2 from;
+	Vector2 to;
+	CollisionFilter filter;
+
+	Ray() {}
+	Ray(const Vector2 &newFrom, const Vector2 &newTo): from(newFrom), to(newTo) {}
+	Ray(const Vector2 &newFrom, const Vector2 &newTo, const CollisionFilter &newFilter): from(newFrom), to(newTo), filter(newFilter) {}
+};
+
+// Ray Hit //
+//where a ray first hit a shape. A ray starting inside a shape doesn't hit it
+struct RayHit
+{
+	static const unsigned noShape = UINT_MAX;
+
+	Vector2 point;
+	Vector2 normal;		//the shape's surface normal at the point, facing back along the ray
+	Real fraction;		//how far along the ray the point is, from 0 at its start to 1 at its end
+	unsigned shape;		//numbered as in World (boxes, circles, polygons, then halfspaces), or noShape if nothing was hit
+
+	RayHit(): fraction(1), shape(noShape) {}
+
+	bool IsHit() const { return shape != noShape; }
+};
+
+// Swept Shape //
+//a box or circle to move along translation without turning, to find what it would hit first. It copies the shape's
+//pose and size, so the shape is left alone and doesn't need to be in the world - if it is, it never hits itself. The
+//hit is a RayHit, with the fraction of the translation it can move before touching
+struct SweptShape
+{
+	bool box;
+	Vector2 position;
+	Vector2 xAxis;		//boxes only
+	Vector2 yAxis;
+	Vector2 halfSize;
+	Real radius;		//circles only
+	Vector2 translation;
+	CollisionFilter filter;
+	const Body *body;	//never hit
+
+	SweptShape(const Box &shape, const Vector2 &newTranslation): box(true), position(shape.GetPosition()), xAxis(shape.GetXAxis()),
+		yAxis(shape.GetYAxis()), halfSize(shape.GetHalfSize()), radius(0), translation(newTranslation), filter(shape.GetFilter()),
+		body(shape.GetBody()) {}
+	SweptShape(const Circle &shape, const Vector2 &newTranslation): box(false), position(shape.GetPosition()), radius(shape.GetRadius()),
+		translation(newTranslation), filter(shape.GetFilter()), body(shape.GetBody()) {}
+
+	//half the size of its bounds along each axis
+	Vector2 GetExtents() const
+	{
+		if (!box)
+			return Vector2(radius, radius);
+
+		return Vector2(abs(xAxis.x)*halfSize.x + abs(yAxis.x)*halfSize.y, abs(xAxis.y)*halfSize.x + abs(yAxis.y)*halfSize.y);
+	}
+
+	//bounds of everywhere it passes through
+	AABB GetSweptBounds() const
+	{
+		const Vector2 extents = GetExtents();
+		const Vector2 end = position + translation;
+
+		AABB bounds;
+		bounds.min = Vector2(std::min(position.x, end.x) - extents.x, std::min(position.y, end.y) - extents.y);
+		bounds.max = Vector2(std::max(position.x, end.x) + extents.x, std::max(position.y, end.y) + extents.y);
+		return bounds;
+	}
 };
 
 // Collision Detector //
 
 class CollisionDetector
 {
+private:
+	//what this detector has done since its counters were last reset
+	StepCounters counters;
+
+	//a pair passed with a PairCache that has moved less than these relative to itself since it was last tested gets
+	//the same contact as then, moved along with the box
+	bool reuseContacts;
+	Real reuseDistance;		//metres
+	Real reuseAngle;		//degrees
+
+	//the simplex GenerateContacts left for each polygon pair GJK has one for (see SimplexCache), in pair order - last
+	//call's, read from as the pairs come round again, and this call's. World's grid keeps its own for the same pairs,
+	//so both start GJK from the same place and make the same contacts
+	struct CachedSimplex
+	{
+		ShapePair pair;
+		SimplexCache simplex;
+	};
+
+	std::vector<CachedSimplex> simplices;
+	std::vector<CachedSimplex> lastSimplices;
+	unsigned nextLastSimplex;
+
+	//contacts between two shapes that can't move would resolve to nothing, so those pairs are never tested - nor are
+	//pairs the shapes' filters rule out, or pairs with a sensor in (see ShouldSense)
+	static bool ShouldTest(const Shape &one, const Shape &two)
+	{
+		return !(one.IsImmovable() && two.IsImmovable()) && ShouldCollide(one.GetFilter(), two.GetFilter())
+			&& !one.IsSensor() && !two.IsSensor();
+	}
+
+	//bounds of a box, circle or polygon by its number in the list
+	static AABB GetBoundsOf(const ObjectList &objects, const unsigned index, const Real margin)
+	{
+		const unsigned boxCount = objects.BoxesSize();
+		const unsigned circleEnd = boxCount + objects.CirclesSize();
+
+		if (index < boxCount)
+			return GetBounds(objects.GetBoxAt(index), margin);
+		else if (index < circleEnd)
+			return GetBounds(objects.GetCircleAt(index - boxCount), margin);
+		else
+			return GetBounds(objects.GetPolygonAt(index - circleEnd), margin);
+	}
+
+	//whether the nearest point of the bounds to the halfspace is on or behind it, in floats as World's broadphase does
+	static bool BoundsReach(const AABB &bounds, const HalfSpace &halfSpace)
+	{
+		const float normalX = ToFloat(halfSpace.GetNormal().x), normalY = ToFloat(halfSpace.GetNormal().y);
+		const float minX = ToFloat(bounds.min.x), minY = ToFloat(bounds.min.y);
+		const float maxX = ToFloat(bounds.max.x), maxY = ToFloat(bounds.max.y);
+		const float centreX = (minX + maxX) * 0.5f, centreY = (minY + maxY) * 0.5f;
+		const float extentX = (maxX - minX) * 0.5f, extentY = (maxY - minY) * 0.5f;
+
+		const float absoluteX = fabs(normalX), absoluteY = fabs(normalY);
+		const float offset = ToFloat(halfSpace.GetOffset());
+
+		return !(normalX*centreX + normalY*centreY - absoluteX*extentX - absoluteY*extentY > offset);
+	}
+
 public:
 	//holds functions for handling different types of collisions and generating their contact data
 
+	CollisionDetector(): reuseContacts(false), reuseDistance(0), reuseAngle(0), nextLastSimplex(0) {}
+
+	// Contact Reuse //
+	//off by default, as a reused contact is only as close to the real one as the tolerances
+	void SetContactReuse(const bool enabled, const Real distance, const Real angle)
+	{
+		reuseContacts = enabled;
+		reuseDistance = distance;
+		reuseAngle = angle;
+	}
+
+	// Counters //
+	const StepCounters& GetCounters() const { return counters; }
+	void ResetCounters() { counters.Clear(); }
+
+	// Simplex Caches //
+	//forgets the simplices GenerateContacts has kept, for when shapes have been added or removed and so renumbered
+	void ClearSimplexCaches()
+	{
+		simplices.clear();
+		lastSimplices.clear();
+	}
+
+	// Sensors //
+	//whether a pair is only tested for overlap: one of the two is a sensor (two sensors ignore each other), and the
+	//pair would otherwise be tested
+	static bool ShouldSense(const Shape &one, const Shape &two)
+	{
+		return one.IsSensor() != two.IsSensor() && !(one.IsImmovable() && two.IsImmovable())
+			&& ShouldCollide(one.GetFilter(), two.GetFilter());
+	}
+
 	// Circle and Circle //
 	unsigned int CircleAndCircle(const Circle &one, const Circle &two, std::vector<Contact> &data)
 	{
+		TRACE_SCOPE("CollisionDetector::CircleAndCircle");
+		counters.pairsTested[CIRCLE_CIRCLE]++;
 
 		//get circle positions
 		Vector2 positionOne = one.GetPosition();
 		Vector2 positionTwo = two.GetPosition();
 
 		//get radii
-		float radiusOne = one.GetRadius();
-		float radiusTwo = two.GetRadius();
+		Real radiusOne = one.GetRadius();
+		Real radiusTwo = two.GetRadius();
 
 		//find vector between objects
 		Vector2 midline = positionOne - positionTwo;
 
 		//distance between origins
-		float distance = midline.Magnitude();
+		Real distance = midline.Magnitude();
 
 		//check whether two circles are in collision - if distance between two centres is greater than
 		//size of the two radii, they are not colliding. 
@@ -464,6 +732,7 @@ public:
 		contact.SetBodyData(one.GetBody(), two.GetBody());
 
 
+		counters.contacts[CIRCLE_CIRCLE]++;
 		data.push_back(contact);
 
 		return 1;
@@ -478,11 +747,14 @@ public:
 	 // Circle and HalfSpace //
 	unsigned int CircleAndHalfSpace(const Circle &circle, const HalfSpace &halfSpace, std::vector<Contact> &data)
 	{
+		TRACE_SCOPE("CollisionDetector::CircleAndHalfSpace");
+		counters.pairsTested[CIRCLE_HALFSPACE]++;
+
 		//cache circle position
 		Vector2 position = circle.GetPosition();
 
 		//find the distance from the plane using: distance = pointPosition . halfSpaceNormal - halfSpaceOffset 
-		float distance = halfSpace.GetNormal() * position - circle.GetRadius() - halfSpace.GetOffset();
+		Real distance = halfSpace.GetNormal() * position - circle.GetRadius() - halfSpace.GetOffset();
 
 		if (distance>= 0 ) 
 			return 0;
@@ -494,6 +766,7 @@ public:
 		contact.SetContactPoint(position - halfSpace.GetNormal() * (distance + circle.GetRadius()));
 		contact.SetBodyData(circle.GetBody(), NULL);
 
+		counters.contacts[CIRCLE_HALFSPACE]++;
 		data.push_back(contact);
 		return 1;
 
@@ -509,6 +782,9 @@ public:
 	// Box and HalfSpace //
 	unsigned int BoxAndHalfSpace(const Box &box, const HalfSpace &halfSpace, std::vector<Contact> &data)
 	{
+		TRACE_SCOPE("CollisionDetector::BoxAndHalfSpace");
+		counters.pairsTested[BOX_HALFSPACE]++;
+
 		//TODO: early out
 
 		//find intersection points by checking each vertex of box.
@@ -517,14 +793,14 @@ public:
 
 		unsigned contactCount = 0;
 
-		float smallestDistance = FLT_MAX;
+		Real smallestDistance = REAL_MAX;
 		unsigned smallestDistanceIndex = 4;
 
 		//for each vertex
 		for (int i = 0; i < 4; i++)
 		{
 			//get distance from halfspace
-			float distance = vertices[i] * halfSpace.GetNormal();
+			Real distance = vertices[i] * halfSpace.GetNormal();
 
 			//if negative, collision - and if its less in than any other collisions, record this instead of the other one
 			if (distance <= halfSpace.GetOffset())
@@ -538,7 +814,7 @@ public:
 
 			// Cohesion
 			/*//get distance of vertex from halfSpace
-			float distance = vertices[i] * halfSpace.GetNormal();
+			Real distance = vertices[i] * halfSpace.GetNormal();
 
 			//if this distance is negative, there's a contact
 			if (distance <= halfSpace.GetOffset())
@@ -572,6 +848,7 @@ public:
 			contact.SetBodyData(box.GetBody(), NULL);
 
 			contactCount++;
+			counters.contacts[BOX_HALFSPACE]++;
 			data.push_back(contact);
 
 		
@@ -589,29 +866,33 @@ public:
 	// Box and Circle //
 	unsigned int BoxAndCircle(const Box &box, const Circle &circle, std::vector<Contact> &data)
 	{
+		TRACE_SCOPE("CollisionDetector::BoxAndCircle");
+		counters.pairsTested[BOX_CIRCLE]++;
+
 		Vector2 relativeCentre = circle.GetPosition();
 
 		//get circle coordinates in box's local coordinates by translating and rotating box to world origin
 		Vector2 translation = box.GetPosition().GetInvert();
-		float rotation = -box.GetOrientation();
+		Real rotation = -box.GetOrientation();
 
 		//apply transformation to both shapes, getting the circle relative the the box
 		relativeCentre += translation;
 		relativeCentre.RotateAboutWorldOrigin(rotation);
 
 		//cache values
-		float radius = circle.GetRadius();
+		Real radius = circle.GetRadius();
 		Vector2 halfSize = box.GetHalfSize();
 
 		//if the circle is further away than the box than its radius, early out
 		if(abs(relativeCentre.x) - radius > halfSize.x || abs(relativeCentre.y) - radius > halfSize.y)
 		{
+			counters.boxCircleRejects[0]++;
 			return 0;
 		}
 
 		//get the closest point on the box to the circle
 		Vector2 closestPoint(0,0);
-		float distance;
+		Real distance;
 
 		//x axis
 		distance = relativeCentre.x;
@@ -638,7 +919,10 @@ public:
 		//finely check to see if we're in contact
 		distance = (closestPoint - relativeCentre).SquaredMagnitude();
 		if (distance>radius*radius) 
+		{
+			counters.boxCircleRejects[1]++;
 			return 0;
+		}
 
 		//transform closest point back to world coordinates
 		closestPoint.RotateAboutWorldOrigin(-rotation);
@@ -651,6 +935,7 @@ public:
 		contact.SetPenetration(radius - sqrt(distance));
 		contact.SetBodyData(box.GetBody(), circle.GetBody());
 
+		counters.contacts[BOX_CIRCLE]++;
 		data.push_back(contact);
 
 		return 1;
@@ -662,19 +947,71 @@ public:
 		return DrawContactNormal(BoxAndCircle(box, circle, data), data, vertexList);
 	}
 
+	//as above, reusing last time's contact from the cache if the circle has hardly moved relative to the box
+	unsigned int BoxAndCircle(const Box &box, const Circle &circle, std::vector<Contact> &data, PairCache &cache)
+	{
+		if (!reuseContacts)
+		{
+			cache.tested = false;
+			return BoxAndCircle(box, circle, data);
+		}
+
+		const Vector2 relativePosition = ToBoxCoordinates(box, circle.GetPosition() - box.GetPosition());
+
+		if (CanReuse(cache, relativePosition, 0))
+			return ReuseContact(box, circle.GetBody(), BOX_CIRCLE, cache, data);
+
+		const unsigned count = BoxAndCircle(box, circle, data);
+		RememberContact(box, count, relativePosition, 0, data, cache);
+		return count;
+	}
+
 	// Box and Box //
+	//axis given to BoxAndBox when there isn't one from last time
+	static const unsigned noCachedAxis = 4;
+
 	unsigned int BoxAndBox(const Box &box1, const Box &box2, std::vector<Contact> &data)
 	{
+		unsigned axis = noCachedAxis;
+		return BoxAndBox(box1, box2, data, axis);
+	}
+
+	//as above, but tries the given axis (0-3, numbered as below) on its own first. Pairs that are close but not touching
+	//are nearly always separated by the same axis as last step, so passing back the one given out last time rules
+	//them out with one test instead of up to four. If it doesn't separate them the full test runs as usual, so the
+	//result is the same whatever axis is passed. axis is set to the axis that separated them, or that they overlap
+	//least on if they touch
+	unsigned int BoxAndBox(const Box &box1, const Box &box2, std::vector<Contact> &data, unsigned &axis)
+	{
+		TRACE_SCOPE("CollisionDetector::BoxAndBox");
+		counters.pairsTested[BOX_BOX]++;
+
 		//axes to be checked
 		Vector2 axes[4];
 
 		//for getting the smallest overlap
-		float bestOverlap = FLT_MAX;
-		unsigned int bestCase;
+		Real bestOverlap = REAL_MAX;
+		unsigned int bestCase = 0;
 
 		//distance between box centres
 		Vector2 toCentre = box2.GetPosition() - box1.GetPosition();
 
+		//last step's axis first
+		const unsigned cachedAxis = axis;
+		Real cachedOverlap = 0;
+
+		if (cachedAxis < 4)
+		{
+			cachedOverlap = PenetrationOnAxis(box1, box2, GetBoxBoxAxis(box1, box2, cachedAxis), toCentre);
+
+			if (cachedOverlap < 0)
+			{
+				counters.boxBoxRejects[cachedAxis]++;
+				counters.boxBoxCachedRejects++;
+				return 0;
+			}
+		}
+
 		//for each axis
 		for (unsigned int i = 0; i<4; i++)
 		{
@@ -695,12 +1032,16 @@ public:
 				break;
 			}
 			
-			//get overlap of projections on this axis
-			float overlap = PenetrationOnAxis(box1, box2, axes[i], toCentre);
+			//get overlap of projections on this axis (already known for the cached one)
+			Real overlap = i == cachedAxis ? cachedOverlap : PenetrationOnAxis(box1, box2, axes[i], toCentre);
 
 			//if 0, no overlap, no collision, return
 			if (overlap < 0)
+			{
+				counters.boxBoxRejects[i]++;
+				axis = i;
 				return 0;
+			}
 
 			//if overlap smaller than the best, it is the new best
 			if (overlap < bestOverlap)
@@ -710,6 +1051,8 @@ public:
 			}
 		}	
 
+		axis = bestCase;
+
 		Contact contact;
 		//if the intersection is a vertex of box2 on box1's side
 		if (bestCase < 2)
@@ -721,6 +1064,7 @@ public:
 			GenerateBoxBoxContact(box2, box1, axes[bestCase], toCentre.GetInvert(), bestOverlap, contact );
 		}
 
+		counters.contacts[BOX_BOX]++;
 		data.push_back(contact);
 		return 1;
 	}
@@ -731,157 +1075,1525 @@ public:
 		return DrawContactNormal(BoxAndBox(box1, box2, data), data, vertexList);
 	}
 
+	//as above, trying the cache's axis first, and reusing last time's contact from the cache if box2 has hardly moved
+	//relative to box1
+	unsigned int BoxAndBox(const Box &box1, const Box &box2, std::vector<Contact> &data, PairCache &cache)
+	{
+		if (!reuseContacts)
+		{
+			cache.tested = false;
+			return BoxAndBox(box1, box2, data, cache.axis);
+		}
 
-	// Checks all objects in object list against each other for collisions - obviously not optimised at all
-	// returns number of collisions
-	unsigned GenerateContacts(ObjectList &objects, std::vector<Contact> &contacts)
+		const Vector2 relativePosition = ToBoxCoordinates(box1, box2.GetPosition() - box1.GetPosition());
+		const Real relativeOrientation = box2.GetOrientation() - box1.GetOrientation();
+
+		if (CanReuse(cache, relativePosition, relativeOrientation))
+			return ReuseContact(box1, box2.GetBody(), BOX_BOX, cache, data);
+
+		const unsigned count = BoxAndBox(box1, box2, data, cache.axis);
+		RememberContact(box1, count, relativePosition, relativeOrientation, data, cache);
+		return count;
+	}
+
+
+	// Polygons //
+	//pairs with a polygon in go through GJK, and EPA if their cores overlap (see ConvexAndConvex). The versions taking
+	//a SimplexCache start GJK from the simplex it holds - the one the pair finished with last step - and leave this
+	//step's in it. Pairs whose bounds don't overlap are rejected before GJK, emptying the cache
+	unsigned int BoxAndPolygon(const Box &box, const Polygon &polygon, std::vector<Contact> &data)
 	{
-		unsigned count = 0;
+		SimplexCache simplex;
+		return BoxAndPolygon(box, polygon, data, simplex);
+	}
 
-		//for each box
-		for (unsigned box = 0; box<objects.BoxesSize(); box++)
+	unsigned int BoxAndPolygon(const Box &box, const Polygon &polygon, std::vector<Contact> &data, SimplexCache &simplex)
+	{
+		TRACE_SCOPE("CollisionDetector::BoxAndPolygon");
+		counters.pairsTested[BOX_POLYGON]++;
+
+		if (!box.GetBounds().Overlaps(polygon.GetBounds()))
 		{
-			//for each other box (ensuring not to check boxes that have already checked this one)
-			for (unsigned otherBox = box+1; otherBox < objects.BoxesSize() ; otherBox++)
-			{
-				count+=BoxAndBox(objects.GetBoxAt(box), objects.GetBoxAt(otherBox), contacts);
-			}
+			simplex = SimplexCache();
+			return 0;
+		}
 
-			//for each circle
-			for (unsigned circle = 0; circle < objects.CirclesSize(); circle++)
-			{
-				count+=BoxAndCircle(objects.GetBoxAt(box), objects.GetCircleAt(circle), contacts);
-			}
+		const Vector2 origin = box.GetPosition();
+		ConvexProxy one, two;
+		MakeProxy(box, origin, one);
+		MakeProxy(polygon, origin, two);
+		return ConvexAndConvex(one, two, origin, box.GetBody(), polygon.GetBody(), BOX_POLYGON, simplex, data);
+	}
 
-			//for each halfspace
-			for (unsigned halfSpace = 0; halfSpace < objects.HalfSpacesSize(); halfSpace++)
-			{
-				count+=BoxAndHalfSpace(objects.GetBoxAt(box), objects.GetHalfSpaceAt(halfSpace), contacts);
-			}
-		}
+	// Draw Contact //
+	unsigned int BoxAndPolygon(const Box &box, const Polygon &polygon, std::vector<Contact> &data, VertexList &vertexList)
+	{
+		return DrawContactNormal(BoxAndPolygon(box, polygon, data), data, vertexList);
+	}
 
-		//for each circle
-		for (unsigned circle = 0; circle<objects.CirclesSize(); circle++)
-		{
-			//for each other circle
-			for (unsigned otherCircle = circle+1; otherCircle < objects.CirclesSize() ; otherCircle++)
-			{
-				count+=CircleAndCircle(objects.GetCircleAt(circle), objects.GetCircleAt(otherCircle), contacts);
-			}
+	unsigned int CircleAndPolygon(const Circle &circle, const Polygon &polygon, std::vector<Contact> &data)
+	{
+		SimplexCache simplex;
+		return CircleAndPolygon(circle, polygon, data, simplex);
+	}
 
-			//for each halfspace
-			for (unsigned halfSpace = 0; halfSpace < objects.HalfSpacesSize(); halfSpace++)
-			{
-				count+=CircleAndHalfSpace(objects.GetCircleAt(circle), objects.GetHalfSpaceAt(halfSpace), contacts);
-			}
+	unsigned int CircleAndPolygon(const Circle &circle, const Polygon &polygon, std::vector<Contact> &data, SimplexCache &simplex)
+	{
+		TRACE_SCOPE("CollisionDetector::CircleAndPolygon");
+		counters.pairsTested[CIRCLE_POLYGON]++;
+
+		if (!circle.GetBounds().Overlaps(polygon.GetBounds()))
+		{
+			simplex = SimplexCache();
+			return 0;
 		}
 
-		return count;
+		const Vector2 origin = circle.GetPosition();
+		ConvexProxy one, two;
+		MakeProxy(circle, origin, one);
+		MakeProxy(polygon, origin, two);
+		return ConvexAndConvex(one, two, origin, circle.GetBody(), polygon.GetBody(), CIRCLE_POLYGON, simplex, data);
 	}
 
-	unsigned GenerateContactsAndDraw(ObjectList &objects, std::vector<Contact> &contacts, VertexList &vertexList ) 
+	// Draw Contact //
+	unsigned int CircleAndPolygon(const Circle &circle, const Polygon &polygon, std::vector<Contact> &data, VertexList &vertexList)
 	{
-		unsigned count = 0;
+		return DrawContactNormal(CircleAndPolygon(circle, polygon, data), data, vertexList);
+	}
 
-		//for each box
-		for (unsigned box = 0; box<objects.BoxesSize(); box++)
-		{
-			//for each other box (ensuring not to check boxes that have already checked this one)
-			for (unsigned otherBox = box+1; otherBox < objects.BoxesSize() ; otherBox++)
-			{
-				count+=BoxAndBox(objects.GetBoxAt(box), objects.GetBoxAt(otherBox), contacts, vertexList);
-			}
+	unsigned int PolygonAndPolygon(const Polygon &one, const Polygon &two, std::vector<Contact> &data)
+	{
+		SimplexCache simplex;
+		return PolygonAndPolygon(one, two, data, simplex);
+	}
 
-			//for each circle
-			for (unsigned circle = 0; circle < objects.CirclesSize(); circle++)
-			{
-				count+=BoxAndCircle(objects.GetBoxAt(box), objects.GetCircleAt(circle), contacts, vertexList);
-			}
+	unsigned int PolygonAndPolygon(const Polygon &one, const Polygon &two, std::vector<Contact> &data, SimplexCache &simplex)
+	{
+		TRACE_SCOPE("CollisionDetector::PolygonAndPolygon");
+		counters.pairsTested[POLYGON_POLYGON]++;
 
-			//for each halfspace
-			for (unsigned halfSpace = 0; halfSpace < objects.HalfSpacesSize(); halfSpace++)
-			{
-				count+=BoxAndHalfSpace(objects.GetBoxAt(box), objects.GetHalfSpaceAt(halfSpace), contacts, vertexList);
-			}
+		if (!one.GetBounds().Overlaps(two.GetBounds()))
+		{
+			simplex = SimplexCache();
+			return 0;
 		}
 
-		//for each circle
-		for (unsigned circle = 0; circle<objects.CirclesSize(); circle++)
-		{
-			//for each other circle
-			for (unsigned otherCircle = circle+1; otherCircle < objects.CirclesSize() ; otherCircle++)
-			{
-				count+=CircleAndCircle(objects.GetCircleAt(circle), objects.GetCircleAt(otherCircle), contacts, vertexList);
-			}
+		const Vector2 origin = one.GetPosition();
+		ConvexProxy oneProxy, twoProxy;
+		MakeProxy(one, origin, oneProxy);
+		MakeProxy(two, origin, twoProxy);
+		return ConvexAndConvex(oneProxy, twoProxy, origin, one.GetBody(), two.GetBody(), POLYGON_POLYGON, simplex, data);
+	}
 
-			//for each halfspace
-			for (unsigned halfSpace = 0; halfSpace < objects.HalfSpacesSize(); halfSpace++)
+	// Draw Contact //
+	unsigned int PolygonAndPolygon(const Polygon &one, const Polygon &two, std::vector<Contact> &data, VertexList &vertexList)
+	{
+		return DrawContactNormal(PolygonAndPolygon(one, two, data), data, vertexList);
+	}
+
+	// Polygon and HalfSpace //
+	//the deepest vertex, as for a box
+	unsigned int PolygonAndHalfSpace(const Polygon &polygon, const HalfSpace &halfSpace, std::vector<Contact> &data)
+	{
+		TRACE_SCOPE("CollisionDetector::PolygonAndHalfSpace");
+		counters.pairsTested[POLYGON_HALFSPACE]++;
+
+		const Vector2 *vertices = polygon.GetVertices();
+		const Vector2 normal = halfSpace.GetNormal();
+		unsigned deepest = 0;
+		Real deepestDistance = vertices[0] * normal;
+
+		for (unsigned i = 1; i < polygon.GetVertexCount(); i++)
+		{
+			const Real distance = vertices[i] * normal;
+			if (distance < deepestDistance)
 			{
-				count+=CircleAndHalfSpace(objects.GetCircleAt(circle), objects.GetHalfSpaceAt(halfSpace), contacts, vertexList);
+				deepest = i;
+				deepestDistance = distance;
 			}
 		}
 
-		return count;
+		if (deepestDistance > halfSpace.GetOffset())
+			return 0;
+
+		Contact contact;
+		contact.SetContactPoint(vertices[deepest]);
+		contact.SetContactNormal(normal);
+		contact.SetPenetration(halfSpace.GetOffset() - deepestDistance);
+		contact.SetBodyData(polygon.GetBody(), NULL);
+
+		counters.contacts[POLYGON_HALFSPACE]++;
+		data.push_back(contact);
+		return 1;
 	}
 
-	// Add draw info for all contacts in a contact list
-	void DrawContacts(const std::vector<Contact> &contacts, VertexList &vertexList) const
+	// Draw Contact //
+	unsigned int PolygonAndHalfSpace(const Polygon &polygon, const HalfSpace &halfSpace, std::vector<Contact> &data, VertexList &vertexList)
 	{
-		for (unsigned i = 0; i<contacts.size(); i++)
+		return DrawContactNormal(PolygonAndHalfSpace(polygon, halfSpace, data), data, vertexList);
+	}
+
+	// Overlap Tests //
+	//whether two shapes overlap, without working out a contact - all a sensor needs. Each counts touching as the pair's
+	//contact generator does (boxes and polygons touching count, circles only touching don't), working it out the same
+	//way, so a sensor sees the shapes that would have made a contact. Circles on the same centre overlap, though they
+	//make no contact
+	bool BoxOverlapsBox(const Box &box1, const Box &box2)
+	{
+		const Vector2 toCentre = box2.GetPosition() - box1.GetPosition();
+
+		for (unsigned i = 0; i < 4; i++)
 		{
-			DrawContactNormal(contacts[i], vertexList);
+			if (PenetrationOnAxis(box1, box2, GetBoxBoxAxis(box1, box2, i), toCentre) < 0)
+				return false;
 		}
+
+		return true;
 	}
 
-private:
-	// Draw Contact Point and Normal //
-	void DrawContactNormal(const Contact &contact, VertexList & vertexList ) const 
+	bool BoxOverlapsCircle(const Box &box, const Circle &circle) const
 	{
-		//draws a contact
-		DrawLine contactNormal(contact.GetContactPoint(), contact.GetContactPoint() + contact.GetContactNormal());
-		contactNormal.AddDrawInfo(vertexList, RED);
+		//how far the centre is outside the box on each of its axes
+		const Vector2 centre = ToBoxCoordinates(box, circle.GetPosition() - box.GetPosition());
+		const Vector2 halfSize = box.GetHalfSize();
+		Vector2 outside(abs(centre.x) - halfSize.x, abs(centre.y) - halfSize.y);
+
+		if (outside.x < 0)
+			outside.x = 0;
+		if (outside.y < 0)
+			outside.y = 0;
+
+		return outside.SquaredMagnitude() <= circle.GetRadius()*circle.GetRadius();
 	}
-	
-	unsigned int DrawContactNormal(const unsigned &result, std::vector<Contact> &data, VertexList &vertexList) const
+
+	bool CircleOverlapsCircle(const Circle &one, const Circle &two) const
 	{
-		//used exclusively by contact generation functions to draw contact normal. 
-		//uses function's return value to see whether to bother drawing or not.
-		if (result == 0)
-			return 0;
+		return (one.GetPosition() - two.GetPosition()).Magnitude() < one.GetRadius() + two.GetRadius();
+	}
 
-		Contact &contact = data.back();
-		DrawContactNormal(contact, vertexList);
+	bool BoxOverlapsHalfSpace(const Box &box, const HalfSpace &halfSpace) const
+	{
+		Vector2 vertices[4];
+		box.GetVertices(vertices);
 
-		return result;
+		for (unsigned i = 0; i < 4; i++)
+		{
+			if (vertices[i] * halfSpace.GetNormal() <= halfSpace.GetOffset())
+				return true;
+		}
+
+		return false;
+	}
+
+	bool CircleOverlapsHalfSpace(const Circle &circle, const HalfSpace &halfSpace) const
+	{
+		return halfSpace.GetNormal() * circle.GetPosition() - circle.GetRadius() - halfSpace.GetOffset() < 0;
 	}
 
+	//pairs with a polygon in by GJK, bounds first
+	bool BoxOverlapsPolygon(const Box &box, const Polygon &polygon)
+	{
+		if (!box.GetBounds().Overlaps(polygon.GetBounds()))
+			return false;
 
-	// Box and Box Methods //
+		ConvexProxy one, two;
+		MakeProxy(box, box.GetPosition(), one);
+		MakeProxy(polygon, box.GetPosition(), two);
+		return ConvexOverlaps(one, two);
+	}
+
+	bool CircleOverlapsPolygon(const Circle &circle, const Polygon &polygon)
+	{
+		if (!circle.GetBounds().Overlaps(polygon.GetBounds()))
+			return false;
+
+		ConvexProxy one, two;
+		MakeProxy(circle, circle.GetPosition(), one);
+		MakeProxy(polygon, circle.GetPosition(), two);
+		return ConvexOverlaps(one, two);
+	}
+
+	bool PolygonOverlapsPolygon(const Polygon &one, const Polygon &two)
+	{
+		if (!one.GetBounds().Overlaps(two.GetBounds()))
+			return false;
+
+		ConvexProxy oneProxy, twoProxy;
+		MakeProxy(one, one.GetPosition(), oneProxy);
+		MakeProxy(two, one.GetPosition(), twoProxy);
+		return ConvexOverlaps(oneProxy, twoProxy);
+	}
+
+	bool PolygonOverlapsHalfSpace(const Polygon &polygon, const HalfSpace &halfSpace) const
+	{
+		const Vector2 *vertices = polygon.GetVertices();
+
+		for (unsigned i = 0; i < polygon.GetVertexCount(); i++)
+		{
+			if (vertices[i] * halfSpace.GetNormal() <= halfSpace.GetOffset())
+				return true;
+		}
+
+		return false;
+	}
+
+	//whether shapes a and b of the list overlap, numbered as in World (boxes, circles, polygons, then halfspaces) with
+	//a first
+	bool ShapesOverlap(const ObjectList &objects, const unsigned a, const unsigned b)
+	{
+		counters.sensorPairsTested++;
+
+		const unsigned boxCount = objects.BoxesSize();
+		const unsigned circleEnd = boxCount + objects.CirclesSize();
+		const unsigned shapeCount = objects.FiniteSize();
+		bool overlap;
+
+		if (a < boxCount)
+		{
+			const Box &box = objects.GetBoxAt(a);
+
+			if (b < boxCount)
+				overlap = BoxOverlapsBox(box, objects.GetBoxAt(b));
+			else if (b < circleEnd)
+				overlap = BoxOverlapsCircle(box, objects.GetCircleAt(b - boxCount));
+			else if (b < shapeCount)
+				overlap = BoxOverlapsPolygon(box, objects.GetPolygonAt(b - circleEnd));
+			else
+				overlap = BoxOverlapsHalfSpace(box, objects.GetHalfSpaceAt(b - shapeCount));
+		}
+		else if (a < circleEnd)
+		{
+			const Circle &circle = objects.GetCircleAt(a - boxCount);
+
+			if (b < circleEnd)
+				overlap = CircleOverlapsCircle(circle, objects.GetCircleAt(b - boxCount));
+			else if (b < shapeCount)
+				overlap = CircleOverlapsPolygon(circle, objects.GetPolygonAt(b - circleEnd));
+			else
+				overlap = CircleOverlapsHalfSpace(circle, objects.GetHalfSpaceAt(b - shapeCount));
+		}
+		else
+		{
+			const Polygon &polygon = objects.GetPolygonAt(a - circleEnd);
+
+			if (b < shapeCount)
+				overlap = PolygonOverlapsPolygon(polygon, objects.GetPolygonAt(b - circleEnd));
+			else
+				overlap = PolygonOverlapsHalfSpace(polygon, objects.GetHalfSpaceAt(b - shapeCount));
+		}
+
+		if (overlap)
+			counters.sensorOverlaps++;
+
+		return overlap;
+	}
+
+	// Checks every pair with a sensor in (see ShouldSense) for overlap, appending the ones that do to overlaps in order
+	// - the brute force version of what World does for sensors. Returns the number found
+	unsigned FindSensorOverlaps(const ObjectList &objects, std::vector<ShapePair> &overlaps)
+	{
+		TRACE_SCOPE("CollisionDetector::FindSensorOverlaps");
+
+		const unsigned shapeCount = objects.FiniteSize();
+		const unsigned start = overlaps.size();
+
+		//halfspaces only come second, as they never pair with each other
+		for (unsigned a = 0; a < shapeCount; a++)
+		{
+			const Shape &one = objects.GetShapeAt(a);
+
+			for (unsigned b = a+1; b < objects.Size(); b++)
+			{
+				if (ShouldSense(one, objects.GetShapeAt(b)) && ShapesOverlap(objects, a, b))
+				{
+					const ShapePair pair = {a, b};
+					overlaps.push_back(pair);
+				}
+			}
+		}
+
+		return overlaps.size() - start;
+	}
+
+	// Overlapping Pairs //
+	//appends every pair whose bounds (grown by margin) overlap and that the shapes' filters let through, in pair order -
+	//the pairs the grid broadphase finds, so a brute force world can track them too. As there, two immovable shapes
+	//never pair, a shape whose bounds have blown up only pairs with every halfspace, and a shape pairs with a halfspace
+	//when the nearest point of its bounds is on or behind it, worked out in floats in the same order
+	unsigned FindOverlappingPairs(const ObjectList &objects, const Real margin, std::vector<ShapePair> &pairs)
+	{
+		TRACE_SCOPE("CollisionDetector::FindOverlappingPairs");
+
+		const unsigned shapeCount = objects.FiniteSize();
+		const unsigned start = pairs.size();
+
+		for (unsigned a = 0; a < shapeCount; a++)
+		{
+			const Shape &one = objects.GetShapeAt(a);
+			const AABB bounds = GetBoundsOf(objects, a, margin);
+			const bool finite = bounds.IsFinite();
+
+			for (unsigned b = a+1; b < objects.Size(); b++)
+			{
+				const Shape &two = objects.GetShapeAt(b);
+				if ((one.IsImmovable() && (b >= shapeCount || two.IsImmovable())) || !ShouldCollide(one.GetFilter(), two.GetFilter()))
+					continue;
+
+				bool overlaps;
+				if (b < shapeCount)
+				{
+					const AABB other = GetBoundsOf(objects, b, margin);
+					overlaps = finite && other.IsFinite() && bounds.Overlaps(other);
+				}
+				else
+					overlaps = !finite || BoundsReach(bounds, objects.GetHalfSpaceAt(b - shapeCount));
+
+				if (overlaps)
+				{
+					const ShapePair pair = {a, b};
+					pairs.push_back(pair);
+				}
+			}
+		}
+
+		return pairs.size() - start;
+	}
+
+	// Ray Casts //
+	//each tests one shape against a ray, and only counts it as hit if it is nearer than hit already is (so a RayHit
+	//fresh from its constructor takes anything along the ray), filling in hit's point, normal and fraction if so. The
+	//caller fills in the shape
+	bool RayAndCircle(const Ray &ray, const Circle &circle, RayHit &hit)
+	{
+		counters.rayTests++;
+
+		const Vector2 direction = ray.to - ray.from;
+		const Real length = SafeMagnitude(direction);
+		if (length <= 0)
+			return false;
+
+		//where the ray passes closest to the centre, as a distance along it from its start and an offset from the centre
+		//(each component checked before squaring, so far off circles can't overflow fixed point)
+		const Real radius = circle.GetRadius();
+		const Vector2 unit(direction.x / length, direction.y / length);
+		const Vector2 start = ray.from - circle.GetPosition();
+		const Real closest = -(start * unit);
+		const Vector2 offset = start + unit*closest;
+
+		if (closest < 0 || abs(offset.x) > radius || abs(offset.y) > radius)
+			return false;
+
+		const Real squaredHalfChord = radius*radius - offset.SquaredMagnitude();
+		if (squaredHalfChord < 0)
+			return false;
+
+		//starting inside
+		const Real distance = closest - sqrt(squaredHalfChord);
+		if (distance < 0 || distance >= length*hit.fraction)
+			return false;
+
+		hit.fraction = distance / length;
+		hit.point = ray.from + unit*distance;
+		hit.normal = (hit.point - circle.GetPosition()) * (1/radius);
+		counters.rayHits++;
+		return true;
+	}
+
+	bool RayAndBox(const Ray &ray, const Box &box, RayHit &hit)
+	{
+		counters.rayTests++;
+
+		//the ray in the box's own coordinates, where the box is two slabs, one on each axis - the ray is inside the box
+		//between the last slab it enters and the first it leaves
+		const Vector2 start = ToBoxCoordinates(box, ray.from - box.GetPosition());
+		const Vector2 direction = ToBoxCoordinates(box, ray.to - ray.from);
+		const Vector2 halfSize = box.GetHalfSize();
+		const Real starts[2] = {start.x, start.y};
+		const Real directions[2] = {direction.x, direction.y};
+		const Real halfSizes[2] = {halfSize.x, halfSize.y};
+
+		Real enter = 0;
+		Real exit = hit.fraction;
+		int enteredAxis = -1;
+		Real enteredSide = 0;
+
+		for (int axis = 0; axis < 2; axis++)
+		{
+			if (directions[axis] == 0)
+			{
+				if (abs(starts[axis]) > halfSizes[axis])
+					return false;
+				continue;
+			}
+
+			Real near = SlabFraction(-halfSizes[axis] - starts[axis], directions[axis]);
+			Real far = SlabFraction(halfSizes[axis] - starts[axis], directions[axis]);
+			Real side = -1;
+
+			if (near > far)
+			{
+				const Real swap = near;
+				near = far;
+				far = swap;
+				side = 1;
+			}
+
+			if (near >= enter)
+			{
+				enter = near;
+				enteredAxis = axis;
+				enteredSide = side;
+			}
+			if (far < exit)
+				exit = far;
+
+			if (enter > exit)
+				return false;
+		}
+
+		//starting inside, or no nearer than hit
+		if (enteredAxis < 0 || enter >= hit.fraction)
+			return false;
+
+		hit.fraction = enter;
+		hit.point = ray.from + (ray.to - ray.from)*enter;
+		hit.normal = (enteredAxis == 0 ? box.GetXAxis() : box.GetYAxis()) * enteredSide;
+		counters.rayHits++;
+		return true;
+	}
+
+	bool RayAndPolygon(const Ray &ray, const Polygon &polygon, RayHit &hit)
+	{
+		counters.rayTests++;
+
+		//as for a box, with a slab's one side for each edge: the ray is inside between the last edge it crosses going in
+		//and the first it crosses going out
+		const Vector2 *vertices = polygon.GetVertices();
+		const Vector2 *normals = polygon.GetNormals();
+		const Vector2 direction = ray.to - ray.from;
+
+		Real enter = 0;
+		Real exit = hit.fraction;
+		int enteredEdge = -1;
+
+		for (unsigned i = 0; i < polygon.GetVertexCount(); i++)
+		{
+			const Real distance = normals[i] * (vertices[i] - ray.from);
+			const Real along = normals[i] * direction;
+
+			if (along == 0)
+			{
+				if (distance < 0)
+					return false;
+				continue;
+			}
+
+			const Real fraction = SlabFraction(distance, along);
+
+			if (along < 0)
+			{
+				if (fraction >= enter)
+				{
+					enter = fraction;
+					enteredEdge = i;
+				}
+			}
+			else if (fraction < exit)
+				exit = fraction;
+
+			if (enter > exit)
+				return false;
+		}
+
+		//starting inside, or no nearer than hit
+		if (enteredEdge < 0 || enter >= hit.fraction)
+			return false;
+
+		hit.fraction = enter;
+		hit.point = ray.from + direction*enter;
+		hit.normal = normals[enteredEdge];
+		counters.rayHits++;
+		return true;
+	}
+
+	bool RayAndHalfSpace(const Ray &ray, const HalfSpace &halfSpace, RayHit &hit)
+	{
+		counters.rayTests++;
+
+		//heights above the surface of both ends - the ray has to start above it and end below
+		const Real start = halfSpace.GetNormal() * ray.from - halfSpace.GetOffset();
+		const Real end = halfSpace.GetNormal() * ray.to - halfSpace.GetOffset();
+		if (start <= 0 || end >= 0)
+			return false;
+
+		const Real fraction = start / (start - end);
+		if (fraction >= hit.fraction)
+			return false;
+
+		hit.fraction = fraction;
+		hit.point = ray.from + (ray.to - ray.from)*fraction;
+		hit.normal = halfSpace.GetNormal();
+		counters.rayHits++;
+		return true;
+	}
+
+	//tests shape index of the list (numbered as in World) against the ray, filling in hit's shape if it is the nearest
+	//yet. Sensors and shapes the ray's filter rules out are never hit
+	bool RayAndShape(const ObjectList &objects, const unsigned index, const Ray &ray, RayHit &hit)
+	{
+		const Shape &shape = objects.GetShapeAt(index);
+		if (shape.IsSensor() || !ShouldCollide(ray.filter, shape.GetFilter()))
+			return false;
+
+		const unsigned boxCount = objects.BoxesSize();
+		const unsigned circleEnd = boxCount + objects.CirclesSize();
+		const unsigned shapeCount = objects.FiniteSize();
+		bool nearer;
+
+		if (index < boxCount)
+			nearer = RayAndBox(ray, objects.GetBoxAt(index), hit);
+		else if (index < circleEnd)
+			nearer = RayAndCircle(ray, objects.GetCircleAt(index - boxCount), hit);
+		else if (index < shapeCount)
+			nearer = RayAndPolygon(ray, objects.GetPolygonAt(index - circleEnd), hit);
+		else
+			nearer = RayAndHalfSpace(ray, objects.GetHalfSpaceAt(index - shapeCount), hit);
+
+		if (nearer)
+			hit.shape = index;
+
+		return nearer;
+	}
+
+	// Tests the ray against every shape, leaving the nearest hit in hit - the brute force version of World::RayCast.
+	// Returns whether anything was hit
+	bool RayCast(const ObjectList &objects, const Ray &ray, RayHit &hit)
+	{
+		TRACE_SCOPE("CollisionDetector::RayCast");
+
+		hit = RayHit();
+		for (unsigned i = 0; i < objects.Size(); i++)
+		{
+			RayAndShape(objects, i, ray, hit);
+		}
+
+		return hit.IsHit();
+	}
+
+	// Region Queries //
+	//whether a shape overlaps an axis aligned region - touching counts, and a region with no size is a point
+	bool RegionOverlapsBox(const AABB &region, const Box &box) const
+	{
+		//the box's bounds are the region's own axes, which leaves the box's two
+		if (!region.Overlaps(box.GetBounds()))
+			return false;
+
+		const Vector2 halfRegion = (region.max - region.min) * 0.5f;
+		const Vector2 centre = ToBoxCoordinates(box, region.min + halfRegion - box.GetPosition());
+		const Vector2 halfSize = box.GetHalfSize();
+		const Vector2 xAxis = box.GetXAxis();
+		const Vector2 yAxis = box.GetYAxis();
+
+		return abs(centre.x) <= halfSize.x + abs(xAxis.x)*halfRegion.x + abs(xAxis.y)*halfRegion.y
+			&& abs(centre.y) <= halfSize.y + abs(yAxis.x)*halfRegion.x + abs(yAxis.y)*halfRegion.y;
+	}
+
+	bool RegionOverlapsCircle(const AABB &region, const Circle &circle) const
+	{
+		//how far the centre is outside the region on each axis, each checked before squaring
+		const Vector2 centre = circle.GetPosition();
+		const Real radius = circle.GetRadius();
+		Vector2 outside;
+
+		if (centre.x < region.min.x)
+			outside.x = region.min.x - centre.x;
+		else if (centre.x > region.max.x)
+			outside.x = centre.x - region.max.x;
+		if (centre.y < region.min.y)
+			outside.y = region.min.y - centre.y;
+		else if (centre.y > region.max.y)
+			outside.y = centre.y - region.max.y;
+
+		if (outside.x > radius || outside.y > radius)
+			return false;
+
+		return outside.SquaredMagnitude() <= radius*radius;
+	}
+
+	bool RegionOverlapsPolygon(const AABB &region, const Polygon &polygon) const
+	{
+		//the polygon's bounds are the region's own axes, which leaves its edges - each separates if the region's corner
+		//furthest behind it is still in front
+		if (!region.Overlaps(polygon.GetBounds()))
+			return false;
+
+		const Vector2 halfRegion = (region.max - region.min) * 0.5f;
+		const Vector2 centre = region.min + halfRegion;
+		const Vector2 *vertices = polygon.GetVertices();
+		const Vector2 *normals = polygon.GetNormals();
+
+		for (unsigned i = 0; i < polygon.GetVertexCount(); i++)
+		{
+			const Vector2 normal = normals[i];
+			if (normal * (centre - vertices[i]) - abs(normal.x)*halfRegion.x - abs(normal.y)*halfRegion.y > 0)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool RegionOverlapsHalfSpace(const AABB &region, const HalfSpace &halfSpace) const
+	{
+		//the corner furthest into the halfspace
+		const Vector2 halfRegion = (region.max - region.min) * 0.5f;
+		const Vector2 normal = halfSpace.GetNormal();
+
+		return normal * (region.min + halfRegion) - abs(normal.x)*halfRegion.x - abs(normal.y)*halfRegion.y <= halfSpace.GetOffset();
+	}
+
+	//whether shape index of the list (numbered as in World) overlaps the region and is let through by filter, as a
+	//shape's would
+	bool RegionAndShape(const ObjectList &objects, const unsigned index, const AABB &region, const CollisionFilter &filter)
+	{
+		if (!ShouldCollide(filter, objects.GetShapeAt(index).GetFilter()))
+			return false;
+
+		counters.regionTests++;
+
+		const unsigned boxCount = objects.BoxesSize();
+		const unsigned circleEnd = boxCount + objects.CirclesSize();
+		const unsigned shapeCount = objects.FiniteSize();
+		bool overlap;
+
+		if (index < boxCount)
+			overlap = RegionOverlapsBox(region, objects.GetBoxAt(index));
+		else if (index < circleEnd)
+			overlap = RegionOverlapsCircle(region, objects.GetCircleAt(index - boxCount));
+		else if (index < shapeCount)
+			overlap = RegionOverlapsPolygon(region, objects.GetPolygonAt(index - circleEnd));
+		else
+			overlap = RegionOverlapsHalfSpace(region, objects.GetHalfSpaceAt(index - shapeCount));
+
+		if (overlap)
+			counters.regionOverlaps++;
+
+		return overlap;
+	}
+
+	// Fills shapes with every shape overlapping the region that filter lets through, in order - the brute force
+	// version of World::QueryRegion. Returns the number found
+	unsigned QueryRegion(const ObjectList &objects, const AABB &region, const CollisionFilter &filter, std::vector<unsigned> &shapes)
+	{
+		TRACE_SCOPE("CollisionDetector::QueryRegion");
+
+		shapes.clear();
+		for (unsigned i = 0; i < objects.Size(); i++)
+		{
+			if (RegionAndShape(objects, i, region, filter))
+				shapes.push_back(i);
+		}
+
+		return shapes.size();
+	}
+
+	// Shape Casts //
+	//tests one shape against a swept shape by conservative advancement: find the distance between them and the
+	//direction it is in, move the swept shape on as far as it can go without closing that distance, and repeat until
+	//they are within castTolerance. Convex shapes moving in a straight line only get closer while closing along that
+	//direction, so a swept shape moving apart, or only sliding along, never hits. Counts as for the ray casts: only
+	//a hit nearer than hit already is, filling in the shape too. Shapes the swept shape already overlaps are passed
+	//through, as are sensors, its own body and shapes its filter rules out
+	bool SweptShapeAndShape(const ObjectList &objects, const unsigned index, const SweptShape &swept, RayHit &hit)
+	{
+		const Shape &shape = objects.GetShapeAt(index);
+		if (shape.GetBody() == swept.body || shape.IsSensor() || !ShouldCollide(swept.filter, shape.GetFilter()))
+			return false;
+
+		counters.castTests++;
+
+		Real fraction = 0;
+		Vector2 normal, point;
+
+		for (unsigned iteration = 0; iteration < maxCastIterations; iteration++)
+		{
+			const Real distance = SweptDistance(objects, index, swept, fraction, normal, point);
+
+			//overlapping from the start, or (through rounding) an advance went too far
+			if (distance <= 0)
+			{
+				if (fraction == 0)
+					return false;
+				break;
+			}
+
+			const Real closing = -(swept.translation * normal);
+			if (closing <= 0)
+				return false;
+
+			if (distance <= castTolerance)
+				break;
+
+			//checked before dividing, so a swept shape barely closing can't overflow fixed point
+			const Real advance = distance - castTolerance*0.5f;
+			if (advance >= closing*(hit.fraction - fraction))
+				return false;
+
+			fraction += advance / closing;
+		}
+
+		if (fraction >= hit.fraction)
+			return false;
+
+		hit.fraction = fraction;
+		hit.normal = normal;
+		hit.point = point;
+		hit.shape = index;
+		counters.castHits++;
+		return true;
+	}
+
+	// Tests the swept shape against every shape, leaving the first hit in hit - the brute force version of
+	// World::ShapeCast. Returns whether anything was hit
+	bool ShapeCast(const ObjectList &objects, const SweptShape &swept, RayHit &hit)
+	{
+		TRACE_SCOPE("CollisionDetector::ShapeCast");
+
+		hit = RayHit();
+		for (unsigned i = 0; i < objects.Size(); i++)
+		{
+			SweptShapeAndShape(objects, i, swept, hit);
+		}
+
+		return hit.IsHit();
+	}
+
+	// Checks all objects in object list against each other for collisions - obviously not optimised at all. Pairs of
+	// immovable shapes (halfspaces included) are skipped, as are pairs the shapes' collision filters rule out
+	// returns number of collisions
+	unsigned GenerateContacts(ObjectList &objects, std::vector<Contact> &contacts)
+	{
+		return GenerateContacts(objects, contacts, NULL);
+	}
+
+	// As above, also appending the pair each contact is between to contactPairs (for a ContactGraph), numbered as in
+	// World: boxes, circles, polygons, then halfspaces. contactPairs needs one entry for each contact already in contacts
+	unsigned GenerateContacts(ObjectList &objects, std::vector<Contact> &contacts, std::vector<ShapePair> &contactPairs)
+	{
+		return GenerateContacts(objects, contacts, &contactPairs);
+	}
+
+	unsigned GenerateContactsAndDraw(ObjectList &objects, std::vector<Contact> &contacts, VertexList &vertexList ) 
+	{
+		TRACE_SCOPE("CollisionDetector::GenerateContactsAndDraw");
+
+		unsigned count = 0;
+
+		//for each box
+		for (unsigned box = 0; box<objects.BoxesSize(); box++)
+		{
+			//for each other box (ensuring not to check boxes that have already checked this one)
+			for (unsigned otherBox = box+1; otherBox < objects.BoxesSize() ; otherBox++)
+			{
+				if (ShouldTest(objects.GetBoxAt(box), objects.GetBoxAt(otherBox)))
+					count+=BoxAndBox(objects.GetBoxAt(box), objects.GetBoxAt(otherBox), contacts, vertexList);
+			}
+
+			//for each circle
+			for (unsigned circle = 0; circle < objects.CirclesSize(); circle++)
+			{
+				if (ShouldTest(objects.GetBoxAt(box), objects.GetCircleAt(circle)))
+					count+=BoxAndCircle(objects.GetBoxAt(box), objects.GetCircleAt(circle), contacts, vertexList);
+			}
+
+			//for each polygon
+			for (unsigned polygon = 0; polygon < objects.PolygonsSize(); polygon++)
+			{
+				if (ShouldTest(objects.GetBoxAt(box), objects.GetPolygonAt(polygon)))
+					count+=BoxAndPolygon(objects.GetBoxAt(box), objects.GetPolygonAt(polygon), contacts, vertexList);
+			}
+
+			//for each halfspace
+			for (unsigned halfSpace = 0; halfSpace < objects.HalfSpacesSize(); halfSpace++)
+			{
+				if (ShouldTest(objects.GetBoxAt(box), objects.GetHalfSpaceAt(halfSpace)))
+					count+=BoxAndHalfSpace(objects.GetBoxAt(box), objects.GetHalfSpaceAt(halfSpace), contacts, vertexList);
+			}
+		}
+
+		//for each circle
+		for (unsigned circle = 0; circle<objects.CirclesSize(); circle++)
+		{
+			//for each other circle
+			for (unsigned otherCircle = circle+1; otherCircle < objects.CirclesSize() ; otherCircle++)
+			{
+				if (ShouldTest(objects.GetCircleAt(circle), objects.GetCircleAt(otherCircle)))
+					count+=CircleAndCircle(objects.GetCircleAt(circle), objects.GetCircleAt(otherCircle), contacts, vertexList);
+			}
+
+			//for each polygon
+			for (unsigned polygon = 0; polygon < objects.PolygonsSize(); polygon++)
+			{
+				if (ShouldTest(objects.GetCircleAt(circle), objects.GetPolygonAt(polygon)))
+					count+=CircleAndPolygon(objects.GetCircleAt(circle), objects.GetPolygonAt(polygon), contacts, vertexList);
+			}
+
+			//for each halfspace
+			for (unsigned halfSpace = 0; halfSpace < objects.HalfSpacesSize(); halfSpace++)
+			{
+				if (ShouldTest(objects.GetCircleAt(circle), objects.GetHalfSpaceAt(halfSpace)))
+					count+=CircleAndHalfSpace(objects.GetCircleAt(circle), objects.GetHalfSpaceAt(halfSpace), contacts, vertexList);
+			}
+		}
+
+		//for each polygon
+		for (unsigned polygon = 0; polygon < objects.PolygonsSize(); polygon++)
+		{
+			//for each other polygon
+			for (unsigned otherPolygon = polygon+1; otherPolygon < objects.PolygonsSize(); otherPolygon++)
+			{
+				if (ShouldTest(objects.GetPolygonAt(polygon), objects.GetPolygonAt(otherPolygon)))
+					count+=PolygonAndPolygon(objects.GetPolygonAt(polygon), objects.GetPolygonAt(otherPolygon), contacts, vertexList);
+			}
+
+			//for each halfspace
+			for (unsigned halfSpace = 0; halfSpace < objects.HalfSpacesSize(); halfSpace++)
+			{
+				if (ShouldTest(objects.GetPolygonAt(polygon), objects.GetHalfSpaceAt(halfSpace)))
+					count+=PolygonAndHalfSpace(objects.GetPolygonAt(polygon), objects.GetHalfSpaceAt(halfSpace), contacts, vertexList);
+			}
+		}
+
+		return count;
+	}
+
+	// Add draw info for all contacts in a contact list
+	void DrawContacts(const std::vector<Contact> &contacts, VertexList &vertexList) const
+	{
+		for (unsigned i = 0; i<contacts.size(); i++)
+		{
+			DrawContactNormal(contacts[i], vertexList);
+		}
+	}
+
+private:
+	// Brute Force //
+	unsigned GenerateContacts(ObjectList &objects, std::vector<Contact> &contacts, std::vector<ShapePair> *contactPairs)
+	{
+		TRACE_SCOPE("CollisionDetector::GenerateContacts");
+
+		unsigned count = 0;
+		const unsigned boxCount = objects.BoxesSize();
+		const unsigned circleEnd = boxCount + objects.CirclesSize();
+		const unsigned shapeCount = objects.FiniteSize();
+
+		simplices.swap(lastSimplices);
+		simplices.clear();
+		nextLastSimplex = 0;
+
+		//for each box
+		for (unsigned box = 0; box<objects.BoxesSize(); box++)
+		{
+			//for each other box (ensuring not to check boxes that have already checked this one)
+			for (unsigned otherBox = box+1; otherBox < objects.BoxesSize() ; otherBox++)
+			{
+				if (ShouldTest(objects.GetBoxAt(box), objects.GetBoxAt(otherBox)))
+				{
+					count+=BoxAndBox(objects.GetBoxAt(box), objects.GetBoxAt(otherBox), contacts);
+					AddContactPairs(contactPairs, contacts, box, otherBox);
+				}
+			}
+
+			//for each circle
+			for (unsigned circle = 0; circle < objects.CirclesSize(); circle++)
+			{
+				if (ShouldTest(objects.GetBoxAt(box), objects.GetCircleAt(circle)))
+				{
+					count+=BoxAndCircle(objects.GetBoxAt(box), objects.GetCircleAt(circle), contacts);
+					AddContactPairs(contactPairs, contacts, box, boxCount + circle);
+				}
+			}
+
+			//for each polygon
+			for (unsigned polygon = 0; polygon < objects.PolygonsSize(); polygon++)
+			{
+				if (ShouldTest(objects.GetBoxAt(box), objects.GetPolygonAt(polygon)))
+				{
+					SimplexCache simplex = FindLastSimplex(box, circleEnd + polygon);
+					count+=BoxAndPolygon(objects.GetBoxAt(box), objects.GetPolygonAt(polygon), contacts, simplex);
+					KeepSimplex(box, circleEnd + polygon, simplex);
+					AddContactPairs(contactPairs, contacts, box, circleEnd + polygon);
+				}
+			}
+
+			//for each halfspace
+			for (unsigned halfSpace = 0; halfSpace < objects.HalfSpacesSize(); halfSpace++)
+			{
+				if (ShouldTest(objects.GetBoxAt(box), objects.GetHalfSpaceAt(halfSpace)))
+				{
+					count+=BoxAndHalfSpace(objects.GetBoxAt(box), objects.GetHalfSpaceAt(halfSpace), contacts);
+					AddContactPairs(contactPairs, contacts, box, shapeCount + halfSpace);
+				}
+			}
+		}
+
+		//for each circle
+		for (unsigned circle = 0; circle<objects.CirclesSize(); circle++)
+		{
+			//for each other circle
+			for (unsigned otherCircle = circle+1; otherCircle < objects.CirclesSize() ; otherCircle++)
+			{
+				if (ShouldTest(objects.GetCircleAt(circle), objects.GetCircleAt(otherCircle)))
+				{
+					count+=CircleAndCircle(objects.GetCircleAt(circle), objects.GetCircleAt(otherCircle), contacts);
+					AddContactPairs(contactPairs, contacts, boxCount + circle, boxCount + otherCircle);
+				}
+			}
+
+			//for each polygon
+			for (unsigned polygon = 0; polygon < objects.PolygonsSize(); polygon++)
+			{
+				if (ShouldTest(objects.GetCircleAt(circle), objects.GetPolygonAt(polygon)))
+				{
+					SimplexCache simplex = FindLastSimplex(boxCount + circle, circleEnd + polygon);
+					count+=CircleAndPolygon(objects.GetCircleAt(circle), objects.GetPolygonAt(polygon), contacts, simplex);
+					KeepSimplex(boxCount + circle, circleEnd + polygon, simplex);
+					AddContactPairs(contactPairs, contacts, boxCount + circle, circleEnd + polygon);
+				}
+			}
+
+			//for each halfspace
+			for (unsigned halfSpace = 0; halfSpace < objects.HalfSpacesSize(); halfSpace++)
+			{
+				if (ShouldTest(objects.GetCircleAt(circle), objects.GetHalfSpaceAt(halfSpace)))
+				{
+					count+=CircleAndHalfSpace(objects.GetCircleAt(circle), objects.GetHalfSpaceAt(halfSpace), contacts);
+					AddContactPairs(contactPairs, contacts, boxCount + circle, shapeCount + halfSpace);
+				}
+			}
+		}
+
+		//for each polygon
+		for (unsigned polygon = 0; polygon < objects.PolygonsSize(); polygon++)
+		{
+			//for each other polygon
+			for (unsigned otherPolygon = polygon+1; otherPolygon < objects.PolygonsSize(); otherPolygon++)
+			{
+				if (ShouldTest(objects.GetPolygonAt(polygon), objects.GetPolygonAt(otherPolygon)))
+				{
+					SimplexCache simplex = FindLastSimplex(circleEnd + polygon, circleEnd + otherPolygon);
+					count+=PolygonAndPolygon(objects.GetPolygonAt(polygon), objects.GetPolygonAt(otherPolygon), contacts, simplex);
+					KeepSimplex(circleEnd + polygon, circleEnd + otherPolygon, simplex);
+					AddContactPairs(contactPairs, contacts, circleEnd + polygon, circleEnd + otherPolygon);
+				}
+			}
+
+			//for each halfspace
+			for (unsigned halfSpace = 0; halfSpace < objects.HalfSpacesSize(); halfSpace++)
+			{
+				if (ShouldTest(objects.GetPolygonAt(polygon), objects.GetHalfSpaceAt(halfSpace)))
+				{
+					count+=PolygonAndHalfSpace(objects.GetPolygonAt(polygon), objects.GetHalfSpaceAt(halfSpace), contacts);
+					AddContactPairs(contactPairs, contacts, circleEnd + polygon, shapeCount + halfSpace);
+				}
+			}
+		}
+
+		return count;
+	}
+
+	//last call's simplex for the pair, or an empty one if it had none. Pairs have to be asked for in order
+	SimplexCache FindLastSimplex(const unsigned a, const unsigned b)
+	{
+		while (nextLastSimplex < lastSimplices.size())
+		{
+			const ShapePair &last = lastSimplices[nextLastSimplex].pair;
+			if (last.a > a || (last.a == a && last.b >= b))
+				break;
+
+			nextLastSimplex++;
+		}
+
+		if (nextLastSimplex < lastSimplices.size() && lastSimplices[nextLastSimplex].pair.a == a
+			&& lastSimplices[nextLastSimplex].pair.b == b)
+			return lastSimplices[nextLastSimplex].simplex;
+
+		return SimplexCache();
+	}
+
+	//keeps the simplex the pair finished with for next call, unless there isn't one
+	void KeepSimplex(const unsigned a, const unsigned b, const SimplexCache &simplex)
+	{
+		if (simplex.count == 0)
+			return;
+
+		CachedSimplex cached;
+		cached.pair.a = a;
+		cached.pair.b = b;
+		cached.simplex = simplex;
+		simplices.push_back(cached);
+	}
+
+	//gives each contact made since contactPairs was last brought level with contacts the pair a, b (if there is a list)
+	static void AddContactPairs(std::vector<ShapePair> *contactPairs, const std::vector<Contact> &contacts, const unsigned a, const unsigned b)
+	{
+		if (contactPairs)
+		{
+			const ShapePair pair = {a, b};
+			contactPairs->resize(contacts.size(), pair);
+		}
+	}
+
+	// Ray Cast Methods //
+
+	//length of a vector, scaled down first so squaring a long one can't overflow fixed point
+	static Real SafeMagnitude(const Vector2 &vector)
+	{
+		const Real largest = std::max(abs(vector.x), abs(vector.y));
+		if (largest <= 0)
+			return 0;
+
+		return Vector2(vector.x / largest, vector.y / largest).Magnitude() * largest;
+	}
+
+	//distance / along, the fraction along a ray where it reaches a slab's side, clamped well outside the ray (0 to 1)
+	//so a ray nearly parallel to the slab can't overflow fixed point
+	static Real SlabFraction(const Real distance, const Real along)
+	{
+		const Real bound = 2;
+		if (abs(distance) > abs(along)*bound)
+			return (distance < 0) != (along < 0) ? -bound : bound;
+
+		return distance / along;
+	}
+
+	// Shape Cast Methods //
+
+	//distance between the swept shape, moved fraction of the way along, and shape index of the list, with the direction
+	//from the shape to it and the nearest point on the shape. 0 or less if they overlap (not how far), with no direction
+	Real SweptDistance(const ObjectList &objects, const unsigned index, const SweptShape &swept, const Real fraction, Vector2 &normal, Vector2 &point) const
+	{
+		SweptShape moved(swept);
+		moved.position += swept.translation*fraction;
+
+		const unsigned boxCount = objects.BoxesSize();
+		const unsigned circleEnd = boxCount + objects.CirclesSize();
+		const unsigned shapeCount = objects.FiniteSize();
+
+		if (index < boxCount)
+			return Separation(moved, SweptShape(objects.GetBoxAt(index), Vector2()), normal, point);
+		if (index < circleEnd)
+			return Separation(moved, SweptShape(objects.GetCircleAt(index - boxCount), Vector2()), normal, point);
+		if (index < shapeCount)
+			return Separation(moved, objects.GetPolygonAt(index - circleEnd), normal, point);
+
+		//the deepest point of the swept shape is the one that reaches the surface first
+		const HalfSpace &halfSpace = objects.GetHalfSpaceAt(index - shapeCount);
+		normal = halfSpace.GetNormal();
+
+		Vector2 deepest = moved.position - normal*moved.radius;
+		if (moved.box)
+		{
+			Vector2 vertices[4];
+			GetVertices(moved, vertices);
+
+			for (unsigned i = 1; i < 4; i++)
+			{
+				if (vertices[i] * normal < vertices[0] * normal)
+					vertices[0] = vertices[i];
+			}
+			deepest = vertices[0];
+		}
+
+		const Real height = deepest * normal - halfSpace.GetOffset();
+		point = deepest - normal*height;
+		return height;
+	}
+
+	//distance between two boxes or circles (see SweptDistance), with the direction from two to one
+	static Real Separation(const SweptShape &one, const SweptShape &two, Vector2 &normal, Vector2 &point)
+	{
+		if (!one.box && !two.box)
+		{
+			const Vector2 between = one.position - two.position;
+			const Real length = SafeMagnitude(between);
+			if (length <= 0)
+				return 0;
+
+			normal = Vector2(between.x / length, between.y / length);
+			point = two.position + normal*two.radius;
+			return length - one.radius - two.radius;
+		}
+
+		if (!one.box || !two.box)
+		{
+			//from the point on the box nearest the circle's centre
+			const SweptShape &box = one.box ? one : two;
+			const SweptShape &circle = one.box ? two : one;
+
+			Vector2 nearest;
+			if (!NearestOnBox(box, circle.position, nearest))
+				return 0;
+
+			const Vector2 between = circle.position - nearest;
+			const Real length = SafeMagnitude(between);
+			normal = Vector2(between.x / length, between.y / length);
+
+			if (one.box)
+			{
+				normal.Invert();
+				point = circle.position + normal*circle.radius;
+			}
+			else
+				point = nearest;
+
+			return length - circle.radius;
+		}
+
+		//separated boxes are nearest at a corner of one of them, but overlapping ones needn't have a corner inside the
+		//other, so overlap is found by separating axes first
+		if (BoxesOverlap(one, two))
+			return 0;
+
+		Vector2 oneVertices[4], twoVertices[4];
+		GetVertices(one, oneVertices);
+		GetVertices(two, twoVertices);
+		Real best = REAL_MAX;
+
+		for (unsigned i = 0; i < 4; i++)
+		{
+			Vector2 nearest;
+			NearestOnBox(two, oneVertices[i], nearest);
+			const Real distance = SafeMagnitude(oneVertices[i] - nearest);
+
+			if (distance < best)
+			{
+				best = distance;
+				normal = oneVertices[i] - nearest;
+				point = nearest;
+			}
+
+			NearestOnBox(one, twoVertices[i], nearest);
+			const Real otherDistance = SafeMagnitude(nearest - twoVertices[i]);
+
+			if (otherDistance < best)
+			{
+				best = otherDistance;
+				normal = nearest - twoVertices[i];
+				point = twoVertices[i];
+			}
+		}
+
+		if (best <= 0)
+			return 0;
+
+		normal = Vector2(normal.x / best, normal.y / best);
+		return best;
+	}
+
+	//distance between a box or circle and a polygon (see SweptDistance) by GJK, with the direction from the polygon
+	static Real Separation(const SweptShape &one, const Polygon &two, Vector2 &normal, Vector2 &point)
+	{
+		ConvexProxy oneProxy, twoProxy;
+		MakeProxy(one, one.position, oneProxy);
+		MakeProxy(two, one.position, twoProxy);
+
+		SimplexCache simplex;
+		DistanceOutput output;
+		GJKDistance(oneProxy, twoProxy, simplex, output);
+		if (output.distance <= 0)
+			return 0;
+
+		const Vector2 between = output.pointOne - output.pointTwo;
+		normal = Vector2(between.x / output.distance, between.y / output.distance);
+		point = output.pointTwo + one.position;
+		return output.distance - one.radius;
+	}
+
+	//the point in the box nearest position, false if position is in it (or on its edge)
+	static bool NearestOnBox(const SweptShape &box, const Vector2 &position, Vector2 &nearest)
+	{
+		const Vector2 offset = position - box.position;
+		Vector2 local(offset * box.xAxis, offset * box.yAxis);
+		const bool inside = abs(local.x) <= box.halfSize.x && abs(local.y) <= box.halfSize.y;
+
+		local.x = std::max(-box.halfSize.x, std::min(local.x, box.halfSize.x));
+		local.y = std::max(-box.halfSize.y, std::min(local.y, box.halfSize.y));
+		nearest = box.position + box.xAxis*local.x + box.yAxis*local.y;
+		return !inside;
+	}
+
+	static void GetVertices(const SweptShape &box, Vector2 (&vertices)[4])
+	{
+		const Vector2 x = box.xAxis*box.halfSize.x;
+		const Vector2 y = box.yAxis*box.halfSize.y;
+
+		vertices[0] = box.position - x - y;
+		vertices[1] = box.position + x - y;
+		vertices[2] = box.position + x + y;
+		vertices[3] = box.position - x + y;
+	}
+
+	//separating axis test on both boxes' axes, touching counting as overlapping
+	static bool BoxesOverlap(const SweptShape &one, const SweptShape &two)
+	{
+		const Vector2 between = two.position - one.position;
+		const Vector2 axes[4] = {one.xAxis, one.yAxis, two.xAxis, two.yAxis};
+
+		for (unsigned i = 0; i < 4; i++)
+		{
+			const Real reach = abs(one.xAxis * axes[i])*one.halfSize.x + abs(one.yAxis * axes[i])*one.halfSize.y
+				+ abs(two.xAxis * axes[i])*two.halfSize.x + abs(two.yAxis * axes[i])*two.halfSize.y;
+
+			if (abs(between * axes[i]) > reach)
+				return false;
+		}
+
+		return true;
+	}
+
+	// Convex Methods //
+
+	//each shape as GJK sees it (see ConvexProxy), relative to origin
+	static void MakeProxy(const Box &box, const Vector2 &origin, ConvexProxy &proxy)
+	{
+		Vector2 vertices[4];
+		box.GetVertices(vertices);
+
+		for (unsigned i = 0; i < 4; i++)
+			proxy.vertices[i] = vertices[i] - origin;
+
+		proxy.count = 4;
+		proxy.radius = 0;
+	}
+
+	static void MakeProxy(const Circle &circle, const Vector2 &origin, ConvexProxy &proxy)
+	{
+		proxy.vertices[0] = circle.GetPosition() - origin;
+		proxy.count = 1;
+		proxy.radius = circle.GetRadius();
+	}
+
+	static void MakeProxy(const Polygon &polygon, const Vector2 &origin, ConvexProxy &proxy)
+	{
+		const Vector2 *vertices = polygon.GetVertices();
+
+		for (unsigned i = 0; i < polygon.GetVertexCount(); i++)
+			proxy.vertices[i] = vertices[i] - origin;
+
+		proxy.count = polygon.GetVertexCount();
+		proxy.radius = 0;
+	}
+
+	static void MakeProxy(const SweptShape &shape, const Vector2 &origin, ConvexProxy &proxy)
+	{
+		if (!shape.box)
+		{
+			proxy.vertices[0] = shape.position - origin;
+			proxy.count = 1;
+			proxy.radius = shape.radius;
+			return;
+		}
+
+		Vector2 vertices[4];
+		GetVertices(shape, vertices);
+
+		for (unsigned i = 0; i < 4; i++)
+			proxy.vertices[i] = vertices[i] - origin;
+
+		proxy.count = 4;
+		proxy.radius = 0;
+	}
+
+	//the contact between two convex shapes, made relative to origin, with one's body first. If the cores are apart the
+	//nearest points GJK found give the contact, as long as the radii reach across; if they overlap EPA finds how far
+	unsigned ConvexAndConvex(const ConvexProxy &one, const ConvexProxy &two, const Vector2 &origin, Body *bodyOne, Body *bodyTwo, const PairType type, SimplexCache &simplex, std::vector<Contact> &data)
+	{
+		DistanceOutput distance;
+		GJKDistance(one, two, simplex, distance);
+		CountGJK(distance);
+
+		const Real radii = one.radius + two.radius;
+		if (distance.distance > radii)
+			return 0;
+
+		Vector2 normal, point;
+		Real penetration;
+
+		if (distance.distance > convexTolerance)
+		{
+			const Vector2 between = distance.pointOne - distance.pointTwo;
+			normal = Vector2(between.x / distance.distance, between.y / distance.distance);
+			point = distance.pointTwo + normal*two.radius;
+			penetration = radii - distance.distance;
+		}
+		else
+		{
+			PenetrationOutput overlap;
+			const bool found = EPAPenetration(one, two, simplex, overlap);
+			counters.epaRuns++;
+			counters.epaIterations += overlap.iterations;
+
+			if (!found)
+				return 0;
+
+			normal = overlap.normal;
+			point = overlap.pointTwo + normal*two.radius;
+			penetration = std::max(overlap.depth, Real(0)) + radii;
+		}
+
+		Contact contact;
+		contact.SetContactNormal(normal);
+		contact.SetContactPoint(point + origin);
+		contact.SetPenetration(penetration);
+		contact.SetBodyData(bodyOne, bodyTwo);
+
+		counters.contacts[type]++;
+		data.push_back(contact);
+		return 1;
+	}
+
+	//whether two convex shapes touch, from scratch
+	bool ConvexOverlaps(const ConvexProxy &one, const ConvexProxy &two)
+	{
+		SimplexCache simplex;
+		DistanceOutput distance;
+		GJKDistance(one, two, simplex, distance);
+		CountGJK(distance);
+
+		return distance.distance <= one.radius + two.radius;
+	}
+
+	void CountGJK(const DistanceOutput &distance)
+	{
+		counters.gjkRuns++;
+		counters.gjkIterations += distance.iterations;
+		if (distance.warmStarted)
+			counters.gjkWarmStarts++;
+	}
+
+	// Contact Reuse Methods //
+
+	//a vector in world space in the box's own coordinates
+	static Vector2 ToBoxCoordinates(const Box &box, const Vector2 &vector)
+	{
+		return Vector2(vector * box.GetXAxis(), vector * box.GetYAxis());
+	}
+
+	static Vector2 FromBoxCoordinates(const Box &box, const Vector2 &vector)
+	{
+		return box.GetXAxis()*vector.x + box.GetYAxis()*vector.y;
+	}
+
+	//whether the pair is still within the tolerances of where it was when last tested - not where it was last step, so
+	//a pair creeping a little each step is tested again once it has crept far enough
+	bool CanReuse(const PairCache &cache, const Vector2 &relativePosition, const Real relativeOrientation) const
+	{
+		return cache.tested && abs(relativePosition.x - cache.relativePosition.x) <= reuseDistance
+			&& abs(relativePosition.y - cache.relativePosition.y) <= reuseDistance
+			&& abs(relativeOrientation - cache.relativeOrientation) <= reuseAngle;
+	}
+
+	//last time's contact (if there was one), moved with the box, between the bodies in the same order as then - the normal
+	//points from the second body to the first, so swapping them would push the shapes together
+	unsigned ReuseContact(const Box &box, Body *otherBody, const PairType type, const PairCache &cache, std::vector<Contact> &data)
+	{
+		counters.pairsReused[type]++;
+
+		if (cache.contacts == 0)
+			return 0;
+
+		Contact contact;
+		contact.SetContactPoint(box.GetPosition() + FromBoxCoordinates(box, cache.localPoint));
+		contact.SetContactNormal(FromBoxCoordinates(box, cache.localNormal));
+		contact.SetPenetration(cache.penetration);
+		if (cache.boxSecond)
+			contact.SetBodyData(otherBody, box.GetBody());
+		else
+			contact.SetBodyData(box.GetBody(), otherBody);
+
+		counters.contacts[type]++;
+		data.push_back(contact);
+		return 1;
+	}
+
+	//stores the pair as it is now and the contact just made (the last one in data, if count is 1)
+	static void RememberContact(const Box &box, const unsigned count, const Vector2 &relativePosition, const Real relativeOrientation, const std::vector<Contact> &data, PairCache &cache)
+	{
+		cache.tested = true;
+		cache.contacts = (unsigned char)count;
+		cache.relativePosition = relativePosition;
+		cache.relativeOrientation = relativeOrientation;
+
+		if (count > 0)
+		{
+			const Contact &contact = data.back();
+			cache.localPoint = ToBoxCoordinates(box, contact.GetContactPoint() - box.GetPosition());
+			cache.localNormal = ToBoxCoordinates(box, contact.GetContactNormal());
+			cache.penetration = contact.GetPenetration();
+			cache.boxSecond = contact.GetBody(0) != box.GetBody();
+		}
+	}
+
+	// Draw Contact Point and Normal //
+	void DrawContactNormal(const Contact &contact, VertexList & vertexList ) const 
+	{
+		//draws a contact
+		DrawLine contactNormal(contact.GetContactPoint(), contact.GetContactPoint() + contact.GetContactNormal());
+		contactNormal.AddDrawInfo(vertexList, RED);
+	}
+	
+	unsigned int DrawContactNormal(const unsigned &result, std::vector<Contact> &data, VertexList &vertexList) const
+	{
+		//used exclusively by contact generation functions to draw contact normal. 
+		//uses function's return value to see whether to bother drawing or not.
+		if (result == 0)
+			return 0;
+
+		Contact &contact = data.back();
+		DrawContactNormal(contact, vertexList);
+
+		return result;
+	}
+
+
+	// Box and Box Methods //
+
+	//box1's x and y axes, then box2's
+	static Vector2 GetBoxBoxAxis(const Box &box1, const Box &box2, const unsigned axis)
+	{
+		switch (axis)
+		{
+		case 0: return box1.GetXAxis();
+		case 1: return box1.GetYAxis();
+		case 2: return box2.GetXAxis();
+		default: return box2.GetYAxis();
+		}
+	}
 
 	//checks if two boxes overlap on a given axis. toCentre is the distance
 	//between the centres of the two boxes, passing it in means avoiding 
 	//recalculation every time
-	float PenetrationOnAxis(const Box &one, const Box &two, const Vector2 &axis, const Vector2 &toCentre)
+	Real PenetrationOnAxis(const Box &one, const Box &two, const Vector2 &axis, const Vector2 &toCentre)
 	{
 		//project halfsizes onto axis 
-		float oneProject = TransformToAxis(one, axis);
-		float twoProject = TransformToAxis(two, axis);
+		Real oneProject = TransformToAxis(one, axis);
+		Real twoProject = TransformToAxis(two, axis);
 
 		//projection of centre distances on axis
-		float distance = abs(toCentre*axis);
+		Real distance = abs(toCentre*axis);
 
 		//check for overlap; negative value means separation
 		return oneProject + twoProject - distance;
 	}
 
 	//returns projection of box on axis
-	float TransformToAxis(const Box &box, const Vector2 &axis)
+	Real TransformToAxis(const Box &box, const Vector2 &axis)
 	{
 		return box.GetHalfSize().x * abs(axis*box.GetXAxis()) + box.GetHalfSize().y * abs(axis*box.GetYAxis());
 	}
 
 	//fill the given contact with the correct information, based on the input values
-	void GenerateBoxBoxContact(const Box &box1, const Box &box2, const Vector2 &axis, const Vector2 &toCentre, const float &penetration, Contact &contact)
+	void GenerateBoxBoxContact(const Box &box1, const Box &box2, const Vector2 &axis, const Vector2 &toCentre, const Real &penetration, Contact &contact)
 	{		
 		Vector2 normal = axis;
 		//which side is in contact?
@@ -895,7 +2607,7 @@ private:
 
 		//transform vertex to world
 		Vector2 translation = box2.GetPosition();
-		float rotation = box2.GetOrientation();
+		Real rotation = box2.GetOrientation();
 
 		vertex.RotateAboutWorldOrigin(rotation);
 		vertex+=translation;
@@ -0,0 +1,176 @@
+#include "contactgraph.h"
+
+//pairs in order of a, then b
+static bool PairBefore( const ShapePair &one, const ShapePair &two )
+{
+	return one.a < two.a || (one.a == two.a && one.b < two.b);
+}
+
+// Size //
+void ContactGraph::Reserve( const unsigned nodeTotal, const unsigned contacts )
+{
+	if (nodes.size() < nodeTotal)
+	{
+		const Node empty = {0, 0, 0, 0};
+		nodes.resize(nodeTotal, empty);
+	}
+
+	//each contact is listed under both of its shapes, and a pair can have an event under both too
+	contactIndices.reserve(contacts * 2);
+	events.reserve(contacts * 2);
+
+	pairs.reserve(contacts);
+	lastPairs.reserve(contacts);
+	eventPairs.reserve(contacts);
+	eventTypes.reserve(contacts);
+}
+
+void ContactGraph::Clear()
+{
+	ResetNodes();
+
+	nodeCount = 0;
+	pairs.clear();
+	lastPairs.clear();
+	eventPairs.clear();
+	eventTypes.clear();
+	contactIndices.clear();
+	events.clear();
+
+	for (unsigned i = 0; i < CONTACT_EVENT_TYPE_COUNT; i++)
+		pairCounts[i] = 0;
+}
+
+void ContactGraph::ResetNodes()
+{
+	//every node with contacts has an event too
+	const Node empty = {0, 0, 0, 0};
+
+	for (unsigned i = 0; i < eventPairs.size(); i++)
+	{
+		nodes[eventPairs[i].a] = empty;
+		nodes[eventPairs[i].b] = empty;
+	}
+}
+
+// Updating //
+void ContactGraph::Update( const std::vector<ShapePair> &contactPairs, const unsigned nodeTotal )
+{
+	ResetNodes();
+
+	nodeCount = nodeTotal;
+	if (nodes.size() < nodeTotal)
+	{
+		const Node empty = {0, 0, 0, 0};
+		nodes.resize(nodeTotal, empty);
+	}
+
+	//this step's pairs, once each - a pair's contacts are next to each other
+	pairs.swap(lastPairs);
+	pairs.clear();
+
+	for (unsigned i = 0; i < contactPairs.size(); i++)
+	{
+		if (pairs.empty() || pairs.back().a != contactPairs[i].a || pairs.back().b != contactPairs[i].b)
+			pairs.push_back(contactPairs[i]);
+	}
+
+	//both steps' pairs are in order, so walking them together finds the pairs in only one (began or ended) and in both
+	eventPairs.clear();
+	eventTypes.clear();
+
+	for (unsigned i = 0; i < CONTACT_EVENT_TYPE_COUNT; i++)
+		pairCounts[i] = 0;
+
+	size_t last = 0;
+	size_t now = 0;
+
+	while (last < lastPairs.size() || now < pairs.size())
+	{
+		ContactEventType type;
+
+		if (now == pairs.size() || (last < lastPairs.size() && PairBefore(lastPairs[last], pairs[now])))
+		{
+			eventPairs.push_back(lastPairs[last++]);
+			type = CONTACT_ENDED;
+		}
+		else if (last == lastPairs.size() || PairBefore(pairs[now], lastPairs[last]))
+		{
+			eventPairs.push_back(pairs[now++]);
+			type = CONTACT_BEGAN;
+		}
+		else
+		{
+			eventPairs.push_back(pairs[now++]);
+			last++;
+			type = CONTACT_PERSISTED;
+		}
+
+		eventTypes.push_back((unsigned char)type);
+		pairCounts[type]++;
+	}
+
+	//count each node's contacts and events
+	for (unsigned i = 0; i < contactPairs.size(); i++)
+	{
+		nodes[contactPairs[i].a].contactCount++;
+		nodes[contactPairs[i].b].contactCount++;
+	}
+
+	for (unsigned i = 0; i < eventPairs.size(); i++)
+	{
+		nodes[eventPairs[i].a].eventCount++;
+		nodes[eventPairs[i].b].eventCount++;
+	}
+
+	//give each node its place, in the order they first come up. The counts go back to 0 and count the entries filled in
+	//below, so a node seen again (its event count now 0) already has its place
+	unsigned contactTotal = 0;
+	unsigned eventTotal = 0;
+
+	for (unsigned i = 0; i < eventPairs.size(); i++)
+	{
+		const unsigned ends[2] = {eventPairs[i].a, eventPairs[i].b};
+
+		for (unsigned j = 0; j < 2; j++)
+		{
+			Node &node = nodes[ends[j]];
+			if (node.eventCount == 0)
+				continue;
+
+			node.contactStart = contactTotal;
+			contactTotal += node.contactCount;
+			node.contactCount = 0;
+
+			node.eventStart = eventTotal;
+			eventTotal += node.eventCount;
+			node.eventCount = 0;
+		}
+	}
+
+	//the pairs are in order of a then b, so filling forwards leaves each node's entries in order of the other shape
+	contactIndices.resize(contactTotal);
+
+	for (unsigned i = 0; i < contactPairs.size(); i++)
+	{
+		Node &a = nodes[contactPairs[i].a];
+		Node &b = nodes[contactPairs[i].b];
+		contactIndices[a.contactStart + a.contactCount++] = i;
+		contactIndices[b.contactStart + b.contactCount++] = i;
+	}
+
+	events.resize(eventTotal);
+
+	for (unsigned i = 0; i < eventPairs.size(); i++)
+	{
+		const ContactEventType type = (ContactEventType)eventTypes[i];
+		Node &a = nodes[eventPairs[i].a];
+		Node &b = nodes[eventPairs[i].b];
+
+		const ContactEvent underA = {eventPairs[i].b, type};
+		events[a.eventStart + a.eventCount++] = underA;
+
+		const ContactEvent underB = {eventPairs[i].a, type};
+		events[b.eventStart + b.eventCount++] = underB;
+	}
+}
@@ -0,0 +1,98 @@
+#ifndef CONTACTGRAPHH
+#define CONTACTGRAPHH
+
+// Includes //
+#include <vector>
+
+#include "broadphase.h"
+
+// Contact Events //
+enum ContactEventType{CONTACT_BEGAN, CONTACT_PERSISTED, CONTACT_ENDED, CONTACT_EVENT_TYPE_COUNT};
+
+//one pair's contact event, as seen from one of the two shapes
+struct ContactEvent
+{
+	unsigned other;			//the shape on the other side of the pair
+	ContactEventType type;
+};
+
+// Contact Graph //
+//which shapes are touching which, rebuilt each step from the pair every contact is between. Shapes are nodes,
+//numbered as pairs are (boxes, circles, polygons, then halfspaces). Each node gets the indices of its contacts in the
+//contact list, and an event for every pair it was in last step or is in now: began, persisted or ended. Both are kept
+//densely, grouped by node (a counting sort), so finding a shape's contacts or events costs the number it has, not the
+//number in the world. Only the nodes with events are counted, placed and reset, so an update costs the number of contacts, not
+//the number of shapes - most shapes in a big world touch nothing.
+//
+//Update expects the contacts in pair order (a, then b), as World and CollisionDetector::GenerateContacts give them,
+//which lets last step's pairs be matched to this step's by walking both lists together.
+class ContactGraph
+{
+public:
+	ContactGraph(): nodeCount(0) { Clear(); }
+
+	//room for this many nodes and contacts without growing
+	void Reserve(const unsigned nodeTotal, const unsigned contacts);
+
+	//forgets last step's pairs, so the next update reports every pair as beginning and none as ending - needed
+	//whenever the shapes are renumbered
+	void Clear();
+
+	//contactPairs holds the pair each contact is between, in the contact list's order. nodeTotal is the number of shapes
+	void Update(const std::vector<ShapePair> &contactPairs, const unsigned nodeTotal);
+
+	unsigned GetNodeCount() const { return nodeCount; }
+
+	//indices into the contact list of the node's contacts, in order (a pair can make more than one)
+	unsigned GetContactCount(const unsigned node) const { return node < nodeCount ? nodes[node].contactCount : 0; }
+	const unsigned* GetContacts(const unsigned node) const { return node < nodeCount ? contactIndices.data() + nodes[node].contactStart : NULL; }
+
+	//the node's events from the last update, in order of the other shape
+	unsigned GetEventCount(const unsigned node) const { return node < nodeCount ? nodes[node].eventCount : 0; }
+	const ContactEvent* GetEvents(const unsigned node) const { return node < nodeCount ? events.data() + nodes[node].eventStart : NULL; }
+
+	//number of pairs that had each kind of event in the last update
+	unsigned GetPairCount(const ContactEventType type) const { return pairCounts[type]; }
+
+	//pairs touching now
+	unsigned GetTouchingCount() const { return (unsigned)pairs.size(); }
+
+	//bytes reserved by the index and the events
+	size_t GetMemoryUsed() const
+	{
+		return nodes.capacity()*sizeof(Node) + contactIndices.capacity()*sizeof(unsigned) + events.capacity()*sizeof(ContactEvent) + (pairs.capacity() + lastPairs.capacity() + eventPairs.capacity())*sizeof(ShapePair)
+			+ eventTypes.capacity();
+	}
+
+private:
+	// Node
+	//where a node's contacts and events are. All 0 for nodes without events
+	struct Node
+	{
+		unsigned contactStart;
+		unsigned contactCount;
+		unsigned eventStart;
+		unsigned eventCount;
+	};
+
+	//empties the nodes with events from the last update, leaving every node empty
+	void ResetNodes();
+
+	unsigned nodeCount;
+
+	std::vector<Node> nodes;	//at least nodeCount
+	std::vector<unsigned> contactIndices;
+	std::vector<ContactEvent> events;
+
+	//pairs touching this step and last, in order
+	std::vector<ShapePair> pairs;
+	std::vector<ShapePair> lastPairs;
+
+	//every pair with an event this step, in order, with the event (working space for the sort)
+	std::vector<ShapePair> eventPairs;
+	std::vector<unsigned char> eventTypes;
+
+	unsigned pairCounts[CONTACT_EVENT_TYPE_COUNT];
+};
+
+#endif //CONTACTGRAPHH
@@ -1,9 +1,9 @@
 #include "core.h"
 
 //get pixels for input metres
-float MetresToPixels(const float metres)
+float MetresToPixels(const Real metres)
 {
-	return (metres*pixMRatio);
+	return (ToFloat(metres)*pixMRatio);
 }
 
 //get metres for input pixels (probably never used)
@@ -12,22 +12,24 @@ float PixelsToMetres(const float pixels)
 	return (pixels*mPixRatio);
 }
 
-float DegreesToRadians(const float degrees)
+Real DegreesToRadians(const Real degrees)
 {
 	return (degrees*Pi/180);
 }
 
 
-float RadiansToDegrees( float radians )
+Real RadiansToDegrees( Real radians )
 {
 	return (radians*(180/Pi));
 }
 
 
-//convert float to string
+//convert float to string - same format a stream gives (%g), without building a stream each time. Short numbers fit in
+//the string's own buffer, so most of these don't allocate at all
 std::string ToString (const float number)
 {
-	std::ostringstream buff;
-	buff<<number;
-	return buff.str();
+	//%g gives at most 6 significant figures, a sign, a point and an exponent - well inside this
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%g", number);
+	return buffer;
 }
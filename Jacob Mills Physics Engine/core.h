@@ -2,10 +2,6 @@
 #define COREH
 
 // Defines // 
-#define Device LPDIRECT3DDEVICE9 
-#define Pi D3DX_PI
-#define VertexBuffer LPDIRECT3DVERTEXBUFFER9
-#define InputDevice LPDIRECTINPUTDEVICE8
 #define WHITE 0xffffffff
 #define YELLOW 0xffffff00
 #define RED	0xffff0000
@@ -14,12 +10,6 @@
 #define ORANGE 0xffffa54f
 
 // Includes //
-#ifndef DIRECT3DH
-#define DIRECT3DH
-	#include <d3d9.h>
-	#include <d3dx9.h>
-#endif
-
 #ifndef MATHH
 #define MATHH
 	#include <math.h>
@@ -30,22 +20,50 @@
 	#include <vector>
 #endif
 
-#include <sstream>
+#include <float.h>
+#include <stdio.h>
+#include <string>
+
+// Real //
+//the number type used by all the physics. float by default; defining PHYSICS_FIXED_POINT swaps it for the Q16.16
+//Fixed type, which gives bit-identical results across compilers and platforms (for replays) at the cost of range and speed
+#ifdef PHYSICS_FIXED_POINT
+	#include "fixed.h"
+	typedef Fixed Real;
+	#define REAL_MAX Fixed::FromRaw(INT32_MAX)
+#else
+	typedef float Real;
+	#define REAL_MAX FLT_MAX
+#endif
+
+//get a float from a Real, for drawing and text (Fixed has its own version in fixed.h)
+inline float ToFloat(const float number) { return number; }
+
+//false for infinity and NaN, which bodies can end up with if resolution blows up (a Fixed is always finite)
+inline bool IsFinite(const float number) { return number - number == 0; }
 
 // Constants //
+const float Pi = 3.141592654f; //same value as D3DX_PI, so nothing changes for the Direct3D build
 const int pixMRatio = 20; //ratio of pixels to metres
 const float mPixRatio = 1.0f/pixMRatio; //ratio of metres to pixels 
 
-enum ObjectType{BOX, CIRCLE, HALFSPACE, SHAPE};
+enum ObjectType{BOX, CIRCLE, HALFSPACE, POLYGON, SHAPE};
+
+//most vertices a Polygon can have
+const unsigned maxPolygonVertices = 8;
 
 // Functions //
 // Conversions
-float MetresToPixels(float metres); //get pixels for input metres
+float MetresToPixels(Real metres); //get pixels for input metres
 float PixelsToMetres(float pixels); //get metres for input pixels 
-float DegreesToRadians(float degrees);		//get radians for input degrees
-float RadiansToDegrees(float radians);
+Real DegreesToRadians(Real degrees);		//get radians for input degrees
+Real RadiansToDegrees(Real radians);
 
 // String conversion
 std::string ToString (float number);
 
+#ifdef PHYSICS_FIXED_POINT
+inline std::string ToString (const Fixed number) { return ToString(number.ToFloat()); }
+#endif
+
 #endif //COREH
\ No newline at end of file
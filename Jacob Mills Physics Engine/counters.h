@@ -0,0 +1,133 @@
+#ifndef COUNTERSH
+#define COUNTERSH
+
+// Includes //
+#include <stdint.h>
+#include <string.h>
+
+// Pair Types //
+enum PairType{BOX_BOX, BOX_CIRCLE, BOX_HALFSPACE, CIRCLE_CIRCLE, CIRCLE_HALFSPACE, BOX_POLYGON, CIRCLE_POLYGON, POLYGON_POLYGON,
+	POLYGON_HALFSPACE, PAIR_TYPE_COUNT};
+
+inline const char* GetPairTypeName(const PairType type)
+{
+	static const char *names[PAIR_TYPE_COUNT] = {"BoxAndBox", "BoxAndCircle", "BoxAndHalfSpace", "CircleAndCircle", "CircleAndHalfSpace",
+		"BoxAndPolygon", "CircleAndPolygon", "PolygonAndPolygon", "PolygonAndHalfSpace"};
+	return names[type];
+}
+
+// Step Counters //
+//what the collision detection and resolution did. Each CollisionDetector fills its own (so threads never share one)
+//and World adds them up for each step - just increments, cheap enough to leave on all the time
+struct StepCounters
+{
+	// Contact generation
+	uint64_t pairsTested[PAIR_TYPE_COUNT];	//narrowphase calls
+	uint64_t contacts[PAIR_TYPE_COUNT];		//contacts they generated
+
+	//BoxAndCircle rejections: [0] circle outside the box's extents, [1] closest point on the box further than the radius
+	uint64_t boxCircleRejects[2];
+
+	//BoxAndBox rejections, by the axis found to separate them: box1's x and y, then box2's x and y
+	uint64_t boxBoxRejects[4];
+
+	//BoxAndBox rejections by the axis that separated the pair last step, without trying the others (also counted in
+	//boxBoxRejects)
+	uint64_t boxBoxCachedRejects;
+
+	//pairs given last step's contact (or lack of one) back instead of being tested, as they hadn't moved relative to
+	//each other (not counted in pairsTested, but their contacts are in contacts)
+	uint64_t pairsReused[PAIR_TYPE_COUNT];
+
+	//pairs with a sensor in, tested for overlap only (not counted in pairsTested), and how many overlapped
+	uint64_t sensorPairsTested;
+	uint64_t sensorOverlaps;
+
+	//shapes tested against rays, and how many were hit (closer than the nearest hit so far). Queries come after the
+	//step, so these count the queries made since the last one
+	uint64_t rayTests;
+	uint64_t rayHits;
+
+	//shapes given an exact test by region and point queries after passing on their bounds, and how many overlapped
+	uint64_t regionTests;
+	uint64_t regionOverlaps;
+
+	//shapes tested against swept shapes, and how many were hit first so far
+	uint64_t castTests;
+	uint64_t castHits;
+
+	//GJK runs for polygon pairs, the support points they looked for, and how many started from the pair's simplex from
+	//last step (see SimplexCache) - iterations per run is what the warm start saves
+	uint64_t gjkRuns;
+	uint64_t gjkIterations;
+	uint64_t gjkWarmStarts;
+
+	//EPA runs for polygon pairs whose cores overlap, and the points they added
+	uint64_t epaRuns;
+	uint64_t epaIterations;
+
+	// Resolution
+	uint64_t positionResolutions;	//contacts put through ResolvePosition
+	uint64_t velocityResolutions;	//contacts put through ResolveVelocities
+	uint64_t bodiesMoved;			//bodies pushed apart by ResolvePosition
+	uint64_t impulsesApplied;		//bodies given an impulse by ResolveVelocities
+
+	StepCounters() { Clear(); }
+
+	void Clear() { memset(this, 0, sizeof(StepCounters)); }
+
+	//counter by counter, so a counter added above needs adding here too
+	void Add(const StepCounters &other)
+	{
+		for (unsigned i = 0; i < PAIR_TYPE_COUNT; i++)
+		{
+			pairsTested[i] += other.pairsTested[i];
+			contacts[i] += other.contacts[i];
+			pairsReused[i] += other.pairsReused[i];
+		}
+
+		for (unsigned i = 0; i < 2; i++)
+			boxCircleRejects[i] += other.boxCircleRejects[i];
+
+		for (unsigned i = 0; i < 4; i++)
+			boxBoxRejects[i] += other.boxBoxRejects[i];
+
+		boxBoxCachedRejects += other.boxBoxCachedRejects;
+		sensorPairsTested += other.sensorPairsTested;
+		sensorOverlaps += other.sensorOverlaps;
+		rayTests += other.rayTests;
+		rayHits += other.rayHits;
+		regionTests += other.regionTests;
+		regionOverlaps += other.regionOverlaps;
+		castTests += other.castTests;
+		castHits += other.castHits;
+		gjkRuns += other.gjkRuns;
+		gjkIterations += other.gjkIterations;
+		gjkWarmStarts += other.gjkWarmStarts;
+		epaRuns += other.epaRuns;
+		epaIterations += other.epaIterations;
+
+		positionResolutions += other.positionResolutions;
+		velocityResolutions += other.velocityResolutions;
+		bodiesMoved += other.bodiesMoved;
+		impulsesApplied += other.impulsesApplied;
+	}
+
+	uint64_t TotalPairsTested() const
+	{
+		uint64_t total = 0;
+		for (unsigned i = 0; i < PAIR_TYPE_COUNT; i++)
+			total += pairsTested[i];
+		return total;
+	}
+
+	uint64_t TotalContacts() const
+	{
+		uint64_t total = 0;
+		for (unsigned i = 0; i < PAIR_TYPE_COUNT; i++)
+			total += contacts[i];
+		return total;
+	}
+};
+
+#endif //COUNTERSH
@@ -0,0 +1,190 @@
+#ifndef FIXEDH
+#define FIXEDH
+
+// Includes //
+#include <stdint.h>
+
+// Fixed //
+//Q16.16 fixed point number - 16 bits of whole number, 16 of fraction, range of +-32768 at a resolution of 1/65536.
+//Used in place of float (see Real in core.h) when PHYSICS_FIXED_POINT is defined, so that the same inputs give the
+//same results on any compiler or platform. All the arithmetic is integer; anything that would overflow saturates
+//at the ends of the range instead of wrapping.
+class Fixed
+{
+public:
+	//the underlying value, which is the number multiplied by 65536
+	int32_t raw;
+
+	static const int fractionalBits = 16;
+	static const int32_t one = 1 << fractionalBits;
+
+	Fixed(): raw(0){}
+	Fixed(const int value): raw(Saturate((int64_t)value * one)){}
+	Fixed(const unsigned value): raw(Saturate((int64_t)value * one)){}
+	Fixed(const float value): raw(Saturate((double)value * one)){}
+	Fixed(const double value): raw(Saturate(value * one)){}
+
+	//make a number straight from its underlying value
+	static Fixed FromRaw(const int32_t newRaw)
+	{
+		Fixed number;
+		number.raw = newRaw;
+		return number;
+	}
+
+	//clamps a wide intermediate value into the range that can be stored
+	static int32_t Saturate(const int64_t value)
+	{
+		if (value > INT32_MAX)
+			return INT32_MAX;
+		if (value < INT32_MIN)
+			return INT32_MIN;
+		return (int32_t)value;
+	}
+
+	//rounds a scaled up float or double to the nearest value that can be stored
+	static int32_t Saturate(const double value)
+	{
+		if (value >= 2147483647.0)
+			return INT32_MAX;
+		if (value <= -2147483648.0)
+			return INT32_MIN;
+		return (int32_t)(value + (value < 0 ? -0.5 : 0.5));
+	}
+
+	float ToFloat() const { return raw / (float)one; }
+
+	// Arithmetic
+	friend Fixed operator+(const Fixed a, const Fixed b) { return FromRaw(Saturate((int64_t)a.raw + b.raw)); }
+	friend Fixed operator-(const Fixed a, const Fixed b) { return FromRaw(Saturate((int64_t)a.raw - b.raw)); }
+
+	//product is 32.32, round it back to 16.16
+	friend Fixed operator*(const Fixed a, const Fixed b)
+	{
+		return FromRaw(Saturate(((int64_t)a.raw * b.raw + (one >> 1)) >> fractionalBits));
+	}
+
+	//divide by zero gives the biggest number with the sign of the numerator, like float's infinity
+	friend Fixed operator/(const Fixed a, const Fixed b)
+	{
+		if (b.raw == 0)
+			return FromRaw(a.raw < 0 ? INT32_MIN : INT32_MAX);
+
+		return FromRaw(Saturate((int64_t)a.raw * one / b.raw));
+	}
+
+	Fixed operator-() const { return FromRaw(Saturate(-(int64_t)raw)); }
+
+	void operator+=(const Fixed value) { (*this) = (*this) + value; }
+	void operator-=(const Fixed value) { (*this) = (*this) - value; }
+	void operator*=(const Fixed value) { (*this) = (*this) * value; }
+	void operator/=(const Fixed value) { (*this) = (*this) / value; }
+
+	// Comparison
+	friend bool operator==(const Fixed a, const Fixed b) { return a.raw == b.raw; }
+	friend bool operator!=(const Fixed a, const Fixed b) { return a.raw != b.raw; }
+	friend bool operator<(const Fixed a, const Fixed b) { return a.raw < b.raw; }
+	friend bool operator<=(const Fixed a, const Fixed b) { return a.raw <= b.raw; }
+	friend bool operator>(const Fixed a, const Fixed b) { return a.raw > b.raw; }
+	friend bool operator>=(const Fixed a, const Fixed b) { return a.raw >= b.raw; }
+};
+
+// Functions //
+// Same names as the C library versions, so physics code can call them on Real without caring which it is
+
+inline float ToFloat(const Fixed number) { return number.ToFloat(); }
+
+inline bool IsFinite(const Fixed) { return true; }
+
+inline Fixed abs(const Fixed number) { return number.raw < 0 ? -number : number; }
+
+//square root, bit by bit on the 32.32 value so the result is exact to the last bit of the 16.16 one
+inline Fixed sqrt(const Fixed number)
+{
+	if (number.raw <= 0)
+		return Fixed();
+
+	uint64_t remainder = (uint64_t)number.raw << Fixed::fractionalBits;
+	uint64_t root = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+
+	while (bit > remainder)
+		bit >>= 2;
+
+	while (bit != 0)
+	{
+		if (remainder >= root + bit)
+		{
+			remainder -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return Fixed::FromRaw((int32_t)root);
+}
+
+//sine and cosine of an angle in radians. Angle is reduced to [-Pi/4, Pi/4] around the nearest multiple of Pi/2, then
+//Taylor series are run in 2.30 fixed point, so the only error that reaches the answer is the final rounding to 16.16
+inline void SinCos(const Fixed radians, Fixed &sine, Fixed &cosine)
+{
+	//nearest multiple of Pi/2: radians*(2/Pi) in 32.32, rounded
+	const int64_t twoOverPi = 41722;		//2/Pi in 16.16
+	const int64_t halfPi = 6746518852LL;	//Pi/2 in 32.32
+	int64_t quadrant = ((int64_t)radians.raw * twoOverPi + ((int64_t)1 << 31)) >> 32;
+
+	//reduced angle, in 2.30
+	int64_t r = (int64_t)radians.raw * 65536 - quadrant * halfPi;
+	r >>= 2;
+	int64_t r2 = (r * r) >> 30;
+
+	//sin(r) = r(1 - r^2/6 + r^4/120 - r^6/5040), cos(r) = 1 - r^2/2 + r^4/24 - r^6/720 + r^8/40320
+	int64_t s = -213044;
+	s = 8947849 + ((r2 * s) >> 30);
+	s = -178956971 + ((r2 * s) >> 30);
+	s = 1073741824 + ((r2 * s) >> 30);
+	s = (r * s) >> 30;
+
+	int64_t c = 26631;
+	c = -1491308 + ((r2 * c) >> 30);
+	c = 44739243 + ((r2 * c) >> 30);
+	c = -536870912 + ((r2 * c) >> 30);
+	c = 1073741824 + ((r2 * c) >> 30);
+
+	//odd quadrants swap sine and cosine, then fix signs for the quadrant
+	if (quadrant & 1)
+	{
+		int64_t temp = s;
+		s = c;
+		c = temp;
+	}
+
+	if (quadrant & 2)
+		s = -s;
+	if ((quadrant+1) & 2)
+		c = -c;
+
+	//back to 16.16
+	sine = Fixed::FromRaw((int32_t)((s + (1 << 13)) >> 14));
+	cosine = Fixed::FromRaw((int32_t)((c + (1 << 13)) >> 14));
+}
+
+inline Fixed sin(const Fixed radians)
+{
+	Fixed sine, cosine;
+	SinCos(radians, sine, cosine);
+	return sine;
+}
+
+inline Fixed cos(const Fixed radians)
+{
+	Fixed sine, cosine;
+	SinCos(radians, sine, cosine);
+	return cosine;
+}
+
+#endif //FIXEDH
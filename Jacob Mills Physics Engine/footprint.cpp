@@ -0,0 +1,101 @@
+#include "footprint.h"
+#include "collision.h"
+#include "broadphase.h"
+
+// Member Sizes //
+//the size of a member, without needing an object to take it from
+#define MEMBER_SIZE(type, member) sizeof(static_cast<const type*>(0)->member)
+
+//the bytes of data and pointers in each type, member by member. The members are private, so each class names this as
+//a friend - a member added to one of them needs adding here too, or it shows up as padding
+class MemberSizes
+{
+public:
+	static size_t BodyData()
+	{
+		return MEMBER_SIZE(Body, position) + MEMBER_SIZE(Body, velocity) + MEMBER_SIZE(Body, inverseMass)
+			+ MEMBER_SIZE(Body, inverseMomentOfInertia) + MEMBER_SIZE(Body, orientation) + MEMBER_SIZE(Body, rotation);
+	}
+
+	//every shape starts with the vtable pointer, Shape's Body* and these
+	static size_t ShapeData()
+	{
+		return MEMBER_SIZE(Shape, filter.category) + MEMBER_SIZE(Shape, filter.mask) + MEMBER_SIZE(Shape, filter.group)
+			+ MEMBER_SIZE(Shape, sensor);
+	}
+	static size_t ShapePointers() { return sizeof(void*) + MEMBER_SIZE(Shape, body); }
+
+	static size_t BoxData()
+	{
+		return ShapeData() + MEMBER_SIZE(Box, halfSize) + MEMBER_SIZE(Box, cache.position) + MEMBER_SIZE(Box, cache.orientation)
+			+ MEMBER_SIZE(Box, cache.trig) + MEMBER_SIZE(Box, cache.valid) + MEMBER_SIZE(Box, cache.vertices)
+			+ MEMBER_SIZE(Box, cache.xAxis) + MEMBER_SIZE(Box, cache.yAxis) + MEMBER_SIZE(Box, cache.bounds);
+	}
+
+	static size_t CircleData() { return ShapeData() + MEMBER_SIZE(Circle, radius); }
+	static size_t HalfSpaceData() { return ShapeData() + MEMBER_SIZE(HalfSpace, offset); }
+
+	static size_t PolygonData()
+	{
+		return ShapeData() + MEMBER_SIZE(Polygon, localVertices) + MEMBER_SIZE(Polygon, localNormals)
+			+ MEMBER_SIZE(Polygon, count) + MEMBER_SIZE(Polygon, inertiaPerMass) + MEMBER_SIZE(Polygon, cache.position)
+			+ MEMBER_SIZE(Polygon, cache.orientation) + MEMBER_SIZE(Polygon, cache.trig) + MEMBER_SIZE(Polygon, cache.valid)
+			+ MEMBER_SIZE(Polygon, cache.vertices) + MEMBER_SIZE(Polygon, cache.normals) + MEMBER_SIZE(Polygon, cache.bounds);
+	}
+
+	static size_t ContactData()
+	{
+		return MEMBER_SIZE(Contact, contactPoint) + MEMBER_SIZE(Contact, contactNormal) + MEMBER_SIZE(Contact, penetration);
+	}
+	static size_t ContactPointers() { return MEMBER_SIZE(Contact, body); }
+};
+
+// Type Layouts //
+//padding is whatever is left over once the data and pointers are taken off
+static TypeLayout Layout( const char *name, const size_t size, const size_t data, const size_t pointers )
+{
+	TypeLayout layout = {name, size, data, pointers, size - data - pointers};
+	return layout;
+}
+
+//everything one shape costs a World, added together
+static TypeLayout InWorld( const char *name, const TypeLayout &shape, const TypeLayout &body, const TypeLayout &bounds, const TypeLayout &range )
+{
+	TypeLayout layout;
+	layout.name = name;
+	layout.size = shape.size + body.size + sizeof(Shape*) + bounds.size + range.size;
+	layout.data = shape.data + body.data + bounds.data + range.data;
+	layout.pointers = shape.pointers + sizeof(Shape*);
+	layout.padding = shape.padding + body.padding + bounds.padding + range.padding;
+	return layout;
+}
+
+std::vector<TypeLayout> GetTypeLayouts()
+{
+	const size_t shapePointers = MemberSizes::ShapePointers();
+
+	const TypeLayout body = Layout("Body", sizeof(Body), MemberSizes::BodyData(), 0);
+	const TypeLayout box = Layout("Box", sizeof(Box), MemberSizes::BoxData(), shapePointers);
+	const TypeLayout circle = Layout("Circle", sizeof(Circle), MemberSizes::CircleData(), shapePointers);
+	const TypeLayout polygon = Layout("Polygon", sizeof(Polygon), MemberSizes::PolygonData(), shapePointers);
+	const TypeLayout halfSpace = Layout("HalfSpace", sizeof(HalfSpace), MemberSizes::HalfSpaceData(), shapePointers);
+	const TypeLayout contact = Layout("Contact", sizeof(Contact), MemberSizes::ContactData(), MemberSizes::ContactPointers());
+	const TypeLayout bounds = Layout("AABB", sizeof(AABB), 2*sizeof(Vector2), 0);
+	const TypeLayout pair = Layout("ShapePair", sizeof(ShapePair), 2*sizeof(unsigned), 0);
+	const TypeLayout range = Layout("UniformGrid cell range", UniformGrid::GetBytesPerBox(), 4*sizeof(int), 0);
+
+	std::vector<TypeLayout> layouts;
+	layouts.push_back(body);
+	layouts.push_back(box);
+	layouts.push_back(circle);
+	layouts.push_back(polygon);
+	layouts.push_back(halfSpace);
+	layouts.push_back(contact);
+	layouts.push_back(bounds);
+	layouts.push_back(pair);
+	layouts.push_back(range);
+	layouts.push_back(InWorld("Box in a World", box, body, bounds, range));
+	layouts.push_back(InWorld("Circle in a World", circle, body, bounds, range));
+	layouts.push_back(InWorld("Polygon in a World", polygon, body, bounds, range));
+	return layouts;
+}
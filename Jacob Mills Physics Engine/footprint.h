@@ -0,0 +1,59 @@
+#ifndef FOOTPRINTH
+#define FOOTPRINTH
+
+// Includes //
+#include <stddef.h>
+#include <vector>
+
+// Memory Use //
+//bytes held by one part of the engine - what it holds now, and the most it has held since it was created. Counts the
+//memory reserved (vector capacity, not size), as that is what the process is actually paying for
+struct MemoryUse
+{
+	size_t live;
+	size_t peak;
+
+	MemoryUse(): live(0), peak(0) {}
+
+	void Update(const size_t bytes)
+	{
+		live = bytes;
+		if (bytes > peak)
+			peak = bytes;
+	}
+};
+
+// Memory Footprint //
+//what a world's memory goes on, by subsystem. Doesn't include the allocator's own overhead on each block (typically
+//8-16 bytes), which matters most for the bodies as each one is allocated on its own
+struct MemoryFootprint
+{
+	MemoryUse bodies;		//a Body for every shape
+	MemoryUse shapes;		//the shapes the world owns, plus ObjectList's pointers to every shape
+	MemoryUse contacts;		//the contact list and each chunk's contact buffer
+	MemoryUse broadphase;	//bounding boxes, the grid, pair buffers and scratch space
+	MemoryUse vertices;		//debug drawing - World doesn't draw, so this stays 0 unless the caller fills it in
+
+	size_t TotalLive() const { return bodies.live + shapes.live + contacts.live + broadphase.live + vertices.live; }
+
+	//each subsystem peaked at its own time, so this can be more than the total ever was at once
+	size_t TotalPeak() const { return bodies.peak + shapes.peak + contacts.peak + broadphase.peak + vertices.peak; }
+};
+
+// Type Layouts //
+//where the bytes in one of the engine's types go. data is the values that mean something (positions, masses...),
+//pointers is pointers to other objects and the vtable pointer, and padding is whatever the compiler added for alignment
+struct TypeLayout
+{
+	const char *name;
+	size_t size;
+	size_t data;
+	size_t pointers;
+	size_t padding;
+};
+
+//Body, each shape, Contact, and the broadphase's per-shape types, plus a line for the total cost of each box and circle
+//in a World (its shape, Body, ObjectList pointer, bounding box and grid cell range)
+std::vector<TypeLayout> GetTypeLayouts();
+
+#endif //FOOTPRINTH
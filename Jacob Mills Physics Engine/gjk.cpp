@@ -0,0 +1,471 @@
+#include "gjk.h"
+
+// Simplex //
+//one point of the Minkowski difference (two minus one) and the vertices of each shape it came from
+struct SimplexVertex
+{
+	Vector2 one;
+	Vector2 two;
+	Vector2 point;
+	Real weight;		//share of the point nearest the origin, when it is on the simplex
+	unsigned indexOne;
+	unsigned indexTwo;
+};
+
+//z of the 3D cross product
+static Real Cross( const Vector2 &a, const Vector2 &b )
+{
+	return a.x*b.y - a.y*b.x;
+}
+
+static void SetVertex( SimplexVertex &vertex, const ConvexProxy &one, const ConvexProxy &two, const unsigned indexOne, const unsigned indexTwo )
+{
+	vertex.indexOne = indexOne;
+	vertex.indexTwo = indexTwo;
+	vertex.one = one.vertices[indexOne];
+	vertex.two = two.vertices[indexTwo];
+	vertex.point = vertex.two - vertex.one;
+	vertex.weight = 1;
+}
+
+//the simplex's length or area, to tell whether a cached one still fits the pair
+static Real GetMetric( const SimplexVertex *simplex, const unsigned count )
+{
+	if (count == 2)
+		return (simplex[1].point - simplex[0].point).Magnitude();
+	if (count == 3)
+		return abs(Cross(simplex[1].point - simplex[0].point, simplex[2].point - simplex[0].point));
+
+	return 0;
+}
+
+//finds the part of a line simplex nearest the origin, dropping the vertex that isn't needed if it's an end
+static void SolveLine( SimplexVertex *simplex, unsigned &count )
+{
+	const Vector2 edge = simplex[1].point - simplex[0].point;
+
+	//the origin's distance along the edge from each end, as fractions of its length squared
+	const Real fromSecond = -(simplex[0].point * edge);
+	if (fromSecond <= 0)
+	{
+		simplex[0].weight = 1;
+		count = 1;
+		return;
+	}
+
+	const Real fromFirst = simplex[1].point * edge;
+	if (fromFirst <= 0)
+	{
+		simplex[1].weight = 1;
+		simplex[0] = simplex[1];
+		count = 1;
+		return;
+	}
+
+	simplex[0].weight = fromFirst / (fromFirst + fromSecond);
+	simplex[1].weight = fromSecond / (fromFirst + fromSecond);
+	count = 2;
+}
+
+//as SolveLine for a triangle, which can come down to any of its vertices or edges, or be kept whole if the origin is
+//inside it. The areas are only compared in sign with the triangle's, so nothing is multiplied past squared lengths
+static void SolveTriangle( SimplexVertex *simplex, unsigned &count )
+{
+	const Vector2 first = simplex[0].point;
+	const Vector2 second = simplex[1].point;
+	const Vector2 third = simplex[2].point;
+
+	//the origin's place along each edge, as in SolveLine
+	const Vector2 edge12 = second - first;
+	const Real d12First = second * edge12;
+	const Real d12Second = -(first * edge12);
+
+	const Vector2 edge13 = third - first;
+	const Real d13First = third * edge13;
+	const Real d13Second = -(first * edge13);
+
+	const Vector2 edge23 = third - second;
+	const Real d23First = third * edge23;
+	const Real d23Second = -(second * edge23);
+
+	//the origin's side of each edge, positive if it's the same side as the rest of the triangle
+	const Real area = Cross(edge12, edge13);
+	const Real sign = area > 0 ? Real(1) : (area < 0 ? Real(-1) : Real(0));
+	const Real side23 = Cross(second, third) * sign;
+	const Real side31 = Cross(third, first) * sign;
+	const Real side12 = Cross(first, second) * sign;
+
+	//first vertex
+	if (d12Second <= 0 && d13Second <= 0)
+	{
+		simplex[0].weight = 1;
+		count = 1;
+		return;
+	}
+
+	//first edge
+	if (d12First > 0 && d12Second > 0 && side12 <= 0)
+	{
+		simplex[0].weight = d12First / (d12First + d12Second);
+		simplex[1].weight = d12Second / (d12First + d12Second);
+		count = 2;
+		return;
+	}
+
+	//second edge
+	if (d13First > 0 && d13Second > 0 && side31 <= 0)
+	{
+		simplex[0].weight = d13First / (d13First + d13Second);
+		simplex[2].weight = d13Second / (d13First + d13Second);
+		simplex[1] = simplex[2];
+		count = 2;
+		return;
+	}
+
+	//second vertex
+	if (d12First <= 0 && d23Second <= 0)
+	{
+		simplex[1].weight = 1;
+		simplex[0] = simplex[1];
+		count = 1;
+		return;
+	}
+
+	//third vertex
+	if (d13First <= 0 && d23First <= 0)
+	{
+		simplex[2].weight = 1;
+		simplex[0] = simplex[2];
+		count = 1;
+		return;
+	}
+
+	//third edge
+	if (d23First > 0 && d23Second > 0 && side23 <= 0)
+	{
+		simplex[1].weight = d23First / (d23First + d23Second);
+		simplex[2].weight = d23Second / (d23First + d23Second);
+		simplex[0] = simplex[2];
+		count = 2;
+		return;
+	}
+
+	//inside
+	const Real total = side23 + side31 + side12;
+	if (total > 0)
+	{
+		simplex[0].weight = side23 / total;
+		simplex[1].weight = side31 / total;
+		simplex[2].weight = side12 / total;
+	}
+	count = 3;
+}
+
+//towards the origin from the simplex's nearest point - not normalised, and only a side for a line through it
+static Vector2 GetSearchDirection( const SimplexVertex *simplex, const unsigned count )
+{
+	if (count == 1)
+		return simplex[0].point.GetInvert();
+
+	const Vector2 edge = simplex[1].point - simplex[0].point;
+	if (Cross(edge, simplex[0].point.GetInvert()) > 0)
+		return edge.Perpendicular();
+
+	return edge.Perpendicular().GetInvert();
+}
+
+// GJK //
+void GJKDistance( const ConvexProxy &one, const ConvexProxy &two, SimplexCache &cache, DistanceOutput &output )
+{
+	SimplexVertex simplex[3];
+	unsigned count = cache.count;
+
+	//last time's simplex, unless it doesn't fit the shapes any more
+	for (unsigned i = 0; i < count; i++)
+	{
+		if (cache.indexOne[i] >= one.count || cache.indexTwo[i] >= two.count)
+		{
+			count = 0;
+			break;
+		}
+
+		SetVertex(simplex[i], one, two, cache.indexOne[i], cache.indexTwo[i]);
+	}
+
+	if (count > 1)
+	{
+		const Real metric = GetMetric(simplex, count);
+		if (metric < cache.metric*0.5f || cache.metric*2 < metric || metric <= convexTolerance)
+			count = 0;
+	}
+
+	output.warmStarted = count > 0;
+	if (count == 0)
+	{
+		SetVertex(simplex[0], one, two, 0, 0);
+		count = 1;
+	}
+
+	//each iteration looks for a support point nearer the origin, and stops if it finds one the simplex already has
+	unsigned iteration = 0;
+	while (iteration < maxGJKIterations)
+	{
+		unsigned savedOne[3], savedTwo[3];
+		const unsigned savedCount = count;
+		for (unsigned i = 0; i < savedCount; i++)
+		{
+			savedOne[i] = simplex[i].indexOne;
+			savedTwo[i] = simplex[i].indexTwo;
+		}
+
+		if (count == 2)
+			SolveLine(simplex, count);
+		else if (count == 3)
+			SolveTriangle(simplex, count);
+
+		//the origin is inside, so the cores overlap
+		if (count == 3)
+			break;
+
+		const Vector2 direction = GetSearchDirection(simplex, count);
+
+		//the origin is on the simplex, so the cores touch
+		if (direction.x == 0 && direction.y == 0)
+			break;
+
+		SimplexVertex &vertex = simplex[count];
+		SetVertex(vertex, one, two, one.GetSupport(direction.GetInvert()), two.GetSupport(direction));
+		iteration++;
+
+		bool duplicate = false;
+		for (unsigned i = 0; i < savedCount; i++)
+		{
+			if (vertex.indexOne == savedOne[i] && vertex.indexTwo == savedTwo[i])
+			{
+				duplicate = true;
+				break;
+			}
+		}
+
+		if (duplicate)
+			break;
+
+		count++;
+	}
+
+	// Output
+	if (count == 1)
+	{
+		output.pointOne = simplex[0].one;
+		output.pointTwo = simplex[0].two;
+	}
+	else if (count == 2)
+	{
+		output.pointOne = simplex[0].one*simplex[0].weight + simplex[1].one*simplex[1].weight;
+		output.pointTwo = simplex[0].two*simplex[0].weight + simplex[1].two*simplex[1].weight;
+	}
+	else
+	{
+		output.pointOne = simplex[0].one*simplex[0].weight + simplex[1].one*simplex[1].weight + simplex[2].one*simplex[2].weight;
+		output.pointTwo = output.pointOne;
+	}
+
+	output.distance = count == 3 ? Real(0) : (output.pointTwo - output.pointOne).Magnitude();
+	output.iterations = iteration;
+
+	cache.count = (unsigned char)count;
+	cache.metric = GetMetric(simplex, count);
+	for (unsigned i = 0; i < count; i++)
+	{
+		cache.indexOne[i] = (unsigned char)simplex[i].indexOne;
+		cache.indexTwo[i] = (unsigned char)simplex[i].indexTwo;
+	}
+}
+
+// EPA //
+//adds the support point along direction to the polygon if it isn't already in it
+static bool AddSupport( SimplexVertex *polygon, unsigned &count, const ConvexProxy &one, const ConvexProxy &two, const Vector2 &direction )
+{
+	SimplexVertex vertex;
+	SetVertex(vertex, one, two, one.GetSupport(direction.GetInvert()), two.GetSupport(direction));
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		if (vertex.indexOne == polygon[i].indexOne && vertex.indexTwo == polygon[i].indexTwo)
+			return false;
+	}
+
+	polygon[count++] = vertex;
+	return true;
+}
+
+//drops the vertices that adding the one at added left the polygon bending in at, so it stays convex. The simplex GJK
+//starts from needn't be on the Minkowski difference's surface, so a point added outside one edge can leave the
+//vertex at the end of it inside
+static void RemoveReflex( SimplexVertex *polygon, unsigned &count, unsigned added )
+{
+	bool removed = true;
+	while (removed && count > 3)
+	{
+		removed = false;
+
+		for (unsigned i = 0; i < count; i++)
+		{
+			if (i == added)
+				continue;
+
+			const Vector2 &previous = polygon[(i + count - 1) % count].point;
+			const Vector2 &next = polygon[(i+1) % count].point;
+			if (Cross(polygon[i].point - previous, next - polygon[i].point) > 0)
+				continue;
+
+			for (unsigned j = i; j + 1 < count; j++)
+			{
+				polygon[j] = polygon[j+1];
+			}
+			count--;
+
+			if (i < added)
+				added--;
+
+			removed = true;
+			break;
+		}
+	}
+}
+
+bool EPAPenetration( const ConvexProxy &one, const ConvexProxy &two, const SimplexCache &cache, PenetrationOutput &output )
+{
+	const unsigned maxPoints = 3 + maxEPAIterations;
+	SimplexVertex polygon[maxPoints];
+	unsigned count = 0;
+
+	for (unsigned i = 0; i < cache.count; i++)
+	{
+		SetVertex(polygon[i], one, two, cache.indexOne[i], cache.indexTwo[i]);
+		count++;
+	}
+
+	//GJK stops short of a triangle when the origin is on a vertex or edge of its simplex, so it is made up to one
+	//with points either side
+	if (count == 0)
+	{
+		SetVertex(polygon[0], one, two, 0, 0);
+		count = 1;
+	}
+
+	if (count == 1)
+	{
+		if (!AddSupport(polygon, count, one, two, Vector2(1, 0)))
+			AddSupport(polygon, count, one, two, Vector2(-1, 0));
+	}
+
+	if (count == 2)
+	{
+		const Vector2 side = (polygon[1].point - polygon[0].point).Perpendicular();
+		if (!AddSupport(polygon, count, one, two, side) || Cross(polygon[1].point - polygon[0].point, polygon[2].point - polygon[0].point) == 0)
+		{
+			count = 2;
+			AddSupport(polygon, count, one, two, side.GetInvert());
+		}
+	}
+
+	if (count < 3)
+		return false;
+
+	//anticlockwise, so every edge's outward normal is on the same side of it
+	const Real area = Cross(polygon[1].point - polygon[0].point, polygon[2].point - polygon[0].point);
+	if (area == 0)
+		return false;
+
+	if (area < 0)
+	{
+		const SimplexVertex swap = polygon[1];
+		polygon[1] = polygon[2];
+		polygon[2] = swap;
+	}
+
+	//pushes the polygon's nearest edge out to the Minkowski difference's surface until it can't go any further
+	unsigned nearest = 0;
+	Vector2 normal;
+	Real distance = 0;
+	unsigned iteration = 0;
+
+	for (;;)
+	{
+		distance = REAL_MAX;
+
+		for (unsigned i = 0; i < count; i++)
+		{
+			const Vector2 edge = polygon[(i+1) % count].point - polygon[i].point;
+			const Real length = edge.Magnitude();
+			if (length <= 0)
+				continue;
+
+			const Vector2 outward(edge.y / length, -edge.x / length);
+			const Real edgeDistance = outward * polygon[i].point;
+
+			if (edgeDistance < distance)
+			{
+				distance = edgeDistance;
+				nearest = i;
+				normal = outward;
+			}
+		}
+
+		if (distance == REAL_MAX)
+			return false;
+
+		if (iteration == maxEPAIterations || count == maxPoints)
+			break;
+
+		SimplexVertex support;
+		SetVertex(support, one, two, one.GetSupport(normal.GetInvert()), two.GetSupport(normal));
+		iteration++;
+
+		if (support.point * normal - distance <= convexTolerance)
+			break;
+
+		bool duplicate = false;
+		for (unsigned i = 0; i < count; i++)
+		{
+			if (support.indexOne == polygon[i].indexOne && support.indexTwo == polygon[i].indexTwo)
+			{
+				duplicate = true;
+				break;
+			}
+		}
+
+		if (duplicate)
+			break;
+
+		//in between the nearest edge's ends
+		for (unsigned i = count; i > nearest+1; i--)
+		{
+			polygon[i] = polygon[i-1];
+		}
+		polygon[nearest+1] = support;
+		count++;
+
+		RemoveReflex(polygon, count, nearest+1);
+	}
+
+	//the point on the nearest edge nearest the origin, and the shapes' points that make it up
+	const SimplexVertex &start = polygon[nearest];
+	const SimplexVertex &end = polygon[(nearest+1) % count];
+	const Vector2 edge = end.point - start.point;
+	const Real lengthSquared = edge.SquaredMagnitude();
+
+	Real along = lengthSquared > 0 ? -(start.point * edge) / lengthSquared : Real(0);
+	if (along < 0)
+		along = 0;
+	if (along > 1)
+		along = 1;
+
+	output.normal = normal;
+	output.depth = distance;
+	output.pointOne = start.one + (end.one - start.one)*along;
+	output.pointTwo = start.two + (end.two - start.two)*along;
+	output.iterations = iteration;
+	return true;
+}
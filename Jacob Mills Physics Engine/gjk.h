@@ -0,0 +1,101 @@
+#ifndef GJKH
+#define GJKH
+
+// Includes //
+#include "core.h"
+#include "vector2.h"
+
+// Constants //
+//most support points GJK looks for before settling for the simplex it has
+const unsigned maxGJKIterations = 20;
+
+//most points EPA adds to its polygon before settling for the nearest edge it has
+const unsigned maxEPAIterations = 20;
+
+//how close GJK has to get to the origin to call two cores touching, and how little EPA's nearest edge has to move out
+//by before it stops (metres)
+const Real convexTolerance = 0.0001f;
+
+// Convex Proxy //
+//a convex shape as GJK and EPA see it: its vertices, rounded off by radius (a circle is one vertex with its radius,
+//a box or polygon its corners with none). Vertices are relative to an origin the caller picks near both shapes, so the
+//products stay small enough for fixed point wherever the pair is in the world
+struct ConvexProxy
+{
+	Vector2 vertices[maxPolygonVertices];
+	unsigned count;
+	Real radius;
+
+	ConvexProxy(): count(0), radius(0) {}
+
+	//the vertex furthest along direction
+	unsigned GetSupport(const Vector2 &direction) const
+	{
+		unsigned best = 0;
+		Real bestDistance = vertices[0] * direction;
+
+		for (unsigned i = 1; i < count; i++)
+		{
+			const Real distance = vertices[i] * direction;
+			if (distance > bestDistance)
+			{
+				best = i;
+				bestDistance = distance;
+			}
+		}
+
+		return best;
+	}
+};
+
+// Simplex Cache //
+//the vertices of each shape that made up the simplex GJK finished with, and its size (length or area) then. Handed
+//back the next time the same pair is tested, GJK starts from that simplex instead of from scratch - a pair that has
+//hardly moved is usually done in one iteration, finding nothing nearer than what it started with. A cache whose
+//simplex has changed size a lot since is thrown away, as the pair has moved too far for it to be a good start
+struct SimplexCache
+{
+	unsigned char count;		//0 for nothing cached
+	unsigned char indexOne[3];
+	unsigned char indexTwo[3];
+	Real metric;
+
+	SimplexCache(): count(0), metric(0) {}
+};
+
+// Distance //
+//what GJK found: the nearest points on the two cores (without their radii) and the distance between them, 0 if the
+//cores overlap
+struct DistanceOutput
+{
+	Vector2 pointOne;
+	Vector2 pointTwo;
+	Real distance;
+	unsigned iterations;	//support points looked for
+	bool warmStarted;		//started from the cache's simplex
+
+	DistanceOutput(): distance(0), iterations(0), warmStarted(false) {}
+};
+
+//distance between the cores of one and two by GJK, starting from the cache's simplex and leaving the final one in it
+void GJKDistance(const ConvexProxy &one, const ConvexProxy &two, SimplexCache &cache, DistanceOutput &output);
+
+// Penetration //
+//what EPA found: the shortest way to push the cores apart - moving one along normal by depth - and the deepest points
+//of each, on one's surface and in two's
+struct PenetrationOutput
+{
+	Vector2 normal;
+	Real depth;
+	Vector2 pointOne;
+	Vector2 pointTwo;
+	unsigned iterations;	//points added to the polygon
+
+	PenetrationOutput(): depth(0), iterations(0) {}
+};
+
+//penetration of overlapping cores by EPA, growing a polygon out from the simplex GJK left in the cache (which it
+//leaves alone). Returns false if they only just touch, so there is no depth to find a direction for
+bool EPAPenetration(const ConvexProxy &one, const ConvexProxy &two, const SimplexCache &cache, PenetrationOutput &output);
+
+#endif //GJKH
@@ -0,0 +1,202 @@
+#include "health.h"
+
+#include <algorithm>
+
+// Alarms //
+const char* GetHealthAlarmName( const HealthAlarm alarm )
+{
+	switch (alarm)
+	{
+	case NOT_FINITE_ALARM: return "not_finite";
+	case ENERGY_ALARM: return "energy";
+	case ENERGY_GROWTH_ALARM: return "energy_growth";
+	case SPEED_ALARM: return "speed";
+	case PENETRATION_ALARM: return "penetration";
+	default: return "unknown";
+	}
+}
+
+unsigned CheckHealth( HealthReading &reading, const HealthReading &previous, const HealthThresholds &thresholds )
+{
+	unsigned alarms = 0;
+
+	if (reading.notFinite > 0)
+		alarms |= NOT_FINITE_ALARM;
+
+	if (thresholds.maxEnergy > 0 && reading.TotalEnergy() > thresholds.maxEnergy)
+		alarms |= ENERGY_ALARM;
+
+	if (thresholds.energyGrowth > 0 && previous.TotalEnergy() > 0 && reading.TotalEnergy() > previous.TotalEnergy()*thresholds.energyGrowth)
+		alarms |= ENERGY_GROWTH_ALARM;
+
+	if (thresholds.maxSpeed > 0 && reading.maxSpeed > thresholds.maxSpeed)
+		alarms |= SPEED_ALARM;
+
+	if (thresholds.maxPenetration > 0 && reading.maxPenetration > thresholds.maxPenetration)
+		alarms |= PENETRATION_ALARM;
+
+	reading.alarms = alarms;
+	return alarms;
+}
+
+// Reading //
+void HealthReading::Add( const HealthReading &other )
+{
+	kineticEnergy += other.kineticEnergy;
+	rotationalEnergy += other.rotationalEnergy;
+	momentumX += other.momentumX;
+	momentumY += other.momentumY;
+	maxSpeed = std::max(maxSpeed, other.maxSpeed);
+	maxPenetration = std::max(maxPenetration, other.maxPenetration);
+	notFinite += other.notFinite;
+}
+
+// Bodies //
+static const float radiansPerDegree = Pi / 180;
+
+void MeasureBodies( const ObjectList &objects, const unsigned first, const unsigned last, HealthReading &reading )
+{
+	float maxSpeedSquared = 0;
+	unsigned i = first;
+
+#ifdef TRIG_SSE2
+	//four bodies to a register. Bodies are scattered around the heap, so each four are gathered into arrays first
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	__m128 kinetic = zero;
+	__m128 rotational = zero;
+	__m128 momentumX = zero;
+	__m128 momentumY = zero;
+	__m128 speedSquared = zero;
+
+	for (; i + 4 <= last; i += 4)
+	{
+		float inverseMasses[4], inverseInertias[4], velocitiesX[4], velocitiesY[4], rotations[4], positions[4];
+
+		for (unsigned j = 0; j < 4; j++)
+		{
+			const Shape &shape = objects.GetShapeAt(i + j);
+			const Vector2 velocity = shape.GetVelocity();
+			const Vector2 position = shape.GetPosition();
+
+			inverseMasses[j] = ToFloat(shape.GetInverseMass());
+			inverseInertias[j] = ToFloat(shape.GetInverseMomentOfInertia());
+			velocitiesX[j] = ToFloat(velocity.x);
+			velocitiesY[j] = ToFloat(velocity.y);
+			rotations[j] = ToFloat(shape.GetRotation()) * radiansPerDegree;
+			positions[j] = ToFloat(position.x) + ToFloat(position.y);
+		}
+
+		__m128 velocityX = _mm_loadu_ps(velocitiesX);
+		__m128 velocityY = _mm_loadu_ps(velocitiesY);
+		__m128 rotation = _mm_loadu_ps(rotations);
+
+		//anything infinite or NaN makes the sum so too, and x-x is only 0 for finite x. Lanes that aren't finite are
+		//zeroed so they don't poison the totals
+		__m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(positions), velocityX), _mm_add_ps(velocityY, rotation));
+		__m128 finite = _mm_cmpeq_ps(_mm_sub_ps(sum, sum), zero);
+		const int finiteLanes = _mm_movemask_ps(finite);
+		reading.notFinite += 4 - ((finiteLanes & 1) + ((finiteLanes >> 1) & 1) + ((finiteLanes >> 2) & 1) + ((finiteLanes >> 3) & 1));
+
+		velocityX = _mm_and_ps(finite, velocityX);
+		velocityY = _mm_and_ps(finite, velocityY);
+		rotation = _mm_and_ps(finite, rotation);
+
+		//mass and moment of inertia, 0 for immovable bodies (1/0 is infinite, but masked out)
+		__m128 inverseMass = _mm_loadu_ps(inverseMasses);
+		__m128 inverseInertia = _mm_loadu_ps(inverseInertias);
+		__m128 mass = _mm_and_ps(_mm_cmpgt_ps(inverseMass, zero), _mm_div_ps(one, inverseMass));
+		__m128 inertia = _mm_and_ps(_mm_cmpgt_ps(inverseInertia, zero), _mm_div_ps(one, inverseInertia));
+
+		__m128 velocitySquared = _mm_add_ps(_mm_mul_ps(velocityX, velocityX), _mm_mul_ps(velocityY, velocityY));
+
+		kinetic = _mm_add_ps(kinetic, _mm_mul_ps(_mm_mul_ps(half, mass), velocitySquared));
+		rotational = _mm_add_ps(rotational, _mm_mul_ps(_mm_mul_ps(half, inertia), _mm_mul_ps(rotation, rotation)));
+		momentumX = _mm_add_ps(momentumX, _mm_mul_ps(mass, velocityX));
+		momentumY = _mm_add_ps(momentumY, _mm_mul_ps(mass, velocityY));
+		speedSquared = _mm_max_ps(speedSquared, velocitySquared);
+	}
+
+	//add the lanes together
+	float lanes[4];
+
+	_mm_storeu_ps(lanes, kinetic);
+	reading.kineticEnergy += (double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	_mm_storeu_ps(lanes, rotational);
+	reading.rotationalEnergy += (double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	_mm_storeu_ps(lanes, momentumX);
+	reading.momentumX += (double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	_mm_storeu_ps(lanes, momentumY);
+	reading.momentumY += (double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	_mm_storeu_ps(lanes, speedSquared);
+	maxSpeedSquared = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+
+	//leftover bodies (or all of them without SSE2)
+	for (; i < last; i++)
+	{
+		const Shape &shape = objects.GetShapeAt(i);
+		const Vector2 velocity = shape.GetVelocity();
+		const Vector2 position = shape.GetPosition();
+
+		const float velocityX = ToFloat(velocity.x);
+		const float velocityY = ToFloat(velocity.y);
+		const float rotation = ToFloat(shape.GetRotation()) * radiansPerDegree;
+
+		if (!IsFinite(ToFloat(position.x) + ToFloat(position.y) + velocityX + velocityY + rotation))
+		{
+			reading.notFinite++;
+			continue;
+		}
+
+		const float inverseMass = ToFloat(shape.GetInverseMass());
+		const float inverseInertia = ToFloat(shape.GetInverseMomentOfInertia());
+		const float velocitySquared = velocityX*velocityX + velocityY*velocityY;
+
+		if (inverseMass > 0)
+		{
+			const float mass = 1 / inverseMass;
+			reading.kineticEnergy += 0.5f * mass * velocitySquared;
+			reading.momentumX += mass * velocityX;
+			reading.momentumY += mass * velocityY;
+		}
+
+		if (inverseInertia > 0)
+			reading.rotationalEnergy += 0.5f / inverseInertia * rotation * rotation;
+
+		maxSpeedSquared = std::max(maxSpeedSquared, velocitySquared);
+	}
+
+	reading.maxSpeed = std::max(reading.maxSpeed, sqrt(maxSpeedSquared));
+}
+
+// Contacts //
+void MeasurePenetration( const std::vector<Contact> &contacts, HealthReading &reading )
+{
+	float deepest = reading.maxPenetration;
+	unsigned i = 0;
+
+#ifdef TRIG_SSE2
+	__m128 deepest4 = _mm_set1_ps(deepest);
+
+	for (; i + 4 <= contacts.size(); i += 4)
+	{
+		__m128 penetration = _mm_setr_ps(ToFloat(contacts[i].GetPenetration()), ToFloat(contacts[i+1].GetPenetration()),
+			ToFloat(contacts[i+2].GetPenetration()), ToFloat(contacts[i+3].GetPenetration()));
+		deepest4 = _mm_max_ps(deepest4, penetration);
+	}
+
+	float lanes[4];
+	_mm_storeu_ps(lanes, deepest4);
+	deepest = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+
+	for (; i < contacts.size(); i++)
+	{
+		deepest = std::max(deepest, ToFloat(contacts[i].GetPenetration()));
+	}
+
+	reading.maxPenetration = deepest;
+}
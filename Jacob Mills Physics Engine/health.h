@@ -0,0 +1,68 @@
+#ifndef HEALTHH
+#define HEALTHH
+
+// Includes //
+#include "core.h"
+#include "collision.h"
+
+// Health Alarms //
+//raised when a reading goes past its threshold - scenes that are blowing up (the energy gains in
+//ResolveVelocitiesAndRotations, bodies flying off, shapes sinking into each other) get flagged before they eat a server
+enum HealthAlarm
+{
+	NOT_FINITE_ALARM = 1,		//a body's state has gone to infinity or NaN (always checked)
+	ENERGY_ALARM = 2,			//total energy over maxEnergy
+	ENERGY_GROWTH_ALARM = 4,	//total energy grew by more than energyGrowth times in one step
+	SPEED_ALARM = 8,			//a body moving faster than maxSpeed
+	PENETRATION_ALARM = 16,		//a contact deeper than maxPenetration
+	HEALTH_ALARM_COUNT = 5
+};
+
+//name of a single alarm flag
+const char* GetHealthAlarmName(const HealthAlarm alarm);
+
+// Health Thresholds //
+//0 turns a check off
+struct HealthThresholds
+{
+	double maxEnergy;		//joules
+	double energyGrowth;	//ratio of one step's energy to the last's
+	float maxSpeed;			//m/s
+	float maxPenetration;	//metres
+
+	HealthThresholds(): maxEnergy(0), energyGrowth(0), maxSpeed(1000.0f), maxPenetration(2.0f) {}
+};
+
+// Health Reading //
+//totals over every box and circle (halfspaces never move, so are left out), and over every contact
+struct HealthReading
+{
+	double kineticEnergy;		//1/2 mv^2 for every movable body
+	double rotationalEnergy;	//1/2 Iw^2 for every movable body, with w in radians/s
+	double momentumX;
+	double momentumY;
+	float maxSpeed;
+	float maxPenetration;
+	unsigned notFinite;			//bodies with an infinite or NaN position, velocity or rotation
+	unsigned alarms;			//HealthAlarm flags
+
+	HealthReading(): kineticEnergy(0), rotationalEnergy(0), momentumX(0), momentumY(0), maxSpeed(0), maxPenetration(0), notFinite(0), alarms(0) {}
+
+	double TotalEnergy() const { return kineticEnergy + rotationalEnergy; }
+
+	//adds another part of the world's reading onto this one (alarms aren't touched)
+	void Add(const HealthReading &other);
+};
+
+// Measuring //
+//adds the shapes from first to last (numbered boxes, circles then polygons, as World does) into the reading. Works on
+//four bodies at a time with SSE2
+void MeasureBodies(const ObjectList &objects, const unsigned first, const unsigned last, HealthReading &reading);
+
+//finds the deepest of the contacts
+void MeasurePenetration(const std::vector<Contact> &contacts, HealthReading &reading);
+
+//sets the reading's alarms for the thresholds it is past, returning them. previous is the last step's reading
+unsigned CheckHealth(HealthReading &reading, const HealthReading &previous, const HealthThresholds &thresholds);
+
+#endif //HEALTHH
@@ -32,7 +32,10 @@
 
 /*#include "core.h"*/
 #include "collision.h"
+#include "contactgraph.h"
 #include "vertex.h"
+#include "trace.h"
+#include "footprint.h"
 #include "main.h"
 
 //TODO: replace vectors with Lists if don't have to use [i] for efficiency
@@ -82,12 +85,21 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR cmdLine
 
 	//vector holds vertex information for every shape in world, for drawing
 	VertexList vertexList;	
+	MemoryUse vertexMemory;
 	
 	//contact generation
 	CollisionDetector collisionDetector;
 	std::vector<Contact> collisionList;
 	ObjectList collidableObjects;
 
+	//each shape's contacts, so the user shape's can be found without going through them all
+	std::vector<ShapePair> collisionPairs;
+	ContactGraph contactGraph;
+
+	//room for a few contacts per shape, so the list doesn't regrow as more of them touch
+	collisionList.reserve(64);
+	collisionPairs.reserve(64);
+
 
 	//get gridlines
 	std::vector<DrawLine> gridlines;
@@ -151,8 +163,14 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR cmdLine
 
 	bool showVelocitiesAndRotations = true;
 	
+#ifdef PHYSICS_TRACING
+	SetTracing(true);
+#endif
+
 	while (running)
 	{
+		TRACE_SCOPE("Frame");
+
 		// System //
 		//ask OS if there are any messages for window; when read, remove it
 		if(PeekMessage(&message, window, 0, 0, PM_REMOVE))
@@ -214,6 +232,9 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR cmdLine
 					userShapeIsBox = true;
 				}
 				
+				//the shapes have been renumbered
+				contactGraph.Clear();
+
 				//reset the clock
 				userShapeToggleStart = std::clock();
 			}
@@ -234,7 +255,9 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR cmdLine
 		}
 
 		// Collision Detection //
-		unsigned numOfCollisions = collisionDetector.GenerateContacts(collidableObjects, collisionList);
+		collisionDetector.ResetCounters();
+		unsigned numOfCollisions = collisionDetector.GenerateContacts(collidableObjects, collisionList, collisionPairs);
+		contactGraph.Update(collisionPairs, collidableObjects.Size());
 
 		// Text display
 		// mode 1 is display information about the userShape's current or most recent collision
@@ -242,31 +265,25 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR cmdLine
 		{	
 			screenText += "Number of collisions: ";
 			screenText += ToString((float)numOfCollisions);
-			screenText += "\n";
+			screenText += "\nPairs tested: ";
+			screenText += ToString((float)collisionDetector.GetCounters().TotalPairsTested());
+			screenText += "\nVertex list memory: ";
+			screenText += ToString((float)vertexMemory.live);
+			screenText += " bytes (peak ";
+			screenText += ToString((float)vertexMemory.peak);
+			screenText += ")\n";
 
 
 			std::string contactInfo ;
 
-			//find the usershape in the list of collisions, and get its contact info text
-			if (userShapeIsBox)
+			//get the usershape's contact info text - the user shape is always the last box or circle added, so it is the
+			//last box or circle in the graph's numbering
+			const unsigned userShape = userShapeIsBox ? collidableObjects.BoxesSize() - 1 : collidableObjects.BoxesSize() + collidableObjects.CirclesSize() - 1;
+			const unsigned *userContacts = contactGraph.GetContacts(userShape);
+
+			for (unsigned i = 0; i < contactGraph.GetContactCount(userShape); i++)
 			{
-				for (unsigned i = 0; i < collisionList.size(); i++)
-				{
-					if (userBox.BodySameAs(collisionList[i].GetBody(0)) || userBox.BodySameAs(collisionList[i].GetBody(1)))
-					{
-						contactInfo += collisionList[i].GetContactInfoText();
-					}
-				}
-			}
-			else
-			{
-				for (unsigned i = 0; i < collisionList.size(); i++)
-				{
-					if (userCircle.BodySameAs(collisionList[i].GetBody(0)) || userCircle.BodySameAs(collisionList[i].GetBody(1)))
-					{
-						contactInfo += collisionList[i].GetContactInfoText();
-					}
-				}
+				contactInfo += collisionList[userContacts[i]].GetContactInfoText();
 			}
 
 			//if contactInfo isn't empty, some data was recorded, so use it
@@ -510,16 +527,25 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR cmdLine
 		// Draw All //
 		//Fills Direct3D vertex buffer, and draws vertices
 		Draw(window, device, vertexList, font, screenText);
+		vertexMemory.Update(vertexList.GetMemoryUsed());
 
 		//  Housekeeping  //
 		//clear data in vertexBuffer, screenText and collisions so that they don't get added to every loop
-		vertexList.clear();
+		//(clearing keeps their memory, so after the first few frames nothing here allocates)
+		vertexList.Clear();
 		screenText.clear();
 		collisionList.clear();
+		collisionPairs.clear();
 	}
 
 	// End application //
 
+#ifdef PHYSICS_TRACING
+	//open in chrome://tracing or ui.perfetto.dev
+	SetTracing(false);
+	WriteTrace("trace.json");
+#endif
+
 	//release the keyboard
 	keyboard->Unacquire();
 	keyboard->Release();
@@ -757,39 +783,15 @@ Device InitialiseDevice(HWND windowToBindTo)
 }
 
 //edit this so that a shape can add to vertex buffer each frame with its updated position
-void Draw( HWND window, LPDIRECT3DDEVICE9 device, VertexList &vertexList, LPD3DXFONT font, std::string text )
+void Draw( HWND window, LPDIRECT3DDEVICE9 device, const VertexList &vertexList, LPD3DXFONT font, const std::string &text )
 {
-	// Populate the vertex buffer //
-
-	//number of shapes is the number of lists of vertices
-	const int noOfShapes = vertexList.size();
-
-	std::vector<UINT> starts;
-	std::vector<UINT> counts;
+	TRACE_SCOPE("Draw");
 
-	//number of vertices is the total number of all vertices in all shapes
-	int noOfVertices = 0;
-	UINT prevCount = 0;
-	for (int i = 0; i<noOfShapes; i++)
-	{
-		//find the number of vertices in the shape, then calculate the start and count values for drawing
-		UINT vertsInShape = vertexList[i].size();
-		starts.push_back(i+prevCount);
-		counts.push_back(vertsInShape -1);
-		//add the number of vertices in this shape to the count, and also the total number of vertices
-		prevCount += vertsInShape -1 ;
-		noOfVertices += vertsInShape;
-	}
+	// Populate the vertex buffer //
 
-	//create a vector of all the vertices
-	std::vector<Vertex> vertices;
-	for (int i=0;i<noOfShapes; i++)
-	{
-		for (unsigned int j =0; j<vertexList[i].size(); j++)
-		{
-			vertices.push_back(vertexList[i][j]);
-		}
-	}
+	//the vertex list already holds every shape's vertices one after the other, so it is copied straight in
+	const int noOfShapes = vertexList.StripCount();
+	const int noOfVertices = vertexList.VertexCount();
 
 	//create vertex buffer for data
 	VertexBuffer vertexBuffer;
@@ -817,7 +819,7 @@ void Draw( HWND window, LPDIRECT3DDEVICE9 device, VertexList &vertexList, LPD3DX
 	else
 	{
 		//if memory allocation successful, copy data to locked memory
-		memcpy(verticesPtr, &vertices[0], /*size*/noOfVertices*sizeof(Vertex));
+		memcpy(verticesPtr, vertexList.GetVertices(), /*size*/noOfVertices*sizeof(Vertex));
 		
 		//unlock vertex buffer for other applications
 		vertexBuffer->Unlock();
@@ -839,8 +841,8 @@ void Draw( HWND window, LPDIRECT3DDEVICE9 device, VertexList &vertexList, LPD3DX
 	//for each shape
 	for(int i= 0; i<noOfShapes; i++)
 	{		
-		//draw the data in vertex buffer
-		device->DrawPrimitive(D3DPT_LINESTRIP, starts[i], counts[i]);		
+		//draw the data in vertex buffer - a strip of n vertices is n-1 lines
+		device->DrawPrimitive(D3DPT_LINESTRIP, vertexList.StripStart(i), vertexList.StripSize(i)-1);		
 	}
 
 	//display the text
@@ -1,3 +1,8 @@
+// Defines //
+#define Device LPDIRECT3DDEVICE9 
+#define VertexBuffer LPDIRECT3DVERTEXBUFFER9
+#define InputDevice LPDIRECTINPUTDEVICE8
+
 // Constants //
 // Specifying window height and width
 const int screenHeight = 800;
@@ -18,7 +23,7 @@ InputDevice InitialiseKeyboard(HWND window);
 void ReadKeyboard(InputDevice keyboard, Vector2 &translation, float &rotation, bool &running, bool &resolvePenetrationsL, bool &resolvePenetrationsNL, bool &resolveVelocities, bool &resolveVelocitiesAndRotations, unsigned &displayedText, bool &userShape, bool &helpText, bool &showVelocitiesAndRotations );
 
 // Drawing
-void Draw( HWND window, LPDIRECT3DDEVICE9 device, VertexList &vertexList, LPD3DXFONT font, std::string text );
+void Draw( HWND window, LPDIRECT3DDEVICE9 device, const VertexList &vertexList, LPD3DXFONT font, const std::string &text );
 void DrawGrid( std::vector<DrawLine> &gridlines, VertexList &vertexList );
 void InitialiseGridlines(std::vector<DrawLine> &gridlines);
 
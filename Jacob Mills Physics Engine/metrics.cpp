@@ -0,0 +1,283 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _WIN32
+	#define NOMINMAX
+	#include <windows.h>
+#endif
+
+const Real MetricsExporter::restingSpeed = 0.01f;
+
+// Construction //
+MetricsExporter::MetricsExporter( const std::string &newFilename, const double newInterval, const std::string &newLabels ):
+	filename(newFilename), interval(newInterval), labels(newLabels), totalSteps(0), totalStepTime(0), hasPending(false), quit(false), lastWriteSucceeded(true)
+{
+	//both buffers are made full size now so swapping them never allocates on the simulation thread
+	current.stepTimes.reserve(stepSampleLimit);
+	pending.stepTimes.reserve(stepSampleLimit);
+
+	current.steps = 0;
+	current.maxStepTime = 0;
+	current.totalStepTime = 0;
+	current.bodies = current.staticBodies = current.restingBodies = current.contacts = current.pairs = 0;
+	current.measuringHealth = false;
+
+	for (unsigned alarm = 0; alarm < HEALTH_ALARM_COUNT; alarm++)
+		alarmSteps[alarm] = 0;
+
+	intervalStart = Clock::now();
+	writer = std::thread(&MetricsExporter::WriterLoop, this);
+}
+
+MetricsExporter::~MetricsExporter()
+{
+	if (current.steps > 0)
+		Publish();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	snapshotReady.notify_one();
+
+	writer.join();
+}
+
+// Recording //
+void MetricsExporter::Record( World &world )
+{
+	const StepTimes &times = world.GetStepTimes();
+
+	current.steps++;
+	totalSteps++;
+	totalStepTime += times.total;
+
+	if (current.stepTimes.size() < stepSampleLimit)
+		current.stepTimes.push_back(times.total);
+	current.maxStepTime = std::max(current.maxStepTime, times.total);
+
+	current.phaseTotals.integrate += times.integrate;
+	current.phaseTotals.broadphase += times.broadphase;
+	current.phaseTotals.narrowphase += times.narrowphase;
+	current.phaseTotals.resolution += times.resolution;
+	current.phaseTotals.total += times.total;
+
+	const unsigned alarms = world.GetHealth().alarms;
+	for (unsigned alarm = 0; alarm < HEALTH_ALARM_COUNT; alarm++)
+	{
+		if (alarms & (1 << alarm))
+			alarmSteps[alarm]++;
+	}
+
+	if (std::chrono::duration<double>(Clock::now() - intervalStart).count() >= interval)
+	{
+		SampleWorld(world);
+		Publish();
+	}
+}
+
+void MetricsExporter::Flush( World &world )
+{
+	SampleWorld(world);
+	Publish();
+}
+
+void MetricsExporter::SampleWorld( World &world )
+{
+	ObjectList &objects = world.GetObjects();
+	const unsigned shapeCount = objects.FiniteSize();
+
+	current.bodies = shapeCount;
+	current.staticBodies = 0;
+	current.restingBodies = 0;
+
+	for (unsigned i = 0; i < shapeCount; i++)
+	{
+		const Shape &shape = objects.GetShapeAt(i);
+
+		if (shape.GetInverseMass() <= 0)
+			current.staticBodies++;
+		else if (abs(shape.GetVelocity().x) < restingSpeed && abs(shape.GetVelocity().y) < restingSpeed && abs(shape.GetRotation()) < restingSpeed)
+			current.restingBodies++;
+	}
+
+	current.contacts = world.GetContacts().size();
+	current.pairs = world.GetPairCount();
+
+	current.measuringHealth = world.GetSettings().measureHealth;
+	current.health = world.GetHealth();
+}
+
+void MetricsExporter::Publish()
+{
+	const Clock::time_point now = Clock::now();
+	current.seconds = std::chrono::duration<double>(now - intervalStart).count();
+	current.totalSteps = totalSteps;
+	current.totalStepTime = totalStepTime;
+	for (unsigned alarm = 0; alarm < HEALTH_ALARM_COUNT; alarm++)
+		current.alarmSteps[alarm] = alarmSteps[alarm];
+	intervalStart = now;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		//if the writer hasn't got to the last one yet it is dropped - the totals still carry on. Swapping moves the
+		//buffers rather than copying them, so the one coming back is reused
+		std::swap(current, pending);
+		hasPending = true;
+
+		//gauges carry over, everything else starts again
+		current.bodies = pending.bodies;
+		current.staticBodies = pending.staticBodies;
+		current.restingBodies = pending.restingBodies;
+		current.contacts = pending.contacts;
+		current.pairs = pending.pairs;
+		current.measuringHealth = pending.measuringHealth;
+		current.health = pending.health;
+	}
+	snapshotReady.notify_one();
+
+	current.steps = 0;
+	current.stepTimes.clear();
+	current.maxStepTime = 0;
+	current.phaseTotals = StepTimes();
+}
+
+// Writing //
+void MetricsExporter::WriterLoop()
+{
+	MetricsSnapshot snapshot;
+	snapshot.stepTimes.reserve(stepSampleLimit);
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	for (;;)
+	{
+		while (!hasPending && !quit)
+		{
+			snapshotReady.wait(lock);
+		}
+
+		if (hasPending)
+		{
+			std::swap(snapshot, pending);
+			hasPending = false;
+
+			lock.unlock();
+			const bool written = Write(snapshot);
+			lock.lock();
+
+			lastWriteSucceeded.store(written, std::memory_order_relaxed);
+			continue;
+		}
+
+		return;
+	}
+}
+
+//nearest rank percentile of sorted times
+static double Percentile( const std::vector<double> &sorted, const double fraction )
+{
+	if (sorted.empty())
+		return 0;
+
+	size_t rank = (size_t)ceil(fraction * sorted.size());
+	return sorted[rank > 0 ? rank-1 : 0];
+}
+
+bool MetricsExporter::Write( MetricsSnapshot &snapshot )
+{
+	std::sort(snapshot.stepTimes.begin(), snapshot.stepTimes.end());
+
+	const std::string temporary = filename + ".tmp";
+	FILE *file = fopen(temporary.c_str(), "w");
+	if (!file)
+		return false;
+
+	//{labels} on their own, or labels added after other ones
+	const std::string only = labels.empty() ? "" : "{" + labels + "}";
+	const std::string extra = labels.empty() ? "" : "," + labels;
+	const char *l = only.c_str();
+	const char *e = extra.c_str();
+
+	const double steps = snapshot.steps > 0 ? (double)snapshot.steps : 1;
+
+	fprintf(file, "# HELP physics_steps_total Steps taken since the exporter started.\n# TYPE physics_steps_total counter\n");
+	fprintf(file, "physics_steps_total%s %llu\n", l, (unsigned long long)snapshot.totalSteps);
+
+	fprintf(file, "# HELP physics_step_rate Steps per second over the last interval.\n# TYPE physics_step_rate gauge\n");
+	fprintf(file, "physics_step_rate%s %g\n", l, snapshot.seconds > 0 ? snapshot.steps / snapshot.seconds : 0.0);
+
+	//the quantiles are over the last interval, the sum and count over every step since the exporter started
+	fprintf(file, "# HELP physics_step_seconds Step times.\n# TYPE physics_step_seconds summary\n");
+	fprintf(file, "physics_step_seconds{quantile=\"0.5\"%s} %g\n", e, Percentile(snapshot.stepTimes, 0.5) / 1000);
+	fprintf(file, "physics_step_seconds{quantile=\"0.99\"%s} %g\n", e, Percentile(snapshot.stepTimes, 0.99) / 1000);
+	fprintf(file, "physics_step_seconds_sum%s %g\n", l, snapshot.totalStepTime / 1000);
+	fprintf(file, "physics_step_seconds_count%s %llu\n", l, (unsigned long long)snapshot.totalSteps);
+
+	fprintf(file, "# HELP physics_step_seconds_max Longest step over the last interval.\n# TYPE physics_step_seconds_max gauge\n");
+	fprintf(file, "physics_step_seconds_max%s %g\n", l, snapshot.maxStepTime / 1000);
+
+	fprintf(file, "# HELP physics_phase_seconds Average time of each phase of a step over the last interval.\n# TYPE physics_phase_seconds gauge\n");
+	fprintf(file, "physics_phase_seconds{phase=\"integrate\"%s} %g\n", e, snapshot.phaseTotals.integrate / steps / 1000);
+	fprintf(file, "physics_phase_seconds{phase=\"broadphase\"%s} %g\n", e, snapshot.phaseTotals.broadphase / steps / 1000);
+	fprintf(file, "physics_phase_seconds{phase=\"narrowphase\"%s} %g\n", e, snapshot.phaseTotals.narrowphase / steps / 1000);
+	fprintf(file, "physics_phase_seconds{phase=\"resolution\"%s} %g\n", e, snapshot.phaseTotals.resolution / steps / 1000);
+
+	fprintf(file, "# HELP physics_bodies Bodies in the world.\n# TYPE physics_bodies gauge\n");
+	fprintf(file, "physics_bodies%s %u\n", l, snapshot.bodies);
+
+	fprintf(file, "# HELP physics_bodies_static Bodies with infinite mass.\n# TYPE physics_bodies_static gauge\n");
+	fprintf(file, "physics_bodies_static%s %u\n", l, snapshot.staticBodies);
+
+	fprintf(file, "# HELP physics_bodies_resting Movable bodies that have all but stopped.\n# TYPE physics_bodies_resting gauge\n");
+	fprintf(file, "physics_bodies_resting%s %u\n", l, snapshot.restingBodies);
+
+	fprintf(file, "# HELP physics_contacts Contacts generated by the last step.\n# TYPE physics_contacts gauge\n");
+	fprintf(file, "physics_contacts%s %u\n", l, snapshot.contacts);
+
+	fprintf(file, "# HELP physics_pairs Pairs given to the narrowphase by the last step.\n# TYPE physics_pairs gauge\n");
+	fprintf(file, "physics_pairs%s %llu\n", l, (unsigned long long)snapshot.pairs);
+
+	if (snapshot.measuringHealth)
+	{
+		const HealthReading &health = snapshot.health;
+
+		fprintf(file, "# HELP physics_energy_joules Kinetic and rotational energy of every movable body.\n# TYPE physics_energy_joules gauge\n");
+		fprintf(file, "physics_energy_joules{kind=\"kinetic\"%s} %g\n", e, health.kineticEnergy);
+		fprintf(file, "physics_energy_joules{kind=\"rotational\"%s} %g\n", e, health.rotationalEnergy);
+
+		fprintf(file, "# HELP physics_momentum Total linear momentum, in kg m/s.\n# TYPE physics_momentum gauge\n");
+		fprintf(file, "physics_momentum{axis=\"x\"%s} %g\n", e, health.momentumX);
+		fprintf(file, "physics_momentum{axis=\"y\"%s} %g\n", e, health.momentumY);
+
+		fprintf(file, "# HELP physics_max_speed Fastest body, in m/s.\n# TYPE physics_max_speed gauge\n");
+		fprintf(file, "physics_max_speed%s %g\n", l, health.maxSpeed);
+
+		fprintf(file, "# HELP physics_max_penetration Deepest contact, in metres.\n# TYPE physics_max_penetration gauge\n");
+		fprintf(file, "physics_max_penetration%s %g\n", l, health.maxPenetration);
+
+		fprintf(file, "# HELP physics_bodies_not_finite Bodies whose state has gone infinite or NaN.\n# TYPE physics_bodies_not_finite gauge\n");
+		fprintf(file, "physics_bodies_not_finite%s %u\n", l, health.notFinite);
+
+		fprintf(file, "# HELP physics_health_alarms_total Steps that raised each health alarm.\n# TYPE physics_health_alarms_total counter\n");
+		for (unsigned alarm = 0; alarm < HEALTH_ALARM_COUNT; alarm++)
+		{
+			fprintf(file, "physics_health_alarms_total{alarm=\"%s\"%s} %llu\n", GetHealthAlarmName((HealthAlarm)(1 << alarm)), e,
+				(unsigned long long)snapshot.alarmSteps[alarm]);
+		}
+	}
+
+	const bool written = ferror(file) == 0;
+	if (fclose(file) != 0 || !written)
+		return false;
+
+	//rename replaces the old file in one go, so a reader only ever sees a whole one
+#ifdef _WIN32
+	return MoveFileExA(temporary.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename(temporary.c_str(), filename.c_str()) == 0;
+#endif
+}
@@ -0,0 +1,117 @@
+#ifndef METRICSH
+#define METRICSH
+
+// Includes //
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "world.h"
+
+// Metrics Snapshot //
+//everything written out for one interval
+struct MetricsSnapshot
+{
+	uint64_t steps;			//steps in the interval
+	uint64_t totalSteps;	//steps since the exporter was made
+	double seconds;			//length of the interval
+
+	//the interval's step times, in ms. Only the first stepSampleLimit steps are kept for the percentiles
+	std::vector<double> stepTimes;
+	double maxStepTime;
+	double totalStepTime;	//every step since the exporter was made added up, in ms
+
+	StepTimes phaseTotals;	//each phase added up over the interval, in ms
+
+	// Gauges
+	//sampled from the world at the end of the interval
+	unsigned bodies;
+	unsigned staticBodies;		//infinite mass, so never move
+	unsigned restingBodies;		//movable, but slower than restingSpeed
+	unsigned contacts;
+	uint64_t pairs;
+
+	// Health
+	//only written if the world is measuring it
+	bool measuringHealth;
+	HealthReading health;							//sampled with the gauges
+	uint64_t alarmSteps[HEALTH_ALARM_COUNT];		//steps since the exporter was made that raised each alarm
+};
+
+// Metrics Exporter //
+//writes how a World is running to a Prometheus text file (for node exporter's textfile collector) every interval:
+//step rate, a summary of step times, per-phase times, body, contact and pair counts, and the world's health readings
+//and alarms if it measures them (WorldSettings::measureHealth). Record goes after each step and
+//only stores the step's times, apart from looking over the bodies once an interval; the file is formatted and written
+//on the exporter's own thread, to a temporary file that is then renamed over the real one so readers never see half
+//of it.
+//
+//The engine has no sleeping yet, so bodies moving slower than restingSpeed are counted as resting instead.
+class MetricsExporter
+{
+public:
+	//labels go on every metric as they are, e.g. instance="sim3",scene="piles" (empty for none)
+	MetricsExporter(const std::string &newFilename, const double newInterval, const std::string &newLabels = "");
+
+	//writes whatever has been recorded since the last write (with the body counts from the last write), then stops
+	//the thread
+	~MetricsExporter();
+
+	//records the step the world has just taken
+	void Record(World &world);
+
+	//writes what has been recorded so far now, without waiting for the interval to end
+	void Flush(World &world);
+
+	//speed (m/s and degrees/s) under which a movable body counts as resting
+	static const Real restingSpeed;
+
+	//most steps kept per interval for working out percentiles (the max is always exact)
+	static const unsigned stepSampleLimit = 1 << 16;
+
+	//false if the last write failed
+	bool IsWriting() const { return lastWriteSucceeded.load(std::memory_order_relaxed); }
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	//counts bodies in the world into the snapshot being filled
+	void SampleWorld(World &world);
+
+	//hands the snapshot being filled to the writer thread and starts a new one
+	void Publish();
+
+	void WriterLoop();
+	bool Write(MetricsSnapshot &snapshot);
+
+	std::string filename;
+	double interval;	//seconds
+	std::string labels;
+
+	//filled by Record on the simulation thread
+	MetricsSnapshot current;
+	Clock::time_point intervalStart;
+	uint64_t totalSteps;
+	double totalStepTime;
+	uint64_t alarmSteps[HEALTH_ALARM_COUNT];
+
+	//handed over to the writer thread
+	std::mutex mutex;
+	std::condition_variable snapshotReady;
+	MetricsSnapshot pending;
+	bool hasPending;
+	bool quit;
+	std::atomic<bool> lastWriteSucceeded;
+
+	std::thread writer;
+
+	//not copyable
+	MetricsExporter(const MetricsExporter&);
+	void operator=(const MetricsExporter&);
+};
+
+#endif //METRICSH
@@ -0,0 +1,141 @@
+#include "pairset.h"
+
+#include <algorithm>
+
+// Size //
+void PairSet::Reserve( const unsigned pairs )
+{
+	size_t slotCount = 16;
+	while (slotCount < (size_t)pairs * 2)
+		slotCount *= 2;
+
+	if (slotCount > slots.size())
+		Rehash(slotCount);
+
+	entries.reserve(pairs);
+	began.reserve(pairs);
+	ended.reserve(pairs);
+}
+
+void PairSet::Clear()
+{
+	for (size_t i = 0; i < slots.size(); i++)
+		slots[i].entry = emptySlot;
+
+	entries.clear();
+	began.clear();
+	ended.clear();
+}
+
+void PairSet::Rehash( const size_t slotCount )
+{
+	const Slot empty = {0, emptySlot};
+	slots.assign(slotCount, empty);
+
+	shift = 64;
+	for (size_t size = slotCount; size > 1; size >>= 1)
+		shift--;
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const size_t slot = Find(entries[i].key);
+		slots[slot].key = entries[i].key;
+		slots[slot].entry = (uint32_t)i;
+		entries[i].slot = (uint32_t)slot;
+	}
+}
+
+// Updating //
+void PairSet::BeginUpdate()
+{
+	stamp++;
+	began.clear();
+	ended.clear();
+}
+
+void PairSet::Add( const ShapePair &pair )
+{
+	//kept at most half full, so runs stay short
+	if ((entries.size() + 1) * 2 > slots.size())
+		Rehash(std::max(slots.size() * 2, (size_t)16));
+
+	const uint64_t key = Key(pair.a, pair.b);
+	const size_t slot = Find(key);
+
+	if (slots[slot].entry != emptySlot)
+	{
+		entries[slots[slot].entry].stamp = stamp;
+		return;
+	}
+
+	slots[slot].key = key;
+	slots[slot].entry = (uint32_t)entries.size();
+
+	Entry entry = {key, stamp, (uint32_t)slot};
+	entries.push_back(entry);
+	began.push_back(pair);
+}
+
+void PairSet::EndUpdate()
+{
+	//backwards, so the last entry moved into a hole has always been looked at already
+	for (size_t i = entries.size(); i-- > 0; )
+	{
+		if (entries[i].stamp != stamp)
+		{
+			ShapePair pair = {(unsigned)(entries[i].key >> 32), (unsigned)entries[i].key};
+			ended.push_back(pair);
+			Remove((uint32_t)i);
+		}
+	}
+}
+
+void PairSet::Remove( const uint32_t removed )
+{
+	const size_t mask = slots.size() - 1;
+	size_t gap = entries[removed].slot;
+
+	//a later key in the run moves back into the gap unless its home is after the gap (allowing for wrapping round),
+	//in which case it can still be reached from its home
+	for (size_t slot = (gap + 1) & mask; slots[slot].entry != emptySlot; slot = (slot + 1) & mask)
+	{
+		const size_t home = Home(slots[slot].key);
+		const bool reachable = gap < slot ? (home > gap && home <= slot) : (home > gap || home <= slot);
+
+		if (!reachable)
+		{
+			slots[gap] = slots[slot];
+			entries[slots[gap].entry].slot = (uint32_t)gap;
+			gap = slot;
+		}
+	}
+
+	slots[gap].entry = emptySlot;
+
+	//the last entry fills the hole, and its slot is pointed at its new place
+	const Entry last = entries.back();
+	entries.pop_back();
+
+	if (removed < entries.size())
+	{
+		entries[removed] = last;
+		slots[last.slot].entry = removed;
+	}
+}
+
+// Finding //
+size_t PairSet::Find( const uint64_t key ) const
+{
+	const size_t mask = slots.size() - 1;
+	size_t slot = Home(key);
+
+	while (slots[slot].entry != emptySlot && slots[slot].key != key)
+		slot = (slot + 1) & mask;
+
+	return slot;
+}
+
+bool PairSet::Contains( const unsigned a, const unsigned b ) const
+{
+	return !slots.empty() && slots[Find(Key(a, b))].entry != emptySlot;
+}
@@ -0,0 +1,90 @@
+#ifndef PAIRSETH
+#define PAIRSETH
+
+// Includes //
+#include <stdint.h>
+#include <vector>
+
+#include "broadphase.h"
+
+// Pair Set //
+//the pairs overlapping now, kept from one step to the next so each step only has to list the pairs it found to learn
+//which began overlapping and which stopped. The pairs are kept densely, each with the update that last added it, and
+//found through an open addressing hash table (linear probing, at most half full) keyed on the two indices packed into
+//64 bits - adding or finding a pair is one hash and usually one or two slots, and finding the pairs that ended only
+//looks at the pairs in the set, not the whole table. Each entry knows its slot, so taking one out needs no hashing.
+//
+//An update is BeginUpdate, Add for every pair found, then EndUpdate. Pairs added that weren't in the set are in
+//GetBegan, in the order they were added, and pairs in the set that weren't added are taken out and put in GetEnded.
+//Ended pairs aren't sorted (that would cost more than the rest of the update), but come out in the same order
+//whenever the same pairs have been added in the same order.
+class PairSet
+{
+public:
+	PairSet(): stamp(0), shift(64) {}
+
+	//room for this many pairs without growing
+	void Reserve(const unsigned pairs);
+
+	//empties the set, without reporting any pair as ended
+	void Clear();
+
+	void BeginUpdate();
+	void Add(const ShapePair &pair);
+	void EndUpdate();
+
+	bool Contains(const unsigned a, const unsigned b) const;
+	unsigned Size() const { return (unsigned)entries.size(); }
+
+	//pairs that began and ended overlapping in the last update
+	const std::vector<ShapePair>& GetBegan() const { return began; }
+	const std::vector<ShapePair>& GetEnded() const { return ended; }
+
+	//bytes reserved by the pairs, the table and the deltas
+	size_t GetMemoryUsed() const
+	{
+		return entries.capacity()*sizeof(Entry) + slots.capacity()*sizeof(Slot) + (began.capacity() + ended.capacity())*sizeof(ShapePair);
+	}
+
+private:
+	// Entry
+	struct Entry
+	{
+		uint64_t key;
+		uint32_t stamp;		//the update that last added it
+		uint32_t slot;		//where it is in the table
+	};
+
+	// Slot
+	struct Slot
+	{
+		uint64_t key;
+		uint32_t entry;		//emptySlot if unused
+	};
+
+	static const uint32_t emptySlot = ~(uint32_t)0;
+
+	static uint64_t Key(const unsigned a, const unsigned b) { return ((uint64_t)a << 32) | b; }
+
+	//the slot a key starts looking from (Fibonacci hashing, which spreads the packed indices over the top bits)
+	size_t Home(const uint64_t key) const { return shift < 64 ? (size_t)((key * 0x9E3779B97F4A7C15ull) >> shift) : 0; }
+
+	//the slot holding the key, or the empty slot it would go in
+	size_t Find(const uint64_t key) const;
+
+	//resizes the table to a power of two number of slots, putting every pair back in
+	void Rehash(const size_t slotCount);
+
+	//takes the entry out, moving the last entry into its place
+	void Remove(const uint32_t entry);
+
+	std::vector<Entry> entries;
+	std::vector<Slot> slots;
+	uint32_t stamp;
+	unsigned shift;		//64 less the number of bits in a slot index
+
+	std::vector<ShapePair> began;
+	std::vector<ShapePair> ended;
+};
+
+#endif //PAIRSETH
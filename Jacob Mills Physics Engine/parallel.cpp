@@ -0,0 +1,107 @@
+#include "parallel.h"
+
+ThreadPool::ThreadPool( const unsigned threads ): currentTask(NULL), currentContext(NULL), taskCount(0), nextTask(0), generation(0), busyWorkers(0), quit(false)
+{
+	//calling thread is always one of the threads
+	for (unsigned i = 1; i < threads; i++)
+	{
+		workers.push_back(std::thread(&ThreadPool::WorkerLoop, this, i));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	jobReady.notify_all();
+
+	for (unsigned i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+void ThreadPool::Run( const unsigned count, Task task, void *context )
+{
+	if (count == 0)
+		return;
+
+	//no workers, or nothing worth sharing out
+	if (workers.empty() || count == 1)
+	{
+		for (unsigned i = 0; i < count; i++)
+		{
+			task(context, i, 0);
+		}
+		return;
+	}
+
+	//hand the job out
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		currentTask = task;
+		currentContext = context;
+		taskCount = count;
+		nextTask.store(0);
+		busyWorkers = (unsigned)workers.size();
+		generation++;
+	}
+	jobReady.notify_all();
+
+	//join in
+	DoTasks(0);
+
+	//wait for the workers to finish their last tasks
+	std::unique_lock<std::mutex> lock(mutex);
+	while (busyWorkers > 0)
+	{
+		jobDone.wait(lock);
+	}
+}
+
+unsigned ThreadPool::HardwareThreads()
+{
+	unsigned threads = std::thread::hardware_concurrency();
+	return threads > 0 ? threads : 1;
+}
+
+void ThreadPool::DoTasks( const unsigned thread )
+{
+	for (unsigned task = nextTask.fetch_add(1); task < taskCount; task = nextTask.fetch_add(1))
+	{
+		currentTask(currentContext, task, thread);
+	}
+}
+
+void ThreadPool::WorkerLoop( const unsigned thread )
+{
+	unsigned lastGeneration = 0;
+
+	for (;;)
+	{
+		//wait for a new job
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			while (!quit && generation == lastGeneration)
+			{
+				jobReady.wait(lock);
+			}
+
+			if (quit)
+				return;
+
+			lastGeneration = generation;
+		}
+
+		DoTasks(thread);
+
+		//let Run know this worker is done
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			busyWorkers--;
+		}
+		jobDone.notify_one();
+	}
+}
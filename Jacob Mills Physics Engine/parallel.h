@@ -0,0 +1,77 @@
+#ifndef PARALLELH
+#define PARALLELH
+
+// Includes //
+#include <atomic>
+#include <cstddef>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifndef VECTORH
+#define VECTORH
+	#include <vector>
+#endif
+
+// Thread Pool //
+//a fixed set of worker threads that sit waiting for jobs. A job is a number of tasks (0 to count-1) which are handed
+//out to whichever thread is free next - the calling thread joins in as well, so a pool of 1 thread has no workers at
+//all and just runs everything in place. Nothing is allocated per job.
+class ThreadPool
+{
+public:
+	//function run for each task - given the job's context, the task number, and which thread is running it (0 to threads-1)
+	typedef void (*Task)(void *context, unsigned task, unsigned thread);
+
+	ThreadPool(const unsigned threads);
+	~ThreadPool();
+
+	//runs every task in the job, returning when they are all done
+	void Run(const unsigned count, Task task, void *context);
+
+	//runs function(task, thread) for every task from 0 to count-1
+	template <typename Function>
+	void ParallelFor(const unsigned count, Function &function)
+	{
+		Run(count, &CallFunction<Function>, &function);
+	}
+
+	unsigned GetThreadCount() const { return (unsigned)workers.size() + 1; }
+
+	//number of threads the hardware can actually run at once (at least 1)
+	static unsigned HardwareThreads();
+
+private:
+	template <typename Function>
+	static void CallFunction(void *context, unsigned task, unsigned thread)
+	{
+		(*(Function*)context)(task, thread);
+	}
+
+	//takes tasks from the current job until there are none left
+	void DoTasks(const unsigned thread);
+
+	void WorkerLoop(const unsigned thread);
+
+	std::vector<std::thread> workers;
+
+	std::mutex mutex;
+	std::condition_variable jobReady;
+	std::condition_variable jobDone;
+
+	//current job
+	Task currentTask;
+	void *currentContext;
+	unsigned taskCount;
+	std::atomic<unsigned> nextTask;
+
+	unsigned generation;	//goes up by one for each job, so workers know there is a new one
+	unsigned busyWorkers;	//workers yet to finish the current job
+	bool quit;
+
+	//not copyable
+	ThreadPool(const ThreadPool&);
+	void operator=(const ThreadPool&);
+};
+
+#endif //PARALLELH
@@ -0,0 +1,248 @@
+#include "scene.h"
+
+#include <algorithm>
+
+// Random Numbers //
+//xorshift, so a seed gives the same scene with any compiler or standard library
+class SceneRandom
+{
+private:
+	uint32_t state;
+
+public:
+	SceneRandom(const uint32_t seed): state(seed != 0 ? seed : 0x9e3779b9u) {}
+
+	uint32_t Next()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	//uniform in [min, max), using 24 bits so every float is exact
+	float Range(const float min, const float max)
+	{
+		return min + (max - min) * ((Next() >> 8) * (1.0f / 16777216.0f));
+	}
+};
+
+// Constants //
+const float areaPerBody = 10.0f;		//square metres of arena for each body
+const float packedSpacing = 1.6f;		//distance between centres when shapes are packed together (biggest shape is 1.5m)
+const unsigned pileColumns = 8;
+
+// Body Creation //
+//adds one box, circle or polygon at the position given. Settled shapes are upright and not spinning
+static void AddBody( World &world, SceneRandom &random, const SceneSettings &settings, const Vector2 position, const Vector2 velocity, const bool settled )
+{
+	Shape *shape;
+
+	//only drawn for when it's wanted, so scenes without polygons stay the same as ever
+	if (settings.polygonFraction > 0 && random.Range(0, 1) < settings.polygonFraction)
+	{
+		unsigned sides = 3 + random.Next() % (maxPolygonVertices - 2);
+		Real radius = random.Range(0.25f, 0.75f);
+		Real orientation = settled ? 0.0f : random.Range(0, 360);
+
+		shape = &world.Create(Polygon(position, sides, radius, orientation));
+	}
+	else if (random.Range(0, 1) < settings.boxFraction)
+	{
+		Real width = random.Range(0.5f, 1.5f);
+		Real height = random.Range(0.5f, 1.5f);
+		Real orientation = settled ? 0.0f : random.Range(0, 360);
+
+		shape = &world.Create(Box(position, width, height, orientation));
+	}
+	else
+	{
+		shape = &world.Create(Circle(position, random.Range(0.25f, 0.75f)));
+	}
+
+	shape->SetVelocity(velocity.x, velocity.y);
+	shape->SetRotation(settled ? 0.0f : random.Range(-90, 90));
+
+	//only drawn for when it's wanted, so scenes without static bodies stay the same as ever
+	if (settings.staticFraction > 0 && random.Range(0, 1) < settings.staticFraction)
+	{
+		shape->SetImmovable();
+
+		if (settings.sensorFraction > 0 && random.Range(0, 1) < settings.sensorFraction)
+			shape->SetSensor(true);
+	}
+	else if (settings.debrisFraction > 0 && random.Range(0, 1) < settings.debrisFraction)
+		shape->SetFilter(CollisionFilter(debrisCategory, (uint16_t)~debrisCategory));
+}
+
+//velocity in a random direction with a random speed between the two given
+static Vector2 RandomVelocity( SceneRandom &random, const float minSpeed, const float maxSpeed )
+{
+	float speed = random.Range(minSpeed, maxSpeed);
+	float sine, cosine;
+	SinCos(random.Range(0, 2*Pi), sine, cosine);
+
+	return Vector2(speed*cosine, speed*sine);
+}
+
+// Layouts //
+//one body in each cell of an even lattice over the arena, jittered so it doesn't look like a lattice
+static void Spread( World &world, SceneRandom &random, const SceneSettings &settings, const float side, const float minSpeed, const float maxSpeed )
+{
+	const unsigned perRow = (unsigned)ceil(sqrt((double)settings.bodies));
+	const float spacing = side / perRow;
+	const float jitter = std::max(0.0f, spacing*0.5f - packedSpacing*0.5f);
+
+	for (unsigned i = 0; i < settings.bodies; i++)
+	{
+		float x = (i % perRow + 0.5f) * spacing + random.Range(-jitter, jitter);
+		float y = (i / perRow + 0.5f) * spacing + random.Range(-jitter, jitter);
+
+		AddBody(world, random, settings, Vector2(x, y), RandomVelocity(random, minSpeed, maxSpeed), false);
+	}
+}
+
+//a packed square clump for every thousand bodies, each dropped somewhere random in the arena
+static void Clusters( World &world, SceneRandom &random, const SceneSettings &settings, const float side )
+{
+	const unsigned clusterCount = std::max(1u, settings.bodies / 1000);
+	unsigned placed = 0;
+
+	for (unsigned cluster = 0; cluster < clusterCount; cluster++)
+	{
+		//share the bodies out, with the last cluster taking what's left over
+		const unsigned count = cluster+1 < clusterCount ? settings.bodies / clusterCount : settings.bodies - placed;
+		const unsigned perRow = (unsigned)ceil(sqrt((double)count));
+		const float size = perRow * packedSpacing;
+
+		float centreX = side*0.5f;
+		float centreY = side*0.5f;
+
+		if (size + 2 < side)
+		{
+			centreX = random.Range(size*0.5f + 1, side - size*0.5f - 1);
+			centreY = random.Range(size*0.5f + 1, side - size*0.5f - 1);
+		}
+
+		for (unsigned i = 0; i < count; i++)
+		{
+			float x = centreX + ((i % perRow) + 0.5f - perRow*0.5f) * packedSpacing;
+			float y = centreY + ((i / perRow) + 0.5f - perRow*0.5f) * packedSpacing;
+
+			AddBody(world, random, settings, Vector2(x, y), RandomVelocity(random, 0, 2), false);
+		}
+
+		placed += count;
+	}
+}
+
+//columns of upright shapes resting on the floor, spread evenly along it
+static void Piles( World &world, SceneRandom &random, const SceneSettings &settings, const float side )
+{
+	const unsigned pileCount = std::max(1u, (unsigned)(sqrt((double)settings.bodies) / pileColumns));
+	const float pileGap = side / pileCount;
+	unsigned placed = 0;
+
+	for (unsigned pile = 0; pile < pileCount; pile++)
+	{
+		const unsigned count = pile+1 < pileCount ? settings.bodies / pileCount : settings.bodies - placed;
+		const float centreX = (pile + 0.5f) * pileGap;
+
+		for (unsigned i = 0; i < count; i++)
+		{
+			//y goes down the screen, so the floor is at y = side
+			float x = centreX + ((i % pileColumns) + 0.5f - pileColumns*0.5f) * packedSpacing;
+			float y = side - (i / pileColumns + 0.5f) * packedSpacing;
+
+			AddBody(world, random, settings, Vector2(x, y), Vector2(0, 0), true);
+		}
+
+		placed += count;
+	}
+}
+
+// Scene Generation //
+Scene GenerateScene( World &world, const SceneSettings &settings )
+{
+	SceneRandom random(settings.seed);
+
+	const float side = std::max(20.0f, (float)sqrt(areaPerBody * settings.bodies));
+
+	Scene scene;
+	scene.width = side;
+	scene.height = side;
+	scene.gravity = Vector2(0, 0);
+
+	//border, the same way round as InitialiseHalfSpaceBorder in main.cpp
+	world.Create(HalfSpace(Vector2(0, 1), 0));
+	world.Create(HalfSpace(Vector2(-1, 0), -side));
+	world.Create(HalfSpace(Vector2(0, -1), -side));
+	world.Create(HalfSpace(Vector2(1, 0), 0));
+
+	switch (settings.layout)
+	{
+	case UNIFORM_SCENE:
+		Spread(world, random, settings, side, 0, 5);
+		break;
+	case CLUSTERED_SCENE:
+		Clusters(world, random, settings, side);
+		break;
+	case PILES_SCENE:
+		Piles(world, random, settings, side);
+		scene.gravity = Vector2(0, 9.8f);
+		break;
+	case GAS_SCENE:
+		Spread(world, random, settings, side, 20, 50);
+		break;
+	}
+
+	return scene;
+}
+
+// Ray Generation //
+void GenerateRays( const Scene &scene, const unsigned count, const float length, const uint32_t seed, std::vector<Ray> &rays )
+{
+	SceneRandom random(seed);
+
+	rays.resize(count);
+	for (unsigned i = 0; i < count; i++)
+	{
+		const Vector2 from(random.Range(0, ToFloat(scene.width)), random.Range(0, ToFloat(scene.height)));
+		rays[i] = Ray(from, from + Vector2(random.Range(-length, length), random.Range(-length, length)));
+	}
+}
+
+void GenerateRegions( const Scene &scene, const unsigned count, const float size, const uint32_t seed, std::vector<AABB> &regions )
+{
+	SceneRandom random(seed);
+
+	regions.resize(count);
+	for (unsigned i = 0; i < count; i++)
+	{
+		const Vector2 centre(random.Range(0, ToFloat(scene.width)), random.Range(0, ToFloat(scene.height)));
+		regions[i].min = centre - Vector2(size/2, size/2);
+		regions[i].max = centre + Vector2(size/2, size/2);
+	}
+}
+
+// Layout Names //
+static const char *layoutNames[] = {"uniform", "clustered", "piles", "gas"};
+
+bool ParseSceneLayout( const std::string &name, SceneLayout &layout )
+{
+	for (unsigned i = 0; i < 4; i++)
+	{
+		if (name == layoutNames[i])
+		{
+			layout = (SceneLayout)i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const char* GetSceneLayoutName( const SceneLayout layout )
+{
+	return layoutNames[layout];
+}
@@ -0,0 +1,62 @@
+#ifndef SCENEH
+#define SCENEH
+
+// Includes //
+#include <stdint.h>
+
+#include "core.h"
+#include "vector2.h"
+#include "world.h"
+
+// Scene Layouts //
+//UNIFORM_SCENE - shapes spread evenly over the whole arena, moving at walking pace
+//CLUSTERED_SCENE - tightly packed clumps with empty space between them, so a few grid cells hold most of the work
+//PILES_SCENE - columns of shapes stacked on the floor under gravity, always in contact
+//GAS_SCENE - spread out like UNIFORM_SCENE but fast, so shapes cover several cells a second
+enum SceneLayout{UNIFORM_SCENE, CLUSTERED_SCENE, PILES_SCENE, GAS_SCENE};
+
+struct SceneSettings
+{
+	SceneLayout layout;
+	unsigned bodies;		//boxes, circles and polygons, not counting the border
+	float polygonFraction;	//share of the bodies made polygons of 3 to maxPolygonVertices sides
+	float boxFraction;		//of the rest, 0 for all circles, 1 for all boxes
+	float staticFraction;	//share of the bodies made immovable, like the walls and platforms of a level
+	float debrisFraction;	//share of the movable bodies made debris, which hits everything but other debris
+	float sensorFraction;	//share of the immovable bodies made sensors, like trigger zones
+	uint32_t seed;			//same seed, same scene
+
+	SceneSettings(): layout(UNIFORM_SCENE), bodies(1000), polygonFraction(0), boxFraction(0.5f), staticFraction(0), debrisFraction(0),
+		sensorFraction(0), seed(1) {}
+};
+
+//the collision category debris is put in (everything else is in the first)
+const uint16_t debrisCategory = 2;
+
+// Scene //
+//what the generator made, so the caller knows the size of the arena and what gravity it was laid out for
+struct Scene
+{
+	Real width;
+	Real height;
+	Vector2 gravity;
+};
+
+// Functions //
+//fills the world with shapes laid out as asked, inside a border of four halfspaces like the demo's. The arena grows
+//with the number of bodies (about 10 square metres each) so the density stays the same from 100 to a million
+Scene GenerateScene(World &world, const SceneSettings &settings);
+
+//fills rays with count rays from random points in the scene's arena to points up to length metres away along each
+//axis, like the line of sight checks between a crowd of agents. Same seed, same rays
+void GenerateRays(const Scene &scene, const unsigned count, const float length, const uint32_t seed, std::vector<Ray> &rays);
+
+//fills regions with count squares of the size given, centred on random points in the scene's arena, like the areas of
+//effect and selection boxes of a game. Same seed, same regions
+void GenerateRegions(const Scene &scene, const unsigned count, const float size, const uint32_t seed, std::vector<AABB> &regions);
+
+//names used on command lines, e.g. "uniform". Returns false if the name isn't a layout
+bool ParseSceneLayout(const std::string &name, SceneLayout &layout);
+const char* GetSceneLayoutName(const SceneLayout layout);
+
+#endif //SCENEH
@@ -1,10 +1,16 @@
 #ifndef SHAPEH
 #define SHAPEH
 
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
 #include "core.h"
 #include "vector2.h"
 #include "body.h"
 #include "vertex.h"
+#include "trace.h"
+#include "aabb.h"
 
 
 // DrawLine //
@@ -25,7 +31,7 @@ public:
 	origin(newPos), direction(newPos.x+10, newPos.y) {} 
 
 	//provide position and length, get horizontal
-	DrawLine(const Vector2 newPos, const float newLength): 
+	DrawLine(const Vector2 newPos, const Real newLength): 
 	origin(newPos), direction(newPos.x+newLength, newPos.y){}
 
 	//provide an origin and a direction, get that line
@@ -33,7 +39,7 @@ public:
 	origin(newOrigin),  direction(newDirection) {}
 
 	//provide position, size and rotation
-	DrawLine (const Vector2 newPos, const float newLength, const float newRot)
+	DrawLine (const Vector2 newPos, const Real newLength, const Real newRot)
 	{
 		(*this) = DrawLine(newPos, newLength);
 
@@ -41,22 +47,21 @@ public:
 	}
 
 	//draw the line (not really part of the physics engine)
-	void AddDrawInfo(VertexList &vertexList, DWORD colour) const
+	void AddDrawInfo(VertexList &vertexList, Colour colour) const
 	{
-		std::vector<Vertex> vertices;
+		TRACE_SCOPE("DrawLine::AddDrawInfo");
+
+		vertexList.BeginStrip();
 
 		Vertex vertex = {MetresToPixels(origin.x),MetresToPixels(origin.y), 0, 1, colour};
-		vertices.push_back(vertex);
+		vertexList.Add(vertex);
 
 		//get vertex of other end
 		vertex.x = MetresToPixels(direction.x);
 		vertex.y = MetresToPixels(direction.y);
 
-		//add to vertices vector
-		vertices.push_back(vertex);	
-
-		//add the vertices to the vertex buffer vector
-		vertexList.push_back(vertices);	
+		//add to the vertex list
+		vertexList.Add(vertex);
 	}
 
 	//if no colour given, just do white
@@ -68,26 +73,24 @@ public:
 	//draws normal of the line, at the origin point
 	void DrawNormal(VertexList &vertexList) const
 	{
-		std::vector<Vertex> vertices;
+		vertexList.BeginStrip();
 		Vertex vertex = {MetresToPixels(origin.x), MetresToPixels(origin.y), 0, 1, YELLOW};
-		vertices.push_back(vertex);
+		vertexList.Add(vertex);
 
 		vertex.x = MetresToPixels(origin.x-Normal().x);
 		vertex.y = MetresToPixels(origin.y - Normal().y);
-		vertices.push_back(vertex);
-
-		vertexList.push_back(vertices);
+		vertexList.Add(vertex);
 	}
 
 	//change direction vector according to rotation amount (degrees)
-	void RotateAboutLineOrigin(const float rotation)
+	void RotateAboutLineOrigin(const Real rotation)
 	{
 		direction.RotateAboutPoint(origin, rotation);
 
 	}
 
 	//rotate a line about its centre-point (degrees)
-	void Rotate(const float rotation)
+	void Rotate(const Real rotation)
 	{
 		//translate the line so that the centre point is on the world origin
 		Vector2 translation = origin.GetInvert() + (origin-direction)*0.5;
@@ -108,7 +111,7 @@ public:
 		direction += translation;
 	}
 
-	void Translate(const float x, const float y)
+	void Translate(const Real x, const Real y)
 	{
 		origin.x+=x;
 		origin.y+=y;
@@ -125,6 +128,31 @@ public:
 
 //  Collision Shapes  //
 
+// Collision Filter //
+//which other shapes a shape collides with. Shapes in the same non-zero group always collide if it is positive and never
+//if it is negative; otherwise each has to be in a category the other's mask has. By default every shape is in the
+//first category and collides with every other
+struct CollisionFilter
+{
+	uint16_t category;	//one bit for each category the shape is in
+	uint16_t mask;		//one bit for each category it collides with
+	int16_t group;
+
+	CollisionFilter(): category(1), mask(0xFFFF), group(0) {}
+	CollisionFilter(const uint16_t newCategory, const uint16_t newMask, const int16_t newGroup = 0): category(newCategory), mask(newMask), group(newGroup) {}
+
+	//collides with everything that doesn't filter it out itself
+	bool IsOpen() const { return mask == 0xFFFF && group == 0; }
+};
+
+inline bool ShouldCollide( const CollisionFilter &one, const CollisionFilter &two )
+{
+	if (one.group != 0 && one.group == two.group)
+		return one.group > 0;
+
+	return (one.mask & two.category) != 0 && (two.mask & one.category) != 0;
+}
+
 // Shape //
 class Shape
 {
@@ -133,15 +161,22 @@ protected:
 	//the physical information tied to this shape
 	Body *body;
 
+	CollisionFilter filter;
+
+	bool sensor;
+
+	//GetTypeLayouts counts the members
+	friend class MemberSizes;
+
 public:
 	// Constructors
-	Shape(): body(new Body()){};
-	Shape(const Vector2 newPos): body(new Body(newPos)){};
-	Shape(const Vector2 newPos, const float newOrientation): body(new Body(newPos, newOrientation)){};
+	Shape(): body(new Body()), sensor(false){};
+	Shape(const Vector2 newPos): body(new Body(newPos)), sensor(false){};
+	Shape(const Vector2 newPos, const Real newOrientation): body(new Body(newPos, newOrientation)), sensor(false){};
 //	Shape(const Vector2 newPos, const float newInvMass): body(new Body(newPos, newInvMass)){};
 //	Shape(const Vector2 newPos, const float newInvMass, const float newInvInertia): body(new Body(newPos, newInvMass, newInvInertia)){};
 	//Shapeblahlbah orientation //TODO: make things use orientation
-	Shape(Body* newBody): body(newBody){};
+	Shape(Body* newBody): body(newBody), sensor(false){};
 
 	// Methods
 	//pure virtual Draw function - every body must be able to be drawn
@@ -171,13 +206,13 @@ public:
 		body->position += translation;
 	}
 
-	virtual void Translate(const float x, const float y)
+	virtual void Translate(const Real x, const Real y)
 	{
 		body->position.x += x;
 		body->position.y += y;
 	}
 
-	virtual void Rotate(const float rotation)
+	virtual void Rotate(const Real rotation)
 	{
 		body->orientation += rotation;
 
@@ -221,13 +256,33 @@ public:
 
 	// Accessors
 	virtual Vector2 GetPosition() const { return body->position; }
-	virtual float GetOrientation() const { return body->orientation; }
-	float GetInverseMass() const { return body->inverseMass; }
+	virtual Real GetOrientation() const { return body->orientation; }
+	Real GetInverseMass() const { return body->inverseMass; }
+	Real GetInverseMomentOfInertia() const { return body->inverseMomentOfInertia; }
 	Body* GetBody() const {return body; }
 	virtual ObjectType GetType() const { return SHAPE ;}
 
-	void SetVelocity(float x, float y) { body->velocity = Vector2(x, y); }
-	void SetMass(float newMass) {body->inverseMass = 1/newMass ;}
+	Vector2 GetVelocity() const { return body->velocity; }
+	Real GetRotation() const { return body->rotation; }
+
+	void SetPosition(const Vector2 newPosition) { body->position = newPosition; }
+	void SetOrientation(const Real newOrientation) { body->orientation = newOrientation; }
+	void SetVelocity(Real x, Real y) { body->velocity = Vector2(x, y); }
+	void SetRotation(Real newRotation) { body->rotation = newRotation; }
+	void SetMass(Real newMass) {body->inverseMass = 1/newMass ;}
+
+	//infinite mass and moment of inertia, so nothing can move it (a World has to be told with UpdateStatic)
+	void SetImmovable() { body->inverseMass = 0; body->inverseMomentOfInertia = 0; body->velocity = Vector2(0,0); body->rotation = 0; }
+	bool IsImmovable() const { return body->inverseMass <= 0; }
+
+	//which shapes this one collides with - pairs it rules out never reach the narrowphase
+	const CollisionFilter& GetFilter() const { return filter; }
+	void SetFilter(const CollisionFilter &newFilter) { filter = newFilter; }
+
+	//sensors only report what overlaps them (see World::GetSensorEvents) - they never make contacts, so never push
+	//anything or get pushed. The filter still decides what they sense, but two sensors never sense each other
+	bool IsSensor() const { return sensor; }
+	void SetSensor(const bool isSensor) { sensor = isSensor; }
 	
 };
 
@@ -356,13 +411,16 @@ class HalfSpace : public Shape
 	//therefore negative vectors will need a negative offset
 private:
 	//going to use body's position as the normal for the halfSpace
-	float offset;
+	Real offset;
+
+	//GetTypeLayouts counts the members
+	friend class MemberSizes;
 
 	//HalfSpaces shouldn't move, so make translate private. Curse inheritance
 	void Translate(const Vector2 translation){}
-	void Translate(const float x, const float y){}
+	void Translate(const Real x, const Real y){}
 
-	void Rotate(const float newOrientation){}
+	void Rotate(const Real newOrientation){}
 
 	//use GetNormal*GetOffset instead
 	Vector2 GetPosition() const { return Vector2(-1,-1); }
@@ -372,12 +430,14 @@ public:
 	HalfSpace(): Shape(Vector2(0,1)/*, 0*/), offset(20.0f){body->inverseMass=0; body->inverseMomentOfInertia = 0; }
 
 	//HalfSpace is defined as a normal vector, and an offset from the origin 
-	HalfSpace(Vector2 newNormal, float newOffset):
+	HalfSpace(Vector2 newNormal, Real newOffset):
 		Shape(newNormal/*, 0*/), offset(newOffset){body->position.Normalise(); body->inverseMass=0; body->inverseMomentOfInertia = 0; }
 
 	//make a line and draw that using the half-space data
 	void AddDrawInfo(VertexList &vertexList) const
 	{
+		TRACE_SCOPE("HalfSpace::AddDrawInfo");
+
 		//line's origin is the point along the normal specified by the offset
 		Vector2 lineOrigin = body->position * offset;
 
@@ -404,7 +464,7 @@ public:
 	}
 
 	//accessors
-	float GetOffset() const { return offset; }
+	Real GetOffset() const { return offset; }
 	Vector2 GetNormal() const {	return body->position; }
 	ObjectType GetType() const { return HALFSPACE ; }
 };
@@ -414,7 +474,7 @@ class Circle : public Shape
 {
 private:
 	//calculates the circle's moment of inertia from its internal values
-	float CalculateInverseMomentOfInertia() const
+	Real CalculateInverseMomentOfInertia() const
 	{
 		//moment of inertia for a disk: I = 0.5mr^2
 		return 1.0f / (0.5f * body->GetMass() * radius * radius);
@@ -422,7 +482,10 @@ private:
 
 	//Circle is stored as origin at centre, and radius
 protected:
-	float radius;
+	Real radius;
+
+	//GetTypeLayouts counts the members
+	friend class MemberSizes;
 
 public:
 	//draw a circle with centre at 10,10, radius of 5
@@ -433,42 +496,58 @@ public:
 		radius(5.0f), Shape(newPos){ body->inverseMomentOfInertia = CalculateInverseMomentOfInertia(); };
 
 	//give position and radius, get circle with properties
-	Circle(const Vector2 newPos, const float newRad):
+	Circle(const Vector2 newPos, const Real newRad):
 		radius(newRad), Shape(newPos){ body->inverseMomentOfInertia = CalculateInverseMomentOfInertia(); };
 
 	//accessor methods
-	float GetRadius() const { return radius; }
+	Real GetRadius() const { return radius; }
 	ObjectType GetType() const { return CIRCLE;}
 
+	//bounds of the circle where it is now - quicker to work out than to check a cache for, so never cached
+	AABB GetBounds() const
+	{
+		AABB bounds;
+		bounds.min = Vector2(body->position.x - radius, body->position.y - radius);
+		bounds.max = Vector2(body->position.x + radius, body->position.y + radius);
+		return bounds;
+	}
+
 	//draw the circle
 	void AddDrawInfo(VertexList &vertexList) const 
 	{
+		TRACE_SCOPE("Circle::AddDrawInfo");
+
 		//draw a nice smooth circle regardless of radius - this is just the number of points used to draw 
-		const int smoothness = (int)radius+25;
+		const int smoothness = (int)ToFloat(radius)+25;
 
-		//create the vector of vertices
-		std::vector<Vertex> vertices;
+		//start the circle's strip of vertices
+		vertexList.BeginStrip();
 		Vertex vertex = {MetresToPixels(body->position.x),MetresToPixels(body->position.y), 0, 1, WHITE};
 			
-		//values for calculating next point on circumference
-		float wedgeAngle = 2*Pi / smoothness;
-		float theta;
+		//values for calculating next point on circumference - one sine and cosine for the wedge,
+		//then each point is the last one rotated by it
+		Real wedgeSin;
+		Real wedgeCos;
+		SinCos(Real(2*Pi / smoothness), wedgeSin, wedgeCos);
 
-		//rotate to next point and put into vertices vector
+		//point on the circumference relative to the centre, starting at theta = 0
+		Vector2 spoke(radius, 0);
+
+		//rotate to next point and put into the vertex list
 		for (int i =0; i<=smoothness; i++)
 		{
-			theta = wedgeAngle*i;
+			vertex.x = MetresToPixels(body->position.x + spoke.x);
+			vertex.y = MetresToPixels(body->position.y - spoke.y);
 
-			vertex.x = MetresToPixels(body->position.x + radius * cos(theta));
-			vertex.y = MetresToPixels(body->position.y - radius * sin(theta));
+			vertexList.Add(vertex);
 
-			vertices.push_back(vertex);
+			Real tempX = spoke.x;
+			spoke.x = tempX * wedgeCos - spoke.y * wedgeSin;
+			spoke.y = tempX * wedgeSin + spoke.y * wedgeCos;
 		}
-
-		vertexList.push_back(vertices);
 	}
 
-	void RotateAboutWorldOrigin(const float rotation )
+	void RotateAboutWorldOrigin(const Real rotation )
 	{
 		body->position.RotateAboutWorldOrigin(rotation);
 	}
@@ -546,76 +625,75 @@ class Box : public Shape
 {
 private:
 	//calculates the box's moment of inertia from its internal values
-	float CalculateInverseMomentOfInertia() const
+	Real CalculateInverseMomentOfInertia() const
 	{
 		//moment of inertia for a rectangle: I = 1/12m(dx^2 + dy^2)
 		return 1/( (1.0f/12.0f) * body->GetMass() * ( GetSize().x*GetSize().x + GetSize().y*GetSize().y ));
 	}
 
-protected:
-	Vector2 halfSize; //half-size of the box
+	// Pose Cache
+	//world space vertices, axes and bounds, kept with the position, orientation and trig mode they were worked out
+	//for. They are worked out again the first time they're asked for after any of those change, however the body was
+	//moved (Translate, Rotate, integration, contact resolution or setting it directly), so every reader shares one set.
+	//Refreshing isn't safe from two threads at once, so World refreshes each box while bounding it, before the
+	//narrowphase threads read them
+	struct PoseCache
+	{
+		Vector2 position;
+		Real orientation;
+		TrigMode trig;
+		bool valid;
 
-public:
-	//no parameters creates a square 8m big at (6,6)
-	Box(): Shape(Vector2(6,6)), halfSize(4,4) {body->inverseMomentOfInertia = CalculateInverseMomentOfInertia(); };
+		Vector2 vertices[4];
+		Vector2 xAxis;
+		Vector2 yAxis;
+		AABB bounds;
 
-	//providing a position creates a square 8m big at the position
-	Box(const Vector2 newPos): 
-		Shape(newPos), halfSize(4,4){ body->inverseMomentOfInertia = CalculateInverseMomentOfInertia(); };
+		PoseCache(): orientation(0), trig(PRECISE_TRIG), valid(false) {}
+	};
 
-	//provide a position and size to create square at place and size
-	Box(const Vector2 newPos, const float newSize): 
-		Shape(newPos),halfSize(newSize/2.0f,newSize/2.0f){ body->inverseMomentOfInertia = CalculateInverseMomentOfInertia(); };
+	mutable PoseCache cache;
 
-	//provide position height and width for custom rectangle at position
-	Box(const Vector2 newPos, const float newHeight, const float newWidth): 
-		Shape(newPos), halfSize(newHeight/2.0f, newWidth/2.0f){ body->inverseMomentOfInertia = CalculateInverseMomentOfInertia(); };
+	//compared bit for bit, so a box that has blown up to NaN still matches its cache
+	const PoseCache& GetCache() const
+	{
+		if (!cache.valid || cache.trig != GetTrigMode() || memcmp(&cache.position, &body->position, sizeof(Vector2)) != 0
+			|| memcmp(&cache.orientation, &body->orientation, sizeof(Real)) != 0)
+			Refresh();
 
-	//provide position, height, width and rotation to have a rotated square of any size wherever
-	Box(const Vector2 newPos, const float newHeight, const float newWidth, const float newOrientation): 
-		Shape(newPos, newOrientation), halfSize(newHeight/2.0f, newWidth/2.0f){ body->inverseMomentOfInertia = CalculateInverseMomentOfInertia(); };
+		return cache;
+	}
 
-	//Draws a box, calculating rotated vertices from rotation member
-	void AddDrawInfo(VertexList &vertexList) const
+	void Refresh() const
 	{
-		//get array of vertices
-		Vector2 vertsArray[4] ;
-		GetVertices(vertsArray);
+		cache.position = body->position;
+		cache.orientation = body->orientation;
+		cache.trig = GetTrigMode();
+		cache.valid = true;
 
-		std::vector<Vertex> vertices;
+		//one sine and cosine for everything, worked through exactly as Vector2's rotations would
+		Real sine;
+		Real cosine;
+		SinCos(DegreesToRadians(body->orientation), sine, cosine);
 
-		//populate first vertex
-		Vertex vertex = {MetresToPixels(vertsArray[0].x), MetresToPixels(vertsArray[0].y), 0, 1, WHITE};
-		vertices.push_back(vertex);
+		ComputeVertices(cache.vertices, sine, cosine);
 
-		//get other vertices
-		for (int i = 1; i<4; i++)
+		cache.xAxis = Vector2(1*cosine - 0*sine, 1*sine + 0*cosine);
+		cache.yAxis = Vector2(0*cosine - 1*sine, 0*sine + 1*cosine);
+
+		cache.bounds.min = cache.bounds.max = cache.vertices[0];
+		for (int i = 1; i < 4; i++)
 		{
-			vertex.x = MetresToPixels(vertsArray[i].x);
-			vertex.y = MetresToPixels(vertsArray[i].y);
-			vertices.push_back(vertex);
+			cache.bounds.min.x = std::min(cache.bounds.min.x, cache.vertices[i].x);
+			cache.bounds.min.y = std::min(cache.bounds.min.y, cache.vertices[i].y);
+			cache.bounds.max.x = std::max(cache.bounds.max.x, cache.vertices[i].x);
+			cache.bounds.max.y = std::max(cache.bounds.max.y, cache.vertices[i].y);
 		}
-
-		//put first vertex in again to complete box drawing
-		vertex.x = MetresToPixels(vertsArray[0].x);
-		vertex.y = MetresToPixels(vertsArray[0].y);
-		vertices.push_back(vertex);
-
-		//push onto vertex buffer
-		vertexList.push_back(vertices);
 	}
 
-	//accessors
-	Vector2 GetSize() const { return halfSize*2; }
-	Vector2 GetHalfSize() const { return halfSize; }
-	ObjectType GetType() const { return BOX; }
-
-	//supply four Vector2s and have the vertex co ordinates put into them for the box's position and rotation
-	void GetVertices(Vector2 vertices[]) const 
+	//works the vertices out from the body, for the cache
+	void ComputeVertices(Vector2 (&vertices)[4], const Real sine, const Real cosine) const 
 	{
-		//ensure array is correct size 
-		if (sizeof(vertices) != 4)	{ throw std::exception("GetVertices(): Array is incorrect size."); }
-
 		//get vertices for unrotated box
 		vertices[0] = Vector2(body->position.x-halfSize.x, body->position.y-halfSize.y);	//top left
 		vertices[1] = Vector2(body->position.x+halfSize.x, body->position.y-halfSize.y);	//top right
@@ -667,32 +745,95 @@ public:
 			return;
 		}
 
-		//rotate each vertex
+		//rotate all four vertices about the centre
 		for (int i = 0; i < 4; i++)
 		{
-			vertices[i].RotateAboutPoint(body->position, body->orientation);
+			const Vector2 relative = vertices[i] - body->position;
+			vertices[i] = Vector2(relative.x*cosine - relative.y*sine, relative.x*sine + relative.y*cosine) + body->position;
 		}
-
 	}
 
-	//gets box's local x axis
-	Vector2 GetXAxis() const
+protected:
+	Vector2 halfSize; //half-size of the box
+
+	//GetTypeLayouts counts the members
+	friend class MemberSizes;
+
+public:
+	//no parameters creates a square 8m big at (6,6)
+	Box(): Shape(Vector2(6,6)), halfSize(4,4) {body->inverseMomentOfInertia = CalculateInverseMomentOfInertia(); };
+
+	//providing a position creates a square 8m big at the position
+	Box(const Vector2 newPos): 
+		Shape(newPos), halfSize(4,4){ body->inverseMomentOfInertia = CalculateInverseMomentOfInertia(); };
+
+	//provide a position and size to create square at place and size
+	Box(const Vector2 newPos, const Real newSize): 
+		Shape(newPos),halfSize(newSize/2.0f,newSize/2.0f){ body->inverseMomentOfInertia = CalculateInverseMomentOfInertia(); };
+
+	//provide position height and width for custom rectangle at position
+	Box(const Vector2 newPos, const Real newHeight, const Real newWidth): 
+		Shape(newPos), halfSize(newHeight/2.0f, newWidth/2.0f){ body->inverseMomentOfInertia = CalculateInverseMomentOfInertia(); };
+
+	//provide position, height, width and rotation to have a rotated square of any size wherever
+	Box(const Vector2 newPos, const Real newHeight, const Real newWidth, const Real newOrientation): 
+		Shape(newPos, newOrientation), halfSize(newHeight/2.0f, newWidth/2.0f){ body->inverseMomentOfInertia = CalculateInverseMomentOfInertia(); };
+
+	//Draws a box, calculating rotated vertices from rotation member
+	void AddDrawInfo(VertexList &vertexList) const
 	{
-		Vector2 axis(1,0);
-		axis.RotateAboutWorldOrigin(body->orientation);
-		return axis;
+		TRACE_SCOPE("Box::AddDrawInfo");
+
+		//get array of vertices
+		Vector2 vertsArray[4] ;
+		GetVertices(vertsArray);
+
+		vertexList.BeginStrip();
+
+		//populate first vertex
+		Vertex vertex = {MetresToPixels(vertsArray[0].x), MetresToPixels(vertsArray[0].y), 0, 1, WHITE};
+		vertexList.Add(vertex);
+
+		//get other vertices
+		for (int i = 1; i<4; i++)
+		{
+			vertex.x = MetresToPixels(vertsArray[i].x);
+			vertex.y = MetresToPixels(vertsArray[i].y);
+			vertexList.Add(vertex);
+		}
+
+		//put first vertex in again to complete box drawing
+		vertex.x = MetresToPixels(vertsArray[0].x);
+		vertex.y = MetresToPixels(vertsArray[0].y);
+		vertexList.Add(vertex);
 	}
 
-	//gets box's local y axis
-	Vector2 GetYAxis() const
+	//accessors
+	Vector2 GetSize() const { return halfSize*2; }
+	Vector2 GetHalfSize() const { return halfSize; }
+	ObjectType GetType() const { return BOX; }
+
+	//supply four Vector2s and have the vertex co ordinates put into them for the box's position and rotation
+	//(taking the array by reference means the compiler makes sure it is the correct size)
+	void GetVertices(Vector2 (&vertices)[4]) const 
 	{
-		Vector2 axis(0,1);
-		axis.RotateAboutWorldOrigin(body->orientation);
-		return axis;
+		const PoseCache &pose = GetCache();
+
+		for (int i = 0; i < 4; i++)
+			vertices[i] = pose.vertices[i];
 	}
 
+	//gets box's local x axis
+	Vector2 GetXAxis() const { return GetCache().xAxis; }
+
+	//gets box's local y axis
+	Vector2 GetYAxis() const { return GetCache().yAxis; }
+
+	//tightest bounds around the vertices
+	const AABB& GetBounds() const { return GetCache().bounds; }
+
 	//rotate box around the world origin
-	void RotateAboutWorldOrigin(const float newRot)
+	void RotateAboutWorldOrigin(const Real newRot)
 	{
 		body->position.RotateAboutWorldOrigin(newRot);
 		Rotate(newRot);
@@ -760,5 +901,277 @@ public:
 //};
 
 
+// Polygon //
+//a convex polygon of 3 to maxPolygonVertices vertices. Its outline is the convex hull of the points it is made from, so
+//they can come in any order, wound the same way round as a Box's vertices. The body sits at the centroid, and each
+//edge's outward normal is worked out once in the polygon's own coordinates and turned along with the vertices
+class Polygon : public Shape
+{
+private:
+	// Pose Cache
+	//world space vertices, normals and bounds, kept and refreshed just as Box's are
+	struct PoseCache
+	{
+		Vector2 position;
+		Real orientation;
+		TrigMode trig;
+		bool valid;
+
+		Vector2 vertices[maxPolygonVertices];
+		Vector2 normals[maxPolygonVertices];
+		AABB bounds;
+
+		PoseCache(): orientation(0), trig(PRECISE_TRIG), valid(false) {}
+	};
+
+	mutable PoseCache cache;
+
+	const PoseCache& GetCache() const
+	{
+		if (!cache.valid || cache.trig != GetTrigMode() || memcmp(&cache.position, &body->position, sizeof(Vector2)) != 0
+			|| memcmp(&cache.orientation, &body->orientation, sizeof(Real)) != 0)
+			Refresh();
+
+		return cache;
+	}
+
+	void Refresh() const
+	{
+		cache.position = body->position;
+		cache.orientation = body->orientation;
+		cache.trig = GetTrigMode();
+		cache.valid = true;
+
+		Real sine;
+		Real cosine;
+		SinCos(DegreesToRadians(body->orientation), sine, cosine);
+
+		for (unsigned i = 0; i < count; i++)
+		{
+			const Vector2 &vertex = localVertices[i];
+			const Vector2 &normal = localNormals[i];
+			cache.vertices[i] = Vector2(vertex.x*cosine - vertex.y*sine, vertex.x*sine + vertex.y*cosine) + body->position;
+			cache.normals[i] = Vector2(normal.x*cosine - normal.y*sine, normal.x*sine + normal.y*cosine);
+		}
+
+		cache.bounds.min = cache.bounds.max = cache.vertices[0];
+		for (unsigned i = 1; i < count; i++)
+		{
+			cache.bounds.min.x = std::min(cache.bounds.min.x, cache.vertices[i].x);
+			cache.bounds.min.y = std::min(cache.bounds.min.y, cache.vertices[i].y);
+			cache.bounds.max.x = std::max(cache.bounds.max.x, cache.vertices[i].x);
+			cache.bounds.max.y = std::max(cache.bounds.max.y, cache.vertices[i].y);
+		}
+	}
+
+	//makes the outline from the points (in the polygon's own coordinates, relative to the body's position), then moves
+	//the body to its centroid. Worked out in floats, as it's only done once. Fewer than three points that aren't in a
+	//line give a 1m square, so a bad outline still makes a shape that behaves
+	void Set(const Vector2 *points, const unsigned pointCount)
+	{
+		//the points, without any within a millimetre of one already taken
+		float x[maxPolygonVertices];
+		float y[maxPolygonVertices];
+		unsigned usable = 0;
+
+		for (unsigned i = 0; i < pointCount && usable < maxPolygonVertices; i++)
+		{
+			const float pointX = ToFloat(points[i].x);
+			const float pointY = ToFloat(points[i].y);
+			bool duplicate = false;
+
+			for (unsigned j = 0; j < usable && !duplicate; j++)
+				duplicate = (pointX - x[j])*(pointX - x[j]) + (pointY - y[j])*(pointY - y[j]) < 0.000001f;
+
+			if (!duplicate)
+			{
+				x[usable] = pointX;
+				y[usable] = pointY;
+				usable++;
+			}
+		}
+
+		//gift wrap the hull, starting from the rightmost point (the lowest of those) and taking the point furthest round
+		//each time, which drops any inside the outline or part way along an edge
+		unsigned hull[maxPolygonVertices];
+		count = 0;
+
+		if (usable >= 3)
+		{
+			unsigned first = 0;
+			for (unsigned i = 1; i < usable; i++)
+			{
+				if (x[i] > x[first] || (x[i] == x[first] && y[i] < y[first]))
+					first = i;
+			}
+
+			unsigned current = first;
+			do
+			{
+				hull[count++] = current;
+
+				unsigned next = current == 0 ? 1 : 0;
+				for (unsigned j = 0; j < usable; j++)
+				{
+					if (j == current || j == next)
+						continue;
+
+					const float toNextX = x[next] - x[current], toNextY = y[next] - y[current];
+					const float toPointX = x[j] - x[current], toPointY = y[j] - y[current];
+					const float turn = toNextX*toPointY - toNextY*toPointX;
+
+					if (turn < 0 || (turn == 0 && toPointX*toPointX + toPointY*toPointY > toNextX*toNextX + toNextY*toNextY))
+						next = j;
+				}
+
+				current = next;
+			} while (current != first && count < usable);
+		}
+
+		//centroid, from the triangles fanning out from the first vertex
+		float area = 0, centreX = 0, centreY = 0;
+		for (unsigned i = 1; i + 1 < count; i++)
+		{
+			const float ax = x[hull[i]] - x[hull[0]], ay = y[hull[i]] - y[hull[0]];
+			const float bx = x[hull[i+1]] - x[hull[0]], by = y[hull[i+1]] - y[hull[0]];
+			const float triangle = 0.5f * (ax*by - ay*bx);
+
+			area += triangle;
+			centreX += triangle * (ax + bx) / 3;
+			centreY += triangle * (ay + by) / 3;
+		}
+
+		if (count < 3 || area <= 0.000001f)
+		{
+			const float squareX[4] = {-0.5f, 0.5f, 0.5f, -0.5f};
+			const float squareY[4] = {-0.5f, -0.5f, 0.5f, 0.5f};
+
+			for (unsigned i = 0; i < 4; i++)
+			{
+				x[i] = squareX[i];
+				y[i] = squareY[i];
+				hull[i] = i;
+			}
+
+			count = 4;
+			area = 1;
+			centreX = 0;
+			centreY = 0;
+		}
+		else
+		{
+			centreX = centreX / area + x[hull[0]];
+			centreY = centreY / area + y[hull[0]];
+		}
+
+		for (unsigned i = 0; i < count; i++)
+			localVertices[i] = Vector2(x[hull[i]] - centreX, y[hull[i]] - centreY);
+
+		//moment of inertia about the centroid per unit mass, from the triangles fanning out from it:
+		//I = m * sum(d(a.a + a.b + b.b)) / 6sum(d), with d the cross product of each edge's ends a and b
+		float moment = 0, crosses = 0;
+		for (unsigned i = 0; i < count; i++)
+		{
+			const float ax = x[hull[i]] - centreX, ay = y[hull[i]] - centreY;
+			const float bx = x[hull[(i+1) % count]] - centreX, by = y[hull[(i+1) % count]] - centreY;
+			const float cross = ax*by - ay*bx;
+
+			moment += cross * (ax*ax + ax*bx + bx*bx + ay*ay + ay*by + by*by);
+			crosses += cross;
+
+			//outward normal of the edge from this vertex to the next
+			const float length = sqrt((bx - ax)*(bx - ax) + (by - ay)*(by - ay));
+			localNormals[i] = Vector2((by - ay) / length, -(bx - ax) / length);
+		}
+
+		inertiaPerMass = moment / (6 * crosses);
+		body->inverseMomentOfInertia = 1 / (body->GetMass() * inertiaPerMass);
+
+		Vector2 centroid(centreX, centreY);
+		centroid.RotateAboutWorldOrigin(body->orientation);
+		body->position += centroid;
+	}
+
+	//makes the outline a regular polygon, its first vertex along the polygon's own x axis
+	void SetRegular(const unsigned sides, const Real radius)
+	{
+		const unsigned clamped = std::max(3u, std::min(sides, maxPolygonVertices));
+		Vector2 points[maxPolygonVertices];
+
+		for (unsigned i = 0; i < clamped; i++)
+		{
+			Real sine;
+			Real cosine;
+			SinCos(Real(2*Pi*i / clamped), sine, cosine);
+			points[i] = Vector2(radius*cosine, radius*sine);
+		}
+
+		Set(points, clamped);
+	}
+
+protected:
+	Vector2 localVertices[maxPolygonVertices];	//relative to the centroid
+	Vector2 localNormals[maxPolygonVertices];	//of the edge from each vertex to the next
+	unsigned count;
+	Real inertiaPerMass;
+
+	//GetTypeLayouts counts the members
+	friend class MemberSizes;
+
+public:
+	//provide a position and points relative to it for the outline (only the first maxPolygonVertices are used). The
+	//body is put at the outline's centroid, so it is only at the position if that's where the centroid is
+	Polygon(const Vector2 newPos, const Vector2 *points, const unsigned pointCount):
+		Shape(newPos), count(0), inertiaPerMass(1) { Set(points, pointCount); }
+
+	//as above, turned to the orientation given
+	Polygon(const Vector2 newPos, const Vector2 *points, const unsigned pointCount, const Real newOrientation):
+		Shape(newPos, newOrientation), count(0), inertiaPerMass(1) { Set(points, pointCount); }
+
+	//regular polygon with the number of sides given (3 to maxPolygonVertices), its vertices radius from the centre
+	Polygon(const Vector2 newPos, const unsigned sides, const Real radius, const Real newOrientation):
+		Shape(newPos, newOrientation), count(0), inertiaPerMass(1) { SetRegular(sides, radius); }
+
+	//draws the outline through the vertices where they are now
+	void AddDrawInfo(VertexList &vertexList) const
+	{
+		TRACE_SCOPE("Polygon::AddDrawInfo");
+
+		const PoseCache &pose = GetCache();
+
+		vertexList.BeginStrip();
+
+		Vertex vertex = {MetresToPixels(pose.vertices[0].x), MetresToPixels(pose.vertices[0].y), 0, 1, WHITE};
+		vertexList.Add(vertex);
+
+		//the rest, then the first again to close the outline
+		for (unsigned i = 1; i <= count; i++)
+		{
+			vertex.x = MetresToPixels(pose.vertices[i % count].x);
+			vertex.y = MetresToPixels(pose.vertices[i % count].y);
+			vertexList.Add(vertex);
+		}
+	}
+
+	//accessors
+	ObjectType GetType() const { return POLYGON; }
+	unsigned GetVertexCount() const { return count; }
+	const Vector2* GetLocalVertices() const { return localVertices; }
+	const Vector2* GetLocalNormals() const { return localNormals; }
+
+	//vertices and edge normals for the polygon's position and orientation, GetVertexCount of each
+	const Vector2* GetVertices() const { return GetCache().vertices; }
+	const Vector2* GetNormals() const { return GetCache().normals; }
+
+	//tightest bounds around the vertices
+	const AABB& GetBounds() const { return GetCache().bounds; }
+
+	bool IsTheSameAs(const Polygon &otherPolygon) const
+	{
+		return this->body == otherPolygon.body;
+	}
+};
+
+
 //SHAPEH
 #endif 
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+// Buffers //
+//one per thread that has ever recorded anything. They are never freed, so events from threads that have finished
+//can still be written out
+struct TraceBuffer
+{
+	std::vector<TraceEvent> events;
+	unsigned next;		//where the next event goes
+	uint64_t count;		//events ever recorded, including ones since overwritten
+	unsigned thread;	//number given to the thread in the trace
+};
+
+static std::mutex buffersMutex;
+static std::vector<TraceBuffer*> buffers;
+static thread_local TraceBuffer *threadBuffer = NULL;
+
+typedef std::chrono::steady_clock Clock;
+static const Clock::time_point traceStart = Clock::now();
+
+std::atomic<bool> tracingEnabled(false);
+
+static TraceBuffer* GetThreadBuffer()
+{
+	if (!threadBuffer)
+	{
+		TraceBuffer *buffer = new TraceBuffer();
+		buffer->events.resize(traceBufferSize);
+		buffer->next = 0;
+		buffer->count = 0;
+
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		buffer->thread = buffers.size();
+		buffers.push_back(buffer);
+		threadBuffer = buffer;
+	}
+
+	return threadBuffer;
+}
+
+// Control //
+void SetTracing( const bool enabled )
+{
+	tracingEnabled.store(enabled);
+}
+
+void ClearTrace()
+{
+	std::lock_guard<std::mutex> lock(buffersMutex);
+
+	for (unsigned i = 0; i < buffers.size(); i++)
+	{
+		buffers[i]->next = 0;
+		buffers[i]->count = 0;
+	}
+}
+
+bool WriteTrace( const std::string &filename )
+{
+	FILE *file = fopen(filename.c_str(), "w");
+	if (!file)
+		return false;
+
+	std::lock_guard<std::mutex> lock(buffersMutex);
+
+	fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	bool first = true;
+
+	for (unsigned i = 0; i < buffers.size(); i++)
+	{
+		const TraceBuffer &buffer = *buffers[i];
+
+		//name the thread so the viewer shows something better than a number
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+			first ? "" : ",\n", buffer.thread, buffer.thread == 0 ? "main" : "thread", buffer.thread);
+		first = false;
+
+		//oldest first - once the buffer has wrapped around, that's the one about to be overwritten
+		const unsigned count = (unsigned)std::min<uint64_t>(buffer.count, traceBufferSize);
+		const unsigned oldest = buffer.count > traceBufferSize ? buffer.next : 0;
+
+		for (unsigned e = 0; e < count; e++)
+		{
+			const TraceEvent &event = buffer.events[(oldest + e) % traceBufferSize];
+
+			//Chrome wants microseconds
+			fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				event.name, buffer.thread, event.start / 1000.0, event.duration / 1000.0);
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+
+	return fclose(file) == 0;
+}
+
+// Scopes //
+int64_t TraceTime()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - traceStart).count();
+}
+
+void RecordTraceEvent( const char *name, const int64_t start, const int64_t end )
+{
+	TraceBuffer &buffer = *GetThreadBuffer();
+
+	TraceEvent &event = buffer.events[buffer.next];
+	event.name = name;
+	event.start = start;
+	event.duration = end - start;
+
+	buffer.next = (buffer.next + 1) % traceBufferSize;
+	buffer.count++;
+}
@@ -0,0 +1,72 @@
+#ifndef TRACEH
+#define TRACEH
+
+// Includes //
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+// Tracing //
+//TRACE_SCOPE("name") times from where it is to the end of the enclosing block. Each thread records into its own
+//ring buffer (the oldest events are overwritten once it is full), and WriteTrace saves everything recorded as Chrome
+//trace JSON, which chrome://tracing and ui.perfetto.dev can both open.
+//
+//Scopes are only compiled in when PHYSICS_TRACING is defined; otherwise TRACE_SCOPE is nothing at all. When they are
+//compiled in, they still do nothing but check a flag until SetTracing(true) is called. Names have to be string
+//literals (or anything else that lives forever), as only the pointer is kept.
+
+//one timed scope
+struct TraceEvent
+{
+	const char *name;
+	int64_t start;		//nanoseconds since tracing began
+	int64_t duration;	//nanoseconds
+};
+
+//number of events each thread keeps
+const unsigned traceBufferSize = 1 << 16;
+
+// Control
+extern std::atomic<bool> tracingEnabled;
+
+void SetTracing(const bool enabled);
+inline bool IsTracing() { return tracingEnabled.load(std::memory_order_relaxed); }
+
+//throws away everything recorded so far
+void ClearTrace();
+
+//writes every thread's events to a Chrome trace JSON file. Only call while nothing is being traced
+bool WriteTrace(const std::string &filename);
+
+// Scopes //
+//records the event into the calling thread's buffer
+void RecordTraceEvent(const char *name, const int64_t start, const int64_t end);
+
+//nanoseconds since tracing began
+int64_t TraceTime();
+
+class TraceScope
+{
+private:
+	const char *name;
+	int64_t start;
+
+public:
+	TraceScope(const char *newName): name(newName), start(IsTracing() ? TraceTime() : -1) {}
+	~TraceScope()
+	{
+		if (start >= 0)
+			RecordTraceEvent(name, start, TraceTime());
+	}
+};
+
+#define TRACE_CONCATENATE_(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_(a, b)
+
+#ifdef PHYSICS_TRACING
+	#define TRACE_SCOPE(name) TraceScope TRACE_CONCATENATE(traceScope, __LINE__)(name)
+#else
+	#define TRACE_SCOPE(name)
+#endif
+
+#endif //TRACEH
@@ -0,0 +1,327 @@
+#include "trajectory.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+// Constants //
+const unsigned noShape = 0xffffffff;	//shape number for the missing body in a halfspace contact
+const char fileMagic[8] = {'P', 'H', 'Y', 'S', 'T', 'R', 'A', 'J'};
+const uint32_t fileVersion = 1;
+
+#ifdef PHYSICS_FIXED_POINT
+const uint32_t realKind = 1;
+#else
+const uint32_t realKind = 0;
+#endif
+
+// Recording //
+void Trajectory::Record( World &world )
+{
+	ObjectList &objects = world.GetObjects();
+	const unsigned shapeCount = objects.FiniteSize();
+
+	frames.push_back(TrajectoryFrame());
+	TrajectoryFrame &frame = frames.back();
+
+	//bodies, numbering them as they go so contacts can be written in terms of shapes
+	std::map<const Body*, unsigned> shapeNumbers;
+	frame.bodies.resize(shapeCount);
+
+	for (unsigned i = 0; i < shapeCount; i++)
+	{
+		const Shape &shape = objects.GetShapeAt(i);
+
+		BodyState &state = frame.bodies[i];
+		state.position = shape.GetPosition();
+		state.velocity = shape.GetVelocity();
+		state.orientation = shape.GetOrientation();
+		state.rotation = shape.GetRotation();
+
+		shapeNumbers[shape.GetBody()] = i;
+	}
+
+	const std::vector<Contact> &contacts = world.GetContacts();
+	frame.contacts.resize(contacts.size());
+
+	for (unsigned i = 0; i < contacts.size(); i++)
+	{
+		ContactState &state = frame.contacts[i];
+
+		for (unsigned b = 0; b < 2; b++)
+		{
+			std::map<const Body*, unsigned>::const_iterator found = shapeNumbers.find(contacts[i].GetBody(b));
+			state.shapes[b] = found != shapeNumbers.end() ? found->second : noShape;
+		}
+
+		state.point = contacts[i].GetContactPoint();
+		state.normal = contacts[i].GetContactNormal();
+		state.penetration = contacts[i].GetPenetration();
+	}
+}
+
+void Trajectory::Restore( World &world, const unsigned frame ) const
+{
+	ObjectList &objects = world.GetObjects();
+	const std::vector<BodyState> &bodies = frames[frame].bodies;
+
+	for (unsigned i = 0; i < bodies.size() && i < objects.FiniteSize(); i++)
+	{
+		Shape &shape = objects.GetShapeAt(i);
+
+		shape.SetPosition(bodies[i].position);
+		shape.SetVelocity(bodies[i].velocity.x, bodies[i].velocity.y);
+		shape.SetOrientation(bodies[i].orientation);
+		shape.SetRotation(bodies[i].rotation);
+	}
+}
+
+// Files //
+bool Trajectory::Save( const std::string &filename ) const
+{
+	FILE *file = fopen(filename.c_str(), "wb");
+	if (!file)
+		return false;
+
+	uint32_t header[3] = {fileVersion, realKind, (uint32_t)frames.size()};
+	bool written = fwrite(fileMagic, sizeof(fileMagic), 1, file) == 1 && fwrite(header, sizeof(header), 1, file) == 1;
+
+	for (unsigned i = 0; i < frames.size() && written; i++)
+	{
+		const TrajectoryFrame &frame = frames[i];
+		uint32_t counts[2] = {(uint32_t)frame.bodies.size(), (uint32_t)frame.contacts.size()};
+
+		written = fwrite(counts, sizeof(counts), 1, file) == 1;
+
+		if (written && !frame.bodies.empty())
+			written = fwrite(&frame.bodies[0], sizeof(BodyState), frame.bodies.size(), file) == frame.bodies.size();
+
+		if (written && !frame.contacts.empty())
+			written = fwrite(&frame.contacts[0], sizeof(ContactState), frame.contacts.size(), file) == frame.contacts.size();
+	}
+
+	return fclose(file) == 0 && written;
+}
+
+bool Trajectory::Load( const std::string &filename )
+{
+	frames.clear();
+
+	FILE *file = fopen(filename.c_str(), "rb");
+	if (!file)
+		return false;
+
+	char magic[8];
+	uint32_t header[3];
+	bool read = fread(magic, sizeof(magic), 1, file) == 1 && fread(header, sizeof(header), 1, file) == 1;
+
+	//has to be a trajectory, written by a build using the same Real
+	read = read && memcmp(magic, fileMagic, sizeof(magic)) == 0 && header[0] == fileVersion && header[1] == realKind;
+
+	if (read)
+		frames.resize(header[2]);
+
+	for (unsigned i = 0; i < frames.size() && read; i++)
+	{
+		TrajectoryFrame &frame = frames[i];
+		uint32_t counts[2];
+
+		read = fread(counts, sizeof(counts), 1, file) == 1;
+		if (!read)
+			break;
+
+		frame.bodies.resize(counts[0]);
+		frame.contacts.resize(counts[1]);
+
+		if (!frame.bodies.empty())
+			read = fread(&frame.bodies[0], sizeof(BodyState), frame.bodies.size(), file) == frame.bodies.size();
+
+		if (read && !frame.contacts.empty())
+			read = fread(&frame.contacts[0], sizeof(ContactState), frame.contacts.size(), file) == frame.contacts.size();
+	}
+
+	fclose(file);
+
+	if (!read)
+		frames.clear();
+
+	return read;
+}
+
+// Comparison //
+static float Difference( const Vector2 a, const Vector2 b )
+{
+	return ToFloat((a - b).Magnitude());
+}
+
+//smallest angle between two orientations, allowing for one being just under 360 and the other just over 0
+static float AngleDifference( const Real a, const Real b )
+{
+	float difference = fabs(ToFloat(a) - ToFloat(b));
+	return difference > 180 ? 360 - difference : difference;
+}
+
+//records the first thing found wrong, returning false so callers can mark the frame bad
+static bool Fail( TrajectoryComparison &result, const unsigned frame, const std::string &reason )
+{
+	if (result.firstBadFrame < 0)
+	{
+		result.firstBadFrame = frame;
+		result.reason = reason;
+	}
+	return false;
+}
+
+//returns false if anything in the frame is different at all
+static bool CompareExactly( const TrajectoryFrame &reference, const TrajectoryFrame &candidate, const unsigned frame, TrajectoryComparison &result )
+{
+	for (unsigned i = 0; i < reference.bodies.size(); i++)
+	{
+		if (memcmp(&reference.bodies[i], &candidate.bodies[i], sizeof(BodyState)) != 0)
+			return Fail(result, frame, "body " + ToString((float)i) + " differs");
+	}
+
+	if (reference.contacts.size() != candidate.contacts.size())
+	{
+		result.contactMismatches++;
+		return Fail(result, frame, "contact count " + ToString((float)candidate.contacts.size()) + ", expected " + ToString((float)reference.contacts.size()));
+	}
+
+	for (unsigned i = 0; i < reference.contacts.size(); i++)
+	{
+		if (memcmp(&reference.contacts[i], &candidate.contacts[i], sizeof(ContactState)) != 0)
+			return Fail(result, frame, "contact " + ToString((float)i) + " differs");
+	}
+
+	return true;
+}
+
+//orders contacts by their pair of shapes, keeping generation order for contacts on the same pair
+static bool ContactOrder( const ContactState *a, const ContactState *b )
+{
+	if (a->shapes[0] != b->shapes[0])
+		return a->shapes[0] < b->shapes[0];
+	return a->shapes[1] < b->shapes[1];
+}
+
+//returns false if anything in the frame is out of tolerance
+static bool CompareWithTolerance( const TrajectoryFrame &reference, const TrajectoryFrame &candidate, const unsigned frame, const TrajectoryTolerance &tolerance, TrajectoryComparison &result )
+{
+	bool good = true;
+
+	// Bodies
+	for (unsigned i = 0; i < reference.bodies.size(); i++)
+	{
+		const BodyState &a = reference.bodies[i];
+		const BodyState &b = candidate.bodies[i];
+
+		float position = Difference(a.position, b.position);
+		float velocity = Difference(a.velocity, b.velocity);
+		float orientation = std::max(AngleDifference(a.orientation, b.orientation), (float)fabs(ToFloat(a.rotation - b.rotation)));
+
+		result.positionError = std::max(result.positionError, position);
+		result.velocityError = std::max(result.velocityError, velocity);
+		result.orientationError = std::max(result.orientationError, orientation);
+
+		if (position > ToFloat(tolerance.position) || velocity > ToFloat(tolerance.velocity) || orientation > ToFloat(tolerance.orientation))
+			good = Fail(result, frame, "body " + ToString((float)i) + " out of tolerance");
+	}
+
+	// Contacts
+	//sort both lists by pair, then walk them together like a merge
+	std::vector<const ContactState*> ours, theirs;
+	for (unsigned i = 0; i < reference.contacts.size(); i++)
+		ours.push_back(&reference.contacts[i]);
+	for (unsigned i = 0; i < candidate.contacts.size(); i++)
+		theirs.push_back(&candidate.contacts[i]);
+
+	std::stable_sort(ours.begin(), ours.end(), ContactOrder);
+	std::stable_sort(theirs.begin(), theirs.end(), ContactOrder);
+
+	unsigned i = 0, j = 0, mismatches = 0;
+	while (i < ours.size() || j < theirs.size())
+	{
+		if (j == theirs.size() || (i < ours.size() && ContactOrder(ours[i], theirs[j])))
+		{
+			mismatches++;
+			i++;
+		}
+		else if (i == ours.size() || ContactOrder(theirs[j], ours[i]))
+		{
+			mismatches++;
+			j++;
+		}
+		else
+		{
+			float point = std::max(Difference(ours[i]->point, theirs[j]->point), (float)fabs(ToFloat(ours[i]->penetration - theirs[j]->penetration)));
+			float normal = Difference(ours[i]->normal, theirs[j]->normal);
+
+			result.positionError = std::max(result.positionError, point);
+			result.normalError = std::max(result.normalError, normal);
+
+			if (point > ToFloat(tolerance.position) || normal > ToFloat(tolerance.normal))
+				good = Fail(result, frame, "contact between shapes " + ToString((float)ours[i]->shapes[0]) + " and " + ToString((float)ours[i]->shapes[1]) + " out of tolerance");
+
+			i++;
+			j++;
+		}
+	}
+
+	if (mismatches > 0)
+	{
+		result.contactMismatches += mismatches;
+		good = Fail(result, frame, ToString((float)mismatches) + " contacts only in one run");
+	}
+
+	return good;
+}
+
+TrajectoryComparison CompareTrajectories( const Trajectory &reference, const Trajectory &candidate, const TrajectoryTolerance &tolerance )
+{
+	TrajectoryComparison result;
+	result.matches = true;
+	result.firstBadFrame = -1;
+	result.positionError = 0;
+	result.velocityError = 0;
+	result.orientationError = 0;
+	result.normalError = 0;
+	result.contactMismatches = 0;
+	result.badFrames = 0;
+
+	if (reference.FrameCount() != candidate.FrameCount())
+	{
+		result.matches = Fail(result, 0, "frame count " + ToString((float)candidate.FrameCount()) + ", expected " + ToString((float)reference.FrameCount()));
+		return result;
+	}
+
+	for (unsigned frame = 0; frame < reference.FrameCount(); frame++)
+	{
+		const TrajectoryFrame &a = reference.GetFrame(frame);
+		const TrajectoryFrame &b = candidate.GetFrame(frame);
+
+		if (a.bodies.size() != b.bodies.size())
+		{
+			result.matches = Fail(result, frame, "body count " + ToString((float)b.bodies.size()) + ", expected " + ToString((float)a.bodies.size()));
+			return result;
+		}
+
+		if (tolerance.exact)
+		{
+			//past the first difference an exact run can only repeat the same failure
+			if (!CompareExactly(a, b, frame, result))
+			{
+				result.matches = false;
+				result.badFrames = 1;
+				return result;
+			}
+		}
+		else if (!CompareWithTolerance(a, b, frame, tolerance, result))
+		{
+			result.badFrames++;
+		}
+	}
+
+	result.matches = result.badFrames <= tolerance.badFrames && result.contactMismatches <= tolerance.contactMismatches;
+	return result;
+}
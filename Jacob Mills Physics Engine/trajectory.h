@@ -0,0 +1,98 @@
+#ifndef TRAJECTORYH
+#define TRAJECTORYH
+
+// Includes //
+#include <string>
+
+#include "core.h"
+#include "vector2.h"
+#include "world.h"
+
+// States //
+//everything about a body that stepping changes
+struct BodyState
+{
+	Vector2 position;
+	Vector2 velocity;
+	Real orientation;
+	Real rotation;
+};
+
+//a contact, with its bodies given as shape numbers in the world (boxes, then circles, then polygons, then halfspaces)
+struct ContactState
+{
+	unsigned shapes[2];
+	Vector2 point;
+	Vector2 normal;
+	Real penetration;
+};
+
+struct TrajectoryFrame
+{
+	std::vector<BodyState> bodies;		//boxes, circles then polygons, in the order they were added
+	std::vector<ContactState> contacts;	//in the order they were generated
+};
+
+// Trajectory //
+//the state of a world after every step, so a run can be saved and any other run of the same scene checked against it
+class Trajectory
+{
+public:
+	void Clear() { frames.clear(); }
+
+	//adds a frame holding the world's bodies and contacts as they are now (call after each step)
+	void Record(World &world);
+
+	//binary file of every frame. Load fails on files written by a build with a different Real
+	bool Save(const std::string &filename) const;
+	bool Load(const std::string &filename);
+
+	//puts the world's bodies back how they were in a frame, so a run can be restarted from any point of another
+	void Restore(World &world, const unsigned frame) const;
+
+	unsigned FrameCount() const { return frames.size(); }
+	const TrajectoryFrame& GetFrame(const unsigned index) const { return frames[index]; }
+
+private:
+	std::vector<TrajectoryFrame> frames;
+};
+
+// Comparison //
+struct TrajectoryTolerance
+{
+	//every body and contact has to be identical to the last bit, and contacts in the same order
+	bool exact;
+
+	//largest differences allowed otherwise. Contacts are matched up by the pair of shapes, in any order
+	Real position;		//metres, for body positions and contact points
+	Real velocity;		//metres per second
+	Real orientation;	//degrees, for orientation and rotation
+	Real normal;		//difference between contact normals (unit vectors)
+	unsigned contactMismatches;	//contacts in one run but not the other, over the whole run
+
+	//frames allowed to be out of tolerance, for near ties that rounding can tip either way - like two faces of a box
+	//overlapping by the same amount, where picking the other one gives a completely different normal
+	unsigned badFrames;
+
+	TrajectoryTolerance(): exact(true), position(0), velocity(0), orientation(0), normal(0), contactMismatches(0), badFrames(0) {}
+};
+
+struct TrajectoryComparison
+{
+	bool matches;
+	int firstBadFrame;		//-1 if every frame matched
+	std::string reason;		//what was wrong at firstBadFrame
+	unsigned badFrames;		//frames with anything out of tolerance
+
+	//largest differences seen over the run
+	float positionError;
+	float velocityError;
+	float orientationError;
+	float normalError;
+	unsigned contactMismatches;
+};
+
+//checks candidate against reference frame by frame
+TrajectoryComparison CompareTrajectories(const Trajectory &reference, const Trajectory &candidate, const TrajectoryTolerance &tolerance);
+
+#endif //TRAJECTORYH
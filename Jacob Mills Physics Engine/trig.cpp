@@ -0,0 +1,40 @@
+#include "trig.h"
+
+//build setting picks the starting mode, can be changed at runtime afterwards
+#ifdef PHYSICS_FAST_TRIG
+TrigMode trigMode = FAST_TRIG;
+#else
+TrigMode trigMode = PRECISE_TRIG;
+#endif
+
+void SetTrigMode(const TrigMode mode)
+{
+	trigMode = mode;
+}
+
+//sine and cosine for a whole array of angles, four at a time in fast mode
+void SinCosN(const float radians[], float sines[], float cosines[], const unsigned count)
+{
+	unsigned i = 0;
+
+	if (trigMode == FAST_TRIG)
+	{
+		for (; i + 4 <= count; i += 4)
+		{
+			FastSinCos4(radians + i, sines + i, cosines + i);
+		}
+
+		//leftovers
+		for (; i < count; i++)
+		{
+			FastSinCos(radians[i], sines[i], cosines[i]);
+		}
+	}
+	else
+	{
+		for (; i < count; i++)
+		{
+			PreciseSinCos(radians[i], sines[i], cosines[i]);
+		}
+	}
+}
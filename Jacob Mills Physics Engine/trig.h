@@ -0,0 +1,130 @@
+#ifndef TRIGH
+#define TRIGH
+
+#include "core.h"
+
+// SSE2 is used for the four-wide versions where the compiler has it available (always the case on x64)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define TRIG_SSE2
+	#include <emmintrin.h>
+#endif
+
+// Trigonometry //
+// Sine and cosine used by every rotation in the engine. Can either go through the C library (precise)
+// or through a polynomial approximation (fast), chosen at runtime with SetTrigMode. Defining
+// PHYSICS_FAST_TRIG at build time makes the fast version the default.
+//
+// Fast version: angle is reduced to [-Pi/4, Pi/4] around the nearest multiple of Pi/2 (Cody-Waite,
+// three part Pi/2), then minimax polynomials are used for sine and cosine (coefficients from Cephes sinf/cosf).
+// Maximum absolute error against double precision sin/cos is 1e-7 (9.4e-8 measured) for |radians| <= 8192, which covers
+// every angle the engine produces (orientations are kept within 0-360 degrees). Error grows past that,
+// as the range reduction loses bits.
+
+enum TrigMode{PRECISE_TRIG, FAST_TRIG};
+
+//currently selected mode - use SetTrigMode and GetTrigMode rather than this directly
+extern TrigMode trigMode;
+
+void SetTrigMode(const TrigMode mode);
+inline TrigMode GetTrigMode() { return trigMode; }
+
+//sine and cosine of an angle in radians, through the polynomial approximation
+inline void FastSinCos(const float radians, float &sine, float &cosine)
+{
+	//find nearest multiple of Pi/2 (rounding half away from zero, same as the SSE2 version)
+	float scaled = radians * 0.63661977236758134f;
+	int quadrant = (int)(scaled + (scaled < 0 ? -0.5f : 0.5f));
+	float q = (float)quadrant;
+
+	//reduced angle, subtracting Pi/2 in three parts to keep the bits
+	float r = ((radians - q*1.5703125f) - q*4.837512969970703125e-4f) - q*7.54978995489188216e-8f;
+	float r2 = r*r;
+
+	float s = r + r*r2*(-1.6666654611e-1f + r2*(8.3321608736e-3f + r2*-1.9515295891e-4f));
+	float c = 1.0f - 0.5f*r2 + r2*r2*(4.166664568298827e-2f + r2*(-1.388731625493765e-3f + r2*2.443315711809948e-5f));
+
+	//odd quadrants swap sine and cosine, then fix signs for the quadrant
+	if (quadrant & 1)
+	{
+		float temp = s;
+		s = c;
+		c = temp;
+	}
+
+	sine = (quadrant & 2) ? -s : s;
+	cosine = ((quadrant+1) & 2) ? -c : c;
+}
+
+//sine and cosine of an angle in radians, through the C library
+inline void PreciseSinCos(const float radians, float &sine, float &cosine)
+{
+	sine = sin(radians);
+	cosine = cos(radians);
+}
+
+//sine and cosine of an angle in radians, using whichever version is selected
+inline void SinCos(const float radians, float &sine, float &cosine)
+{
+	if (GetTrigMode() == FAST_TRIG)
+		FastSinCos(radians, sine, cosine);
+	else
+		PreciseSinCos(radians, sine, cosine);
+}
+
+//four angles at once through the polynomial approximation - results match FastSinCos exactly
+inline void FastSinCos4(const float radians[4], float sines[4], float cosines[4])
+{
+#ifdef TRIG_SSE2
+	const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+
+	__m128 x = _mm_loadu_ps(radians);
+
+	//nearest multiple of Pi/2, rounding half away from zero
+	__m128 scaled = _mm_mul_ps(x, _mm_set1_ps(0.63661977236758134f));
+	__m128 half = _mm_or_ps(_mm_and_ps(scaled, signMask), _mm_set1_ps(0.5f));
+	__m128i quadrant = _mm_cvttps_epi32(_mm_add_ps(scaled, half));
+	__m128 q = _mm_cvtepi32_ps(quadrant);
+
+	//reduced angle
+	__m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(1.5703125f)));
+	r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(4.837512969970703125e-4f)));
+	r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(7.54978995489188216e-8f)));
+	__m128 r2 = _mm_mul_ps(r, r);
+
+	//sine polynomial
+	__m128 s = _mm_add_ps(_mm_set1_ps(8.3321608736e-3f), _mm_mul_ps(r2, _mm_set1_ps(-1.9515295891e-4f)));
+	s = _mm_add_ps(_mm_set1_ps(-1.6666654611e-1f), _mm_mul_ps(r2, s));
+	s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), s));
+
+	//cosine polynomial
+	__m128 c = _mm_add_ps(_mm_set1_ps(-1.388731625493765e-3f), _mm_mul_ps(r2, _mm_set1_ps(2.443315711809948e-5f)));
+	c = _mm_add_ps(_mm_set1_ps(4.166664568298827e-2f), _mm_mul_ps(r2, c));
+	c = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_mul_ps(_mm_mul_ps(r2, r2), c));
+
+	//swap for odd quadrants
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128i two = _mm_set1_epi32(2);
+	__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+	__m128 sine = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+	__m128 cosine = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+
+	//sign fixes: bit 1 of quadrant flips sine, bit 1 of quadrant+1 flips cosine
+	__m128i sineSign = _mm_slli_epi32(_mm_and_si128(quadrant, two), 30);
+	__m128i cosineSign = _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30);
+	sine = _mm_xor_ps(sine, _mm_castsi128_ps(sineSign));
+	cosine = _mm_xor_ps(cosine, _mm_castsi128_ps(cosineSign));
+
+	_mm_storeu_ps(sines, sine);
+	_mm_storeu_ps(cosines, cosine);
+#else
+	for (int i = 0; i < 4; i++)
+	{
+		FastSinCos(radians[i], sines[i], cosines[i]);
+	}
+#endif
+}
+
+//sine and cosine for a whole array of angles, using whichever version is selected
+void SinCosN(const float radians[], float sines[], float cosines[], const unsigned count);
+
+#endif //TRIGH
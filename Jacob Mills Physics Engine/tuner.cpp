@@ -0,0 +1,277 @@
+#include "tuner.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// Tuned Settings //
+void TunedSettings::Apply( WorldSettings &settings ) const
+{
+	settings.broadphase = broadphase;
+	settings.cellSize = cellSize;
+	settings.aabbMargin = aabbMargin;
+	settings.threads = threads;
+}
+
+// Bodies //
+//every box, circle and polygon's body, so each candidate starts from the same scene (halfspaces never move)
+static void SaveBodies( World &world, std::vector<Body> &bodies )
+{
+	ObjectList &objects = world.GetObjects();
+	bodies.clear();
+
+	for (unsigned i = 0; i < objects.BoxesSize(); i++)
+		bodies.push_back(*objects.GetBoxAt(i).GetBody());
+	for (unsigned i = 0; i < objects.CirclesSize(); i++)
+		bodies.push_back(*objects.GetCircleAt(i).GetBody());
+	for (unsigned i = 0; i < objects.PolygonsSize(); i++)
+		bodies.push_back(*objects.GetPolygonAt(i).GetBody());
+}
+
+static void RestoreBodies( World &world, const std::vector<Body> &bodies )
+{
+	ObjectList &objects = world.GetObjects();
+	const unsigned boxCount = objects.BoxesSize();
+	const unsigned circleEnd = boxCount + objects.CirclesSize();
+
+	for (unsigned i = 0; i < boxCount; i++)
+		*objects.GetBoxAt(i).GetBody() = bodies[i];
+	for (unsigned i = 0; i < objects.CirclesSize(); i++)
+		*objects.GetCircleAt(i).GetBody() = bodies[boxCount + i];
+	for (unsigned i = 0; i < objects.PolygonsSize(); i++)
+		*objects.GetPolygonAt(i).GetBody() = bodies[circleEnd + i];
+}
+
+// Tuning //
+//the tuner's state while it works through the candidates
+struct Tuning
+{
+	World &world;
+	const TuneOptions &options;
+	std::vector<Body> start;
+	std::vector<double> stepTimes;
+
+	WorldSettings best;
+	double bestTime;
+	unsigned candidates;
+
+	Tuning(World &newWorld, const TuneOptions &newOptions): world(newWorld), options(newOptions), bestTime(0), candidates(0) {}
+
+	//median step time of the scene with these settings, in ms
+	double Time( const WorldSettings &settings )
+	{
+		world.SetSettings(settings);
+		RestoreBodies(world, start);
+		candidates++;
+
+		for (unsigned i = 0; i < options.warmup; i++)
+		{
+			world.Step(options.duration);
+		}
+
+		stepTimes.clear();
+		for (unsigned i = 0; i < std::max(options.steps, 1u); i++)
+		{
+			world.Step(options.duration);
+			stepTimes.push_back(world.GetStepTimes().total);
+		}
+
+		std::nth_element(stepTimes.begin(), stepTimes.begin() + stepTimes.size()/2, stepTimes.end());
+		return stepTimes[stepTimes.size()/2];
+	}
+
+	//keeps the settings if they beat the best so far
+	void Try( const WorldSettings &settings )
+	{
+		const double time = Time(settings);
+
+		if (time < bestTime)
+		{
+			best = settings;
+			bestTime = time;
+		}
+	}
+};
+
+TunedSettings TuneWorld( World &world, const TuneOptions &options )
+{
+	const WorldSettings original = world.GetSettings();
+	const unsigned shapeCount = world.GetObjects().FiniteSize();
+
+	Tuning tuning(world, options);
+	SaveBodies(world, tuning.start);
+
+	World::History history;
+	world.SaveHistory(history);
+
+	tuning.stepTimes.reserve(std::max(options.steps, 1u));
+
+	//the world's own settings are the ones to beat
+	tuning.best = original;
+	tuning.bestTime = tuning.Time(original);
+	const double startingTime = tuning.bestTime;
+
+	// Threads
+	//on the grid with its own cell size, doubling up to the most threads allowed
+	unsigned maxThreads = options.maxThreads > 0 ? options.maxThreads : ThreadPool::HardwareThreads();
+	maxThreads = std::max(maxThreads, 1u);
+
+	WorldSettings candidate = original;
+	candidate.broadphase = UNIFORM_GRID;
+	candidate.cellSize = 0;
+
+	float gridCellSize = 0;
+
+	for (unsigned threads = 1; ; threads = std::min(threads*2, maxThreads))
+	{
+		candidate.threads = threads;
+		tuning.Try(candidate);
+		gridCellSize = world.GetCellSize();
+
+		if (threads == maxThreads)
+			break;
+	}
+
+	// Cell Size
+	//multiples of the grid's own choice - smaller cells mean fewer pairs per cell but more cells per shape
+	static const float cellFactors[] = {0.5f, 0.75f, 1.5f, 2.0f, 3.0f};
+
+	if (tuning.best.broadphase == UNIFORM_GRID && gridCellSize > 0)
+	{
+		candidate = tuning.best;
+
+		for (unsigned i = 0; i < sizeof(cellFactors)/sizeof(cellFactors[0]); i++)
+		{
+			candidate.cellSize = gridCellSize * cellFactors[i];
+			tuning.Try(candidate);
+		}
+	}
+
+	// Margin
+	//fatter boxes turn up more pairs that don't touch. It never goes to 0, which would leave no room for rounding in the
+	//bounds and could lose pairs that only just touch
+	static const float marginFactors[] = {0.5f, 2.0f, 5.0f};
+	const float baseMargin = original.aabbMargin > 0 ? ToFloat(original.aabbMargin) : 0.01f;
+
+	candidate = tuning.best;
+	for (unsigned i = 0; i < sizeof(marginFactors)/sizeof(marginFactors[0]); i++)
+	{
+		candidate.aabbMargin = baseMargin * marginFactors[i];
+		if (candidate.aabbMargin != tuning.best.aabbMargin)
+			tuning.Try(candidate);
+	}
+
+	// Brute Force
+	//only ever runs on one thread
+	if (shapeCount <= options.bruteForceLimit)
+	{
+		candidate = tuning.best;
+		candidate.broadphase = BRUTE_FORCE;
+		candidate.cellSize = 0;
+		candidate.threads = 1;
+		tuning.Try(candidate);
+	}
+
+	//leave the world as it was found - its bodies, and everything the last step left for the next one (the contacts,
+	//pairs and events it is compared with, the caches and the health reading), along with its settings
+	RestoreBodies(world, tuning.start);
+	world.RestoreHistory(history);
+
+	TunedSettings tuned;
+	tuned.broadphase = tuning.best.broadphase;
+	tuned.cellSize = tuning.best.cellSize;
+	tuned.aabbMargin = tuning.best.aabbMargin;
+	tuned.threads = tuning.best.threads;
+	tuned.stepTime = tuning.bestTime;
+	tuned.startingStepTime = startingTime;
+	tuned.candidates = tuning.candidates;
+	return tuned;
+}
+
+// Tune Profiles //
+bool TuneProfiles::Load( const std::string &filename )
+{
+	FILE *file = fopen(filename.c_str(), "r");
+	if (!file)
+		return false;
+
+	char line[512];
+
+	while (fgets(line, sizeof(line), file))
+	{
+		char name[256], broadphase[16];
+		float cellSize, margin;
+		unsigned threads;
+		double stepTime;
+
+		if (sscanf(line, "%255s broadphase=%15s cell=%f margin=%f threads=%u ms=%lf", name, broadphase, &cellSize, &margin, &threads, &stepTime) != 6)
+			continue;
+
+		TunedSettings tuned;
+		if (strcmp(broadphase, "grid") == 0)
+			tuned.broadphase = UNIFORM_GRID;
+		else if (strcmp(broadphase, "brute") == 0)
+			tuned.broadphase = BRUTE_FORCE;
+		else
+			continue;
+
+		tuned.cellSize = cellSize;
+		tuned.aabbMargin = margin;
+		tuned.threads = std::max(threads, 1u);
+		tuned.stepTime = stepTime;
+		profiles[name] = tuned;
+	}
+
+	fclose(file);
+	return true;
+}
+
+bool TuneProfiles::Save( const std::string &filename ) const
+{
+	FILE *file = fopen(filename.c_str(), "w");
+	if (!file)
+		return false;
+
+	for (std::map<std::string, TunedSettings>::const_iterator i = profiles.begin(); i != profiles.end(); ++i)
+	{
+		const TunedSettings &tuned = i->second;
+		fprintf(file, "%s broadphase=%s cell=%g margin=%g threads=%u ms=%g\n", i->first.c_str(), tuned.broadphase == BRUTE_FORCE ? "brute" : "grid",
+			ToFloat(tuned.cellSize), ToFloat(tuned.aabbMargin), tuned.threads, tuned.stepTime);
+	}
+
+	const bool written = ferror(file) == 0;
+	return fclose(file) == 0 && written;
+}
+
+bool TuneProfiles::Find( const std::string &profile, TunedSettings &tuned ) const
+{
+	std::map<std::string, TunedSettings>::const_iterator found = profiles.find(profile);
+	if (found == profiles.end())
+		return false;
+
+	tuned = found->second;
+	return true;
+}
+
+void TuneProfiles::Set( const std::string &profile, const TunedSettings &tuned )
+{
+	profiles[profile] = tuned;
+}
+
+bool ApplyTunedSettings( World &world, TuneProfiles &profiles, const std::string &profile, const TuneOptions &options )
+{
+	TunedSettings tuned;
+	const bool found = profiles.Find(profile, tuned);
+
+	if (!found)
+	{
+		tuned = TuneWorld(world, options);
+		profiles.Set(profile, tuned);
+	}
+
+	WorldSettings settings = world.GetSettings();
+	tuned.Apply(settings);
+	world.SetSettings(settings);
+
+	return !found;
+}
@@ -0,0 +1,77 @@
+#ifndef TUNERH
+#define TUNERH
+
+// Includes //
+#include <map>
+#include <string>
+
+#include "world.h"
+
+// Tune Options //
+struct TuneOptions
+{
+	unsigned steps;				//steps timed for each candidate - the median is what counts
+	unsigned warmup;			//steps taken first so buffers and caches settle
+	Real duration;				//seconds per step
+	unsigned maxThreads;		//most threads tried, 0 for every hardware thread
+	unsigned bruteForceLimit;	//brute force is only tried with this many shapes or fewer, as it grows with n^2
+
+	TuneOptions(): steps(15), warmup(2), duration(1.0f/60), maxThreads(0), bruteForceLimit(300) {}
+};
+
+// Tuned Settings //
+//the settings the tuner chooses between, and how fast they stepped the scene
+struct TunedSettings
+{
+	BroadphaseType broadphase;
+	Real cellSize;				//0 for the grid's own choice each step
+	Real aabbMargin;
+	unsigned threads;
+
+	double stepTime;			//median step with these settings, in ms
+	double startingStepTime;	//median step with the settings the world had before tuning, in ms
+	unsigned candidates;		//number of configurations timed
+
+	TunedSettings(): broadphase(UNIFORM_GRID), cellSize(0), aabbMargin(0.01f), threads(1), stepTime(0), startingStepTime(0), candidates(0) {}
+
+	//copies the tuned fields into the settings, leaving the rest alone
+	void Apply(WorldSettings &settings) const;
+};
+
+// Tuning //
+//times a handful of configurations on the world's scene as it is now and gives back the fastest, without changing
+//the world - every body is put back where it was after each candidate, and at the end the world's own settings and
+//history (see World::History) are restored, so its next step is the same as if it had never been tuned. Call
+//it at startup or whenever the scene has changed character (a pile collapsing into a gas, say).
+//
+//Candidates are tried one parameter at a time, keeping the best of each before moving on: the thread count first,
+//then the cell size (as multiples of the size the grid would pick itself), then the margin, and lastly brute force for
+//small scenes. That is about 15 configurations rather than every combination.
+TunedSettings TuneWorld(World &world, const TuneOptions &options = TuneOptions());
+
+// Tune Profiles //
+//tuned settings stored by scene profile name (e.g. "piles-10000"), so a scene only has to be tuned the first time.
+//Saved as a text file with one profile to a line:
+//	<name> broadphase=grid cell=0.75 margin=0.01 threads=4 ms=1.23
+class TuneProfiles
+{
+public:
+	//adds the profiles in the file, returning false if it couldn't be read. Lines that don't parse are skipped
+	bool Load(const std::string &filename);
+	bool Save(const std::string &filename) const;
+
+	//false if there is no profile by that name
+	bool Find(const std::string &profile, TunedSettings &tuned) const;
+	void Set(const std::string &profile, const TunedSettings &tuned);
+
+	unsigned Size() const { return (unsigned)profiles.size(); }
+
+private:
+	std::map<std::string, TunedSettings> profiles;
+};
+
+//applies the settings stored for the profile to the world, tuning it and storing the result first if there aren't
+//any. Returns true if it had to tune
+bool ApplyTunedSettings(World &world, TuneProfiles &profiles, const std::string &profile, const TuneOptions &options = TuneOptions());
+
+#endif //TUNERH
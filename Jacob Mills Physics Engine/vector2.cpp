@@ -0,0 +1,53 @@
+#include "vector2.h"
+
+//rotates a whole array of points around the world origin by the same amount
+void RotatePointsAboutWorldOrigin(Vector2 points[], const unsigned count, const Real rotation)
+{
+	Real cosTheta;
+	Real sinTheta;
+	SinCos(DegreesToRadians(rotation), sinTheta, cosTheta);
+
+	unsigned i = 0;
+
+#if defined(TRIG_SSE2) && !defined(PHYSICS_FIXED_POINT)
+	//two points per register as x0,y0,x1,y1: x' = xcos@ - ysin@, y' = ycos@ + xsin@
+	const __m128 cosines = _mm_set1_ps(cosTheta);
+	const __m128 sines = _mm_setr_ps(-sinTheta, sinTheta, -sinTheta, sinTheta);
+	float *data = &points[0].x;
+
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128 xy = _mm_loadu_ps(data + i*2);
+		__m128 yx = _mm_shuffle_ps(xy, xy, _MM_SHUFFLE(2,3,0,1));
+		_mm_storeu_ps(data + i*2, _mm_add_ps(_mm_mul_ps(xy, cosines), _mm_mul_ps(yx, sines)));
+	}
+#endif
+
+	//leftover point (or all of them without SSE2, or in fixed point)
+	for (; i < count; i++)
+	{
+		Real tempX = points[i].x;
+		Real tempY = points[i].y;
+
+		points[i].x = tempX * cosTheta - tempY * sinTheta;
+		points[i].y = tempX * sinTheta + tempY * cosTheta;
+	}
+}
+
+//rotates a whole array of points around a specified point
+void RotatePointsAboutPoint(Vector2 points[], const unsigned count, const Vector2 point, const Real rotation)
+{
+	//translate to world origin relative to point given
+	Vector2 translation = point.GetInvert();
+	for (unsigned i = 0; i < count; i++)
+	{
+		points[i] += translation;
+	}
+
+	RotatePointsAboutWorldOrigin(points, count, rotation);
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		points[i] += point;
+	}
+}
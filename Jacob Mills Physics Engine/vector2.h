@@ -2,17 +2,18 @@
 #define VECTOR2H
 
 #include "core.h"
+#include "trig.h"
 
 // Vector2 //
 //Holds a 2D vector. Based on Vector class in Game Physics Engine Development, 2nd Edition, Millington
 class Vector2
 {
 public:
-	float x;	//TODO: performance improved by providing float pad[2]?
-	float y;
+	Real x;	//TODO: performance improved by providing float pad[2]?
+	Real y;
 
 	Vector2(): x(0), y(0){}	//regular constructor is a vector at (0,0)
-	Vector2(const float newX, const float newY): x(newX), y(newY){}	//sets a vector with input values
+	Vector2(const Real newX, const Real newY): x(newX), y(newY){}	//sets a vector with input values
 
 	//flips vector in opposite direction
 	void Invert()
@@ -28,13 +29,13 @@ public:
 	}
 
 	//return magnitude of this vector
-	float Magnitude() const
+	Real Magnitude() const
 	{
-		return sqrtf(x*x + y*y);
+		return sqrt(x*x + y*y);
 	}
 
 	//returns squared magnitude of vector - faster than magnitude, for size comparisons
-	float SquaredMagnitude() const
+	Real SquaredMagnitude() const
 	{
 		return x*x + y*y;
 	}
@@ -42,7 +43,7 @@ public:
 	//changes vector to unit vector 
 	void Normalise()
 	{
-		float mag = Magnitude();
+		Real mag = Magnitude();
 		if (mag > 0)
 		{
 			(*this) *= 1/mag;
@@ -52,7 +53,7 @@ public:
 	//return normalised vector
 	Vector2 GetUnit() const
 	{
-		float mag = Magnitude();
+		Real mag = Magnitude();
 		Vector2 unit(*this);
 		if (mag>0)
 		{
@@ -63,14 +64,14 @@ public:
 	}
 
 	//multiplies vector by given scalar
-	void operator*=(const float value)
+	void operator*=(const Real value)
 	{
 		x *= value;
 		y *= value;
 	}
 
 	//returns vector given by multiplying with scalar
-	Vector2 operator*(const float value) const
+	Vector2 operator*(const Real value) const
 	{
 		return Vector2(x*value, y*value);
 	}
@@ -102,14 +103,14 @@ public:
 	}
 
 	//adds vector to this, and scales it
-	Vector2 AddScaledVector(const Vector2& v, float scale)
+	void AddScaledVector(const Vector2& v, Real scale)
 	{
 		x += v.x*scale;
 		y += v.y*scale;
 	}
 
 	//return dot product of this and another vector
-	float operator*(const Vector2 &v) const
+	Real operator*(const Vector2 &v) const
 	{
 		return x*v.x + y*v.y;
 	}
@@ -128,7 +129,7 @@ public:
 	}
 
 	//rotates point around a specified point and rotation
-	void RotateAboutPoint(const Vector2 point, const float rotation)
+	void RotateAboutPoint(const Vector2 point, const Real rotation)
 	{
 		//translate to world origin relative to point given
 		Vector2 translation = point.GetInvert();
@@ -141,13 +142,14 @@ public:
 	}
 
 	//rotates point around world origin
-	void RotateAboutWorldOrigin(const float rotation)
+	void RotateAboutWorldOrigin(const Real rotation)
 	{
 		//prepare data
-		float tempX = x;
-		float tempY = y;
-		float cosTheta = cos(DegreesToRadians(rotation));
-		float sinTheta = sin(DegreesToRadians(rotation));
+		Real tempX = x;
+		Real tempY = y;
+		Real cosTheta;
+		Real sinTheta;
+		SinCos(DegreesToRadians(rotation), sinTheta, cosTheta);
 
 		//x' = xcos@ - ysin@  - @ is totally a theta
 		x = tempX * cosTheta - tempY * sinTheta;
@@ -159,15 +161,19 @@ public:
 	//convert Vector2 to string format: (x,y)
 	std::string ToString() const
 	{
-		std::ostringstream buff;
-		buff<<"(";
-		buff<<x;
-		buff<<",";
-		buff<<y;
-		buff<<")";
-		return buff.str();
+		char buffer[64];
+		snprintf(buffer, sizeof(buffer), "(%g,%g)", ToFloat(x), ToFloat(y));
+		return buffer;
 	}
 
 };
 
+// Batched Rotation //
+//rotates a whole array of points by the same amount - only one sine and cosine for all of them,
+//and two points at a time with SSE2
+void RotatePointsAboutWorldOrigin(Vector2 points[], const unsigned count, const Real rotation);
+
+//rotates a whole array of points around a specified point
+void RotatePointsAboutPoint(Vector2 points[], const unsigned count, const Vector2 point, const Real rotation);
+
 #endif //VECTOR2H
\ No newline at end of file
@@ -7,6 +7,12 @@
 	#include <vector>
 #endif
 
+#include <stdint.h>
+
+// Colour //
+//32 bit ARGB, same layout as Direct3D's D3DCOLOR (a DWORD) so vertices can be copied straight into a vertex buffer
+typedef uint32_t Colour;
+
 // Vertex //
 struct Vertex
 {
@@ -14,10 +20,44 @@ struct Vertex
 	//weight refers to amount of colour on vertex
 	//z is redundant
 	float x, y, z, weight;
-	DWORD colour;
+	Colour colour;
 };
 
 // Vertex List //
-typedef std::vector<std::vector<Vertex>> VertexList;
+//every line strip to be drawn this frame, packed one after another into a single array with the index of each strip's
+//first vertex kept alongside - so once it has grown to hold a frame's worth of shapes, filling it again allocates nothing
+class VertexList
+{
+private:
+	std::vector<Vertex> vertices;
+	std::vector<unsigned> stripStarts;
+
+public:
+	//starts a new line strip, which the vertices added after it belong to
+	void BeginStrip() { stripStarts.push_back(vertices.size()); }
+	void Add(const Vertex &vertex) { vertices.push_back(vertex); }
+
+	//empties the list, keeping its memory for the next frame
+	void Clear()
+	{
+		vertices.clear();
+		stripStarts.clear();
+	}
+
+	// Accessors
+	unsigned StripCount() const { return stripStarts.size(); }
+	unsigned StripStart(const unsigned strip) const { return stripStarts[strip]; }
+	unsigned StripSize(const unsigned strip) const
+	{
+		const unsigned end = strip+1 < stripStarts.size() ? stripStarts[strip+1] : vertices.size();
+		return end - stripStarts[strip];
+	}
+
+	unsigned VertexCount() const { return vertices.size(); }
+	const Vertex* GetVertices() const { return vertices.empty() ? NULL : &vertices[0]; }
+
+	//bytes reserved, which stays at the most any frame has needed
+	size_t GetMemoryUsed() const { return vertices.capacity()*sizeof(Vertex) + stripStarts.capacity()*sizeof(unsigned); }
+};
 
 #endif //VERTEXH
\ No newline at end of file
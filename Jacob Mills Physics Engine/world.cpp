@@ -0,0 +1,1296 @@
+#include "world.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+
+// Timing //
+typedef std::chrono::steady_clock Clock;
+
+static double MillisecondsSince( const Clock::time_point start )
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Allocations //
+static uint64_t AllocationsSince( const uint64_t start )
+{
+	return GetAllocationCounts().allocations - start;
+}
+
+// Pairs //
+//the order CollisionDetector::GenerateContacts tests pairs in
+static bool PairBefore( const ShapePair &one, const ShapePair &two )
+{
+	return one.a < two.a || (one.a == two.a && one.b < two.b);
+}
+
+//merges the sorted runs of pairs from start to middle and from middle to the end into one, using buffer as working space
+static void MergeRuns( std::vector<ShapePair> &pairs, const size_t start, const size_t middle, std::vector<ShapePair> &buffer )
+{
+	buffer.assign(pairs.begin() + start, pairs.end());
+	std::merge(buffer.begin(), buffer.begin() + (middle - start), buffer.begin() + (middle - start), buffer.end(), pairs.begin() + start, PairBefore);
+}
+
+//twice the average size of the bounding boxes (skipping those left out), which keeps most shapes in one to four cells
+static float GridCellSize( const std::vector<AABB> &bounds, const std::vector<unsigned char> *leaveOut )
+{
+	double totalSize = 0;
+	unsigned counted = 0;
+
+	for (unsigned i = 0; i < bounds.size(); i++)
+	{
+		if (!bounds[i].IsFinite() || (leaveOut && (*leaveOut)[i]))
+			continue;
+
+		totalSize += std::max(ToFloat(bounds[i].max.x - bounds[i].min.x), ToFloat(bounds[i].max.y - bounds[i].min.y));
+		counted++;
+	}
+
+	return counted > 0 ? (float)(2*totalSize / counted) : 1.0f;
+}
+
+// Construction //
+World::World(): threadPool(NULL), filtering(false), sensing(false), renumbered(true), queryReady(false), staticChanged(true), reservedShapes(0), pairCount(0), usedCellSize(0)
+{
+	SetSettings(WorldSettings());
+}
+
+World::World( const WorldSettings &newSettings ): threadPool(NULL), filtering(false), sensing(false), renumbered(true), queryReady(false), staticChanged(true), reservedShapes(0), pairCount(0), usedCellSize(0)
+{
+	SetSettings(newSettings);
+}
+
+World::~World()
+{
+	delete threadPool;
+
+	//shapes don't delete their bodies, so the world does for the ones it owns
+	for (unsigned i = 0; i < ownedBoxes.size(); i++)
+		delete ownedBoxes[i].GetBody();
+	for (unsigned i = 0; i < ownedCircles.size(); i++)
+		delete ownedCircles[i].GetBody();
+	for (unsigned i = 0; i < ownedPolygons.size(); i++)
+		delete ownedPolygons[i].GetBody();
+	for (unsigned i = 0; i < ownedHalfSpaces.size(); i++)
+		delete ownedHalfSpaces[i].GetBody();
+}
+
+void World::SetSettings( const WorldSettings &newSettings )
+{
+	settings = newSettings;
+
+	if (settings.threads == 0)
+		settings.threads = 1;
+
+	//only start new threads if the number has changed
+	if (!threadPool || threadPool->GetThreadCount() != settings.threads)
+	{
+		delete threadPool;
+		threadPool = new ThreadPool(settings.threads);
+	}
+
+	detectors.resize(settings.threads);
+	for (unsigned i = 0; i < detectors.size(); i++)
+		detectors[i].SetContactReuse(settings.reuseContacts, settings.reuseDistance, settings.reuseAngle);
+
+	scratch.resize(settings.threads);
+	mergeScratch.resize(settings.threads);
+	queryScratch.resize(settings.threads);
+
+	//new scratch buffers need reserving, and the static shapes' bounds depend on the margin
+	reservedShapes = 0;
+	staticChanged = true;
+	queryReady = false;
+}
+
+// History //
+void World::SaveHistory( History &history ) const
+{
+	history.settings = settings;
+
+	history.contacts = contacts;
+	history.contactPairs = contactPairs;
+	history.sensorPairs = sensorPairs;
+	history.overlapping = overlapping;
+	history.contactGraph = contactGraph;
+	history.sensorGraph = sensorGraph;
+
+	history.cached.resize(chunks.size());
+	for (unsigned i = 0; i < chunks.size(); i++)
+		history.cached[i] = chunks[i].cached;
+	history.detectors = detectors;
+	history.resolutionCounters = resolutionCounters;
+
+	history.health = health;
+	history.times = times;
+	history.allocations = allocations;
+	history.pairCount = pairCount;
+	history.usedCellSize = usedCellSize;
+
+	history.renumbered = renumbered;
+	history.staticChanged = staticChanged;
+}
+
+void World::RestoreHistory( const History &history )
+{
+	SetSettings(history.settings);
+
+	//rebuilding the static shapes forgets the caches, so if they didn't need rebuilding when the history was saved they
+	//are rebuilt now, before the caches are put back, rather than in the next step. Reserving the buffers again for
+	//the settings' scratch space would rebuild them too, so that goes first
+	ReserveBuffers();
+	if (!history.staticChanged)
+		BuildStatic();
+
+	contacts = history.contacts;
+	contactPairs = history.contactPairs;
+	sensorPairs = history.sensorPairs;
+	overlapping = history.overlapping;
+	contactGraph = history.contactGraph;
+	sensorGraph = history.sensorGraph;
+
+	for (unsigned i = 0; i < chunks.size() && i < history.cached.size(); i++)
+	{
+		chunks[i].cached = history.cached[i];
+		chunks[i].lastCached.clear();
+	}
+	detectors = history.detectors;
+	resolutionCounters = history.resolutionCounters;
+
+	health = history.health;
+	times = history.times;
+	allocations = history.allocations;
+	pairCount = history.pairCount;
+	usedCellSize = history.usedCellSize;
+
+	renumbered = history.renumbered;
+	staticChanged = history.staticChanged;
+	queryReady = false;
+}
+
+// Shapes //
+Box& World::Create( const Box &box )
+{
+	ownedBoxes.push_back(box);
+	objects.Add(ownedBoxes.back());
+	ShapesChanged();
+	return ownedBoxes.back();
+}
+
+Circle& World::Create( const Circle &circle )
+{
+	ownedCircles.push_back(circle);
+	objects.Add(ownedCircles.back());
+	ShapesChanged();
+	return ownedCircles.back();
+}
+
+Polygon& World::Create( const Polygon &polygon )
+{
+	ownedPolygons.push_back(polygon);
+	objects.Add(ownedPolygons.back());
+	ShapesChanged();
+	return ownedPolygons.back();
+}
+
+HalfSpace& World::Create( const HalfSpace &halfSpace )
+{
+	ownedHalfSpaces.push_back(halfSpace);
+	objects.Add(ownedHalfSpaces.back());
+	ShapesChanged();
+	return ownedHalfSpaces.back();
+}
+
+Body* World::GetBodyOf( const unsigned index ) const
+{
+	return objects.GetShapeAt(index).GetBody();
+}
+
+const CollisionFilter& World::GetFilterOf( const unsigned index ) const
+{
+	return objects.GetShapeAt(index).GetFilter();
+}
+
+// Simulation //
+void World::Step( const Real duration )
+{
+	TRACE_SCOPE("World::Step");
+
+	Clock::time_point start = Clock::now();
+	const uint64_t startAllocations = GetAllocationCounts().allocations;
+
+	ResetCounters();
+
+	Clock::time_point phaseStart = Clock::now();
+	uint64_t phaseAllocations = GetAllocationCounts().allocations;
+	Integrate(duration);
+	times.integrate = MillisecondsSince(phaseStart);
+	allocations.integrate = AllocationsSince(phaseAllocations);
+
+	GenerateContacts();
+
+	phaseStart = Clock::now();
+	phaseAllocations = GetAllocationCounts().allocations;
+	ResolveContacts();
+	times.resolution = MillisecondsSince(phaseStart);
+	allocations.resolution = AllocationsSince(phaseAllocations);
+
+	if (settings.measureHealth)
+		MeasureHealth();
+
+	times.total = MillisecondsSince(start);
+	allocations.total = AllocationsSince(startAllocations);
+
+	UpdateMemoryFootprint();
+}
+
+unsigned World::GenerateContacts()
+{
+	ReserveBuffers();
+	contacts.clear();
+
+	const unsigned shapeCount = ShapeCount();
+	const unsigned halfSpaceCount = objects.HalfSpacesSize();
+
+	if (settings.broadphase == BRUTE_FORCE)
+	{
+		//the grid forgets its caches whenever it rebuilds the static shapes, which forgets the reference's too, so both
+		//warm start GJK from the same simplices
+		if (staticChanged)
+			BuildStatic();
+
+		Clock::time_point start = Clock::now();
+		const uint64_t startAllocations = GetAllocationCounts().allocations;
+		if (settings.trackContacts)
+		{
+			contactPairs.clear();
+			detectors[0].GenerateContacts(objects, contacts, contactPairs);
+		}
+		else
+			detectors[0].GenerateContacts(objects, contacts);
+
+		sensing = AnySensors();
+		sensorPairs.clear();
+		if (sensing)
+			detectors[0].FindSensorOverlaps(objects, sensorPairs);
+
+		brutePairs.clear();
+		if (settings.trackPairs)
+			detectors[0].FindOverlappingPairs(objects, settings.aabbMargin, brutePairs);
+		times.broadphase = 0;
+		times.narrowphase = MillisecondsSince(start);
+		allocations.broadphase = 0;
+		allocations.narrowphase = AllocationsSince(startAllocations);
+
+		//every pair of shapes, which passes what an unsigned holds at about 92 thousand
+		pairCount = (uint64_t)shapeCount*(shapeCount-1)/2 + (uint64_t)shapeCount*halfSpaceCount;
+		usedCellSize = 0;
+		UpdateOverlappingPairs();
+		UpdateContactGraph();
+		UpdateSensorEvents();
+		renumbered = false;
+		return contacts.size();
+	}
+
+	Clock::time_point start = Clock::now();
+	uint64_t startAllocations = GetAllocationCounts().allocations;
+	UpdateBounds();
+	FindPairs();
+	UpdateOverlappingPairs();
+	times.broadphase = MillisecondsSince(start);
+	allocations.broadphase = AllocationsSince(startAllocations);
+
+	start = Clock::now();
+	startAllocations = GetAllocationCounts().allocations;
+	GenerateChunkContacts();
+	UpdateContactGraph();
+	UpdateSensorEvents();
+	times.narrowphase = MillisecondsSince(start);
+	allocations.narrowphase = AllocationsSince(startAllocations);
+
+	renumbered = false;
+	return contacts.size();
+}
+
+void World::ResolveContacts()
+{
+	TRACE_SCOPE("World::ResolveContacts");
+
+	queryReady = false;
+
+	for (unsigned i = 0; i < contacts.size(); i++)
+	{
+		resolutionCounters.bodiesMoved += contacts[i].ResolvePosition();
+	}
+
+	for (unsigned i = 0; i < contacts.size(); i++)
+	{
+		resolutionCounters.impulsesApplied += contacts[i].ResolveVelocities();
+	}
+
+	resolutionCounters.positionResolutions += contacts.size();
+	resolutionCounters.velocityResolutions += contacts.size();
+}
+
+// Counters //
+StepCounters World::GetCounters() const
+{
+	StepCounters total = resolutionCounters;
+
+	for (unsigned i = 0; i < detectors.size(); i++)
+	{
+		total.Add(detectors[i].GetCounters());
+	}
+
+	return total;
+}
+
+void World::ResetCounters()
+{
+	resolutionCounters.Clear();
+
+	for (unsigned i = 0; i < detectors.size(); i++)
+	{
+		detectors[i].ResetCounters();
+	}
+}
+
+void World::ReserveBuffers()
+{
+	const unsigned shapeCount = ShapeCount();
+	if (shapeCount == reservedShapes)
+		return;
+
+	reservedShapes = shapeCount;
+	staticChanged = true;
+
+	contacts.reserve((shapeCount + objects.HalfSpacesSize()) * reservedContactsPerShape);
+
+	if (settings.trackPairs)
+	{
+		overlapping.Reserve((shapeCount + objects.HalfSpacesSize()) * reservedContactsPerShape);
+		if (settings.broadphase == BRUTE_FORCE)
+			brutePairs.reserve((shapeCount + objects.HalfSpacesSize()) * reservedContactsPerShape);
+	}
+
+	if (settings.trackContacts)
+	{
+		contactPairs.reserve(contacts.capacity());
+		contactGraph.Reserve(shapeCount + objects.HalfSpacesSize(), contacts.capacity());
+	}
+
+	//shapes can become sensors at any time, but usually are from the start
+	const bool sensors = AnySensors();
+	if (sensors)
+	{
+		sensorPairs.reserve(contacts.capacity());
+		sensorGraph.Reserve(shapeCount + objects.HalfSpacesSize(), contacts.capacity());
+	}
+
+	//the last chunk can be short, but sizing every chunk the same keeps them all ready for more shapes
+	chunks.resize(ChunkCount());
+	for (unsigned i = 0; i < chunks.size(); i++)
+	{
+		chunks[i].pairs.reserve(chunkSize * (reservedPairsPerShape + objects.HalfSpacesSize()));
+		chunks[i].contacts.reserve(chunkSize * reservedContactsPerShape);
+		if (settings.trackContacts)
+			chunks[i].contactPairs.reserve(chunkSize * reservedContactsPerShape);
+		if (sensors)
+			chunks[i].sensorPairs.reserve(chunkSize * reservedContactsPerShape);
+		chunks[i].cached.reserve(chunkSize * reservedContactsPerShape);
+		chunks[i].lastCached.reserve(chunkSize * reservedContactsPerShape);
+	}
+
+	for (unsigned i = 0; i < scratch.size(); i++)
+	{
+		scratch[i].reserve(reservedPairsPerShape);
+	}
+}
+
+// Queries //
+bool World::RayCast( const Ray &ray, RayHit &hit )
+{
+	TRACE_SCOPE("World::RayCast");
+
+	PrepareQueries();
+	return CastRay(ray, hit, 0);
+}
+
+void World::RayCast( const std::vector<Ray> &rays, std::vector<RayHit> &hits )
+{
+	TRACE_SCOPE("World::RayCastBatch");
+
+	PrepareQueries();
+
+	const unsigned rayCount = rays.size();
+	hits.resize(rayCount);
+
+	//counting sort by the movable grid's cell each ray starts in, so rays that walk the same cells are cast together
+	//and find them still in the cache
+	const unsigned cellCount = std::max(grid.GetCellCount(), 1u);
+	rayCells.resize(rayCount);
+
+	//the grid gains a column or row now and then as the shapes spread out, so leave room for it to
+	if (rayCellStarts.capacity() < cellCount + 1)
+		rayCellStarts.reserve(2*(cellCount + 1));
+	rayCellStarts.assign(cellCount + 1, 0);
+	rayOrder.resize(rayCount);
+
+	for (unsigned i = 0; i < rayCount; i++)
+	{
+		rayCells[i] = grid.GetCell(ToFloat(rays[i].from.x), ToFloat(rays[i].from.y));
+		rayCellStarts[rayCells[i] + 1]++;
+	}
+
+	for (unsigned cell = 1; cell <= cellCount; cell++)
+	{
+		rayCellStarts[cell] += rayCellStarts[cell-1];
+	}
+
+	for (unsigned i = 0; i < rayCount; i++)
+	{
+		rayOrder[rayCellStarts[rayCells[i]]++] = i;
+	}
+
+	//each task casts a run of the sorted rays, writing every hit back where its ray was
+	const unsigned raysPerTask = 64;
+	auto task = [&](unsigned run, unsigned thread)
+	{
+		const unsigned end = std::min((run+1)*raysPerTask, rayCount);
+
+		for (unsigned i = run*raysPerTask; i < end; i++)
+		{
+			CastRay(rays[rayOrder[i]], hits[rayOrder[i]], thread);
+		}
+	};
+	threadPool->ParallelFor((rayCount + raysPerTask-1) / raysPerTask, task);
+}
+
+unsigned World::QueryRegion( const AABB &region, std::vector<unsigned> &shapes, const CollisionFilter &filter )
+{
+	TRACE_SCOPE("World::QueryRegion");
+
+	PrepareQueries();
+
+	//candidates by their bounds, each found once however many cells it shares with the region
+	grid.Query(region, bounds, shapes);
+	staticGrid.Query(region, staticBounds, staticFound);
+
+	for (unsigned i = 0; i < staticFound.size(); i++)
+	{
+		shapes.push_back(staticShapes[staticFound[i]]);
+	}
+
+	const unsigned shapeCount = ShapeCount();
+	for (unsigned i = 0; i < objects.HalfSpacesSize(); i++)
+	{
+		shapes.push_back(shapeCount + i);
+	}
+
+	//keep the ones that really overlap
+	CollisionDetector &detector = detectors[0];
+	unsigned kept = 0;
+
+	for (unsigned i = 0; i < shapes.size(); i++)
+	{
+		if (detector.RegionAndShape(objects, shapes[i], region, filter))
+			shapes[kept++] = shapes[i];
+	}
+
+	shapes.resize(kept);
+
+	//the movable and static shapes were found in order, but apart
+	if (!staticFound.empty())
+		std::sort(shapes.begin(), shapes.end());
+
+	return kept;
+}
+
+bool World::ShapeCast( const SweptShape &swept, RayHit &hit )
+{
+	TRACE_SCOPE("World::ShapeCast");
+
+	PrepareQueries();
+	hit = RayHit();
+
+	//everything the sweep's bounds reach, in order like the brute force version so ties go the same way
+	const AABB region = swept.GetSweptBounds();
+	grid.Query(region, bounds, castFound);
+	staticGrid.Query(region, staticBounds, staticFound);
+
+	for (unsigned i = 0; i < staticFound.size(); i++)
+	{
+		castFound.push_back(staticShapes[staticFound[i]]);
+	}
+
+	if (!staticFound.empty())
+		std::sort(castFound.begin(), castFound.end());
+
+	CollisionDetector &detector = detectors[0];
+	for (unsigned i = 0; i < castFound.size(); i++)
+	{
+		detector.SweptShapeAndShape(objects, castFound[i], swept, hit);
+	}
+
+	const unsigned shapeCount = ShapeCount();
+	for (unsigned i = 0; i < objects.HalfSpacesSize(); i++)
+	{
+		detector.SweptShapeAndShape(objects, shapeCount + i, swept, hit);
+	}
+
+	return hit.IsHit();
+}
+
+unsigned World::QueryPoint( const Vector2 &point, std::vector<unsigned> &shapes, const CollisionFilter &filter )
+{
+	AABB region;
+	region.min = point;
+	region.max = point;
+	return QueryRegion(region, shapes, filter);
+}
+
+void World::PrepareQueries()
+{
+	if (queryReady)
+		return;
+
+	TRACE_SCOPE("World::PrepareQueries");
+
+	//the step's grid was built before the resolution moved the shapes, and the brute force broadphase builds none
+	ReserveBuffers();
+	UpdateBounds();
+	grid.Build(bounds, usedCellSize, &immovable);
+	usedCellSize = grid.GetCellSize();
+
+	//room for the shapes a query finds in the grids, which grows as usual past this
+	staticFound.reserve(chunkSize);
+	castFound.reserve(chunkSize);
+
+	for (unsigned i = 0; i < queryScratch.size(); i++)
+	{
+		if (queryScratch[i].stamps.size() != ShapeCount())
+		{
+			queryScratch[i].stamps.assign(ShapeCount(), 0);
+			queryScratch[i].stamp = 0;
+		}
+	}
+
+	queryReady = true;
+}
+
+bool World::CastRay( const Ray &ray, RayHit &hit, const unsigned thread )
+{
+	CollisionDetector &detector = detectors[thread];
+	QueryScratch &query = queryScratch[thread];
+	hit = RayHit();
+
+	//halfspaces first, as border walls are often what a ray ends up hitting, and an early hit cuts the grid walks short
+	const unsigned shapeCount = ShapeCount();
+	for (unsigned i = 0; i < objects.HalfSpacesSize(); i++)
+	{
+		detector.RayAndShape(objects, shapeCount + i, ray, hit);
+	}
+
+	//a new stamp for this ray, clearing the stamps on the rare occasion it wraps round
+	if (++query.stamp == 0)
+	{
+		std::fill(query.stamps.begin(), query.stamps.end(), 0);
+		query.stamp = 1;
+	}
+
+	const unsigned stamp = query.stamp;
+	unsigned *stamps = query.stamps.data();
+	const float fromX = ToFloat(ray.from.x), fromY = ToFloat(ray.from.y);
+	const float toX = ToFloat(ray.to.x), toY = ToFloat(ray.to.y);
+
+	//the static grid is filed by position in staticShapes, the movable one by shape index
+	auto visitStatic = [&](const unsigned *entry, const unsigned *end) -> float
+	{
+		for (; entry != end; entry++)
+		{
+			const unsigned shape = staticShapes[*entry];
+			if (stamps[shape] == stamp)
+				continue;
+
+			stamps[shape] = stamp;
+			detector.RayAndShape(objects, shape, ray, hit);
+		}
+
+		return ToFloat(hit.fraction);
+	};
+
+	auto visitMovable = [&](const unsigned *entry, const unsigned *end) -> float
+	{
+		for (; entry != end; entry++)
+		{
+			if (stamps[*entry] == stamp)
+				continue;
+
+			stamps[*entry] = stamp;
+			detector.RayAndShape(objects, *entry, ray, hit);
+		}
+
+		return ToFloat(hit.fraction);
+	};
+
+	staticGrid.Walk(fromX, fromY, toX, toY, ToFloat(hit.fraction), visitStatic);
+	grid.Walk(fromX, fromY, toX, toY, ToFloat(hit.fraction), visitMovable);
+
+	return hit.IsHit();
+}
+
+// Memory //
+const MemoryFootprint& World::GetMemoryFootprint()
+{
+	UpdateMemoryFootprint();
+	return memory;
+}
+
+void World::UpdateMemoryFootprint()
+{
+	//every shape has its own Body, whoever owns the shape
+	memory.bodies.Update(objects.Size() * sizeof(Body));
+
+	memory.shapes.Update(objects.GetMemoryUsed() + ownedBoxes.size()*sizeof(Box) + ownedCircles.size()*sizeof(Circle)
+		+ ownedPolygons.size()*sizeof(Polygon) + ownedHalfSpaces.size()*sizeof(HalfSpace));
+
+	size_t contactBytes = contacts.capacity() * sizeof(Contact) + (contactPairs.capacity() + sensorPairs.capacity()) * sizeof(ShapePair)
+		+ contactGraph.GetMemoryUsed() + sensorGraph.GetMemoryUsed();
+	size_t broadphaseBytes = bounds.capacity()*sizeof(AABB) + grid.GetMemoryUsed();
+
+	for (unsigned i = 0; i < chunks.size(); i++)
+	{
+		contactBytes += chunks[i].contacts.capacity() * sizeof(Contact)
+			+ (chunks[i].contactPairs.capacity() + chunks[i].sensorPairs.capacity()) * sizeof(ShapePair);
+		broadphaseBytes += chunks[i].pairs.capacity() * sizeof(ShapePair);
+		contactBytes += (chunks[i].cached.capacity() + chunks[i].lastCached.capacity()) * sizeof(CachedPair);
+	}
+
+	for (unsigned i = 0; i < scratch.size(); i++)
+	{
+		broadphaseBytes += scratch[i].capacity()*sizeof(unsigned) + mergeScratch[i].capacity()*sizeof(ShapePair);
+	}
+
+	//queries share the broadphase's grids
+	for (unsigned i = 0; i < queryScratch.size(); i++)
+	{
+		broadphaseBytes += queryScratch[i].stamps.capacity()*sizeof(unsigned);
+	}
+	broadphaseBytes += (rayCells.capacity() + rayCellStarts.capacity() + rayOrder.capacity() + staticFound.capacity()
+		+ castFound.capacity())*sizeof(unsigned);
+
+	//the static shapes are counted in with the broadphase
+	for (unsigned i = 0; i < chunks.size(); i++)
+	{
+		broadphaseBytes += (chunks[i].earlierPairs.capacity() + chunks[i].staticPairs.capacity()) * sizeof(ShapePair);
+	}
+
+	broadphaseBytes += overlapping.GetMemoryUsed() + brutePairs.capacity()*sizeof(ShapePair);
+	broadphaseBytes += immovable.capacity() + (staticShapes.capacity() + slantedPlanes.capacity())*sizeof(unsigned)
+		+ staticBounds.capacity()*sizeof(AABB) + staticGrid.GetMemoryUsed() + planes.capacity()*sizeof(Plane);
+
+	memory.contacts.Update(contactBytes);
+	memory.broadphase.Update(broadphaseBytes);
+}
+
+// Phases //
+void World::Integrate( const Real duration )
+{
+	TRACE_SCOPE("World::Integrate");
+
+	queryReady = false;
+
+	auto task = [&](unsigned chunk, unsigned) { IntegrateChunk(chunk, duration); };
+	threadPool->ParallelFor(ChunkCount(), task);
+}
+
+void World::UpdateBounds()
+{
+	TRACE_SCOPE("World::UpdateBounds");
+
+	bounds.resize(ShapeCount());
+	chunks.resize(ChunkCount());
+
+	if (staticChanged || immovable.size() != bounds.size() || planes.size() != objects.HalfSpacesSize())
+		BuildStatic();
+
+	auto task = [&](unsigned chunk, unsigned) { BoundChunk(chunk); };
+	threadPool->ParallelFor(ChunkCount(), task);
+
+	filtering = false;
+	for (unsigned i = 0; i < ChunkCount(); i++)
+		filtering |= chunks[i].filtered;
+
+	sensing = false;
+	for (unsigned i = 0; i < ChunkCount(); i++)
+		sensing |= chunks[i].sensed;
+
+	for (unsigned i = 0; i < objects.HalfSpacesSize(); i++)
+	{
+		filtering |= !objects.GetHalfSpaceAt(i).GetFilter().IsOpen();
+		sensing |= objects.GetHalfSpaceAt(i).IsSensor();
+	}
+
+	if (settings.cellSize > 0)
+		usedCellSize = ToFloat(settings.cellSize);
+	else
+		usedCellSize = GridCellSize(bounds, &immovable);
+}
+
+void World::BuildStatic()
+{
+	TRACE_SCOPE("World::BuildStatic");
+
+	staticChanged = false;
+
+	//shapes may have been added, removed (renumbering the rest) or moved by hand, so last step's pairs can't be trusted
+	for (unsigned i = 0; i < chunks.size(); i++)
+	{
+		chunks[i].cached.clear();
+		chunks[i].lastCached.clear();
+	}
+
+	for (unsigned i = 0; i < detectors.size(); i++)
+		detectors[i].ClearSimplexCaches();
+
+	const unsigned shapeCount = ShapeCount();
+	const unsigned boxCount = objects.BoxesSize();
+	const unsigned circleEnd = boxCount + objects.CirclesSize();
+
+	immovable.assign(shapeCount, 0);
+	staticShapes.clear();
+	staticBounds.clear();
+
+	for (unsigned i = 0; i < shapeCount; i++)
+	{
+		if (GetBodyOf(i)->inverseMass > 0)
+			continue;
+
+		immovable[i] = 1;
+		staticShapes.push_back(i);
+
+		if (i < boxCount)
+			staticBounds.push_back(GetBounds(objects.GetBoxAt(i), settings.aabbMargin));
+		else if (i < circleEnd)
+			staticBounds.push_back(GetBounds(objects.GetCircleAt(i - boxCount), settings.aabbMargin));
+		else
+			staticBounds.push_back(GetBounds(objects.GetPolygonAt(i - circleEnd), settings.aabbMargin));
+	}
+
+	staticGrid.Build(staticBounds, GridCellSize(staticBounds, NULL));
+
+	//room for static pairs, only needed if there are static shapes to make them
+	if (!staticShapes.empty())
+	{
+		for (unsigned i = 0; i < chunks.size(); i++)
+		{
+			chunks[i].earlierPairs.reserve(chunkSize * reservedContactsPerShape);
+			chunks[i].staticPairs.reserve(chunkSize * reservedContactsPerShape);
+		}
+
+		for (unsigned i = 0; i < mergeScratch.size(); i++)
+		{
+			mergeScratch[i].reserve(chunkSize * (reservedPairsPerShape + objects.HalfSpacesSize()));
+		}
+	}
+
+	// Halfspaces
+	const unsigned halfSpaceCount = objects.HalfSpacesSize();
+	planes.resize(halfSpaceCount);
+	slantedPlanes.clear();
+
+	borderMinX = borderMinY = -FLT_MAX;
+	borderMaxX = borderMaxY = FLT_MAX;
+
+	for (unsigned i = 0; i < halfSpaceCount; i++)
+	{
+		const HalfSpace &halfSpace = objects.GetHalfSpaceAt(i);
+		Plane &plane = planes[i];
+
+		plane.normalX = ToFloat(halfSpace.GetNormal().x);
+		plane.normalY = ToFloat(halfSpace.GetNormal().y);
+		plane.absoluteX = fabs(plane.normalX);
+		plane.absoluteY = fabs(plane.normalY);
+		plane.offset = ToFloat(halfSpace.GetOffset());
+
+		//a shape reaches a halfspace along an axis when its bounds pass the offset on that side
+		if (plane.normalX == 0 && plane.absoluteY == 1)
+		{
+			if (plane.normalY > 0)
+				borderMinY = std::max(borderMinY, plane.offset);
+			else
+				borderMaxY = std::min(borderMaxY, -plane.offset);
+		}
+		else if (plane.normalY == 0 && plane.absoluteX == 1)
+		{
+			if (plane.normalX > 0)
+				borderMinX = std::max(borderMinX, plane.offset);
+			else
+				borderMaxX = std::min(borderMaxX, -plane.offset);
+		}
+		else
+		{
+			slantedPlanes.push_back(i);
+		}
+	}
+}
+
+void World::AddHalfSpacePairs( const unsigned index, std::vector<ShapePair> &pairs ) const
+{
+	const unsigned shapeCount = ShapeCount();
+	const AABB &box = bounds[index];
+
+	//a shape that has blown up is given every halfspace, as the reference would
+	if (!box.IsFinite())
+	{
+		for (unsigned i = 0; i < planes.size(); i++)
+		{
+			ShapePair pair = {index, shapeCount + i};
+			pairs.push_back(pair);
+		}
+		return;
+	}
+
+	const float minX = ToFloat(box.min.x), minY = ToFloat(box.min.y);
+	const float maxX = ToFloat(box.max.x), maxY = ToFloat(box.max.y);
+	const float centreX = (minX + maxX) * 0.5f, centreY = (minY + maxY) * 0.5f;
+	const float extentX = (maxX - minX) * 0.5f, extentY = (maxY - minY) * 0.5f;
+
+	//clear of every border halfspace - all four tests are done without branching, as this is almost always true
+	const bool insideBorder = (minX > borderMinX) & (minY > borderMinY) & (maxX < borderMaxX) & (maxY < borderMaxY);
+
+	const unsigned count = insideBorder ? (unsigned)slantedPlanes.size() : (unsigned)planes.size();
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		const unsigned halfSpace = insideBorder ? slantedPlanes[i] : i;
+		const Plane &plane = planes[halfSpace];
+
+		//the nearest point of the bounds to the halfspace, against its offset
+		if (plane.normalX*centreX + plane.normalY*centreY - plane.absoluteX*extentX - plane.absoluteY*extentY > plane.offset)
+			continue;
+
+		ShapePair pair = {index, shapeCount + halfSpace};
+		pairs.push_back(pair);
+	}
+}
+
+void World::FilterPairs( std::vector<ShapePair> &pairs, const size_t start ) const
+{
+	size_t kept = start;
+
+	for (size_t i = start; i < pairs.size(); i++)
+	{
+		if (ShouldCollide(GetFilterOf(pairs[i].a), GetFilterOf(pairs[i].b)))
+			pairs[kept++] = pairs[i];
+	}
+
+	pairs.resize(kept);
+}
+
+void World::FindPairs()
+{
+	TRACE_SCOPE("World::FindPairs");
+
+	grid.Build(bounds, usedCellSize, &immovable);
+	usedCellSize = grid.GetCellSize();
+
+	auto task = [&](unsigned chunk, unsigned thread) { PairChunk(chunk, thread); };
+	threadPool->ParallelFor(ChunkCount(), task);
+
+	if (!staticShapes.empty())
+		MergeStaticPairs();
+
+	pairCount = 0;
+	for (unsigned i = 0; i < chunks.size(); i++)
+	{
+		pairCount += chunks[i].pairs.size();
+	}
+}
+
+void World::UpdateOverlappingPairs()
+{
+	//numbers from before the shapes changed would match the wrong pairs. Not tracking leaves the set empty, so
+	//turning it on later doesn't report pairs that ended long ago
+	if (renumbered || !settings.trackPairs)
+		overlapping.Clear();
+
+	if (!settings.trackPairs)
+		return;
+
+	TRACE_SCOPE("World::UpdateOverlappingPairs");
+
+	//chunks are in shape order and their pairs sorted, so the pairs that began come out in order too, as they do from
+	//the brute force path
+	overlapping.BeginUpdate();
+	if (settings.broadphase == BRUTE_FORCE)
+	{
+		for (unsigned i = 0; i < brutePairs.size(); i++)
+			overlapping.Add(brutePairs[i]);
+	}
+	else
+	{
+		for (unsigned i = 0; i < chunks.size(); i++)
+		{
+			const std::vector<ShapePair> &pairs = chunks[i].pairs;
+			for (unsigned j = 0; j < pairs.size(); j++)
+				overlapping.Add(pairs[j]);
+		}
+	}
+	overlapping.EndUpdate();
+}
+
+void World::UpdateContactGraph()
+{
+	//as for the overlapping pairs
+	if (renumbered || !settings.trackContacts)
+		contactGraph.Clear();
+
+	if (!settings.trackContacts)
+		return;
+
+	TRACE_SCOPE("World::UpdateContactGraph");
+
+	//the brute force path fills contactPairs itself; otherwise the chunks' are joined up in the same order as their
+	//contacts
+	if (settings.broadphase != BRUTE_FORCE)
+	{
+		contactPairs.clear();
+		for (unsigned i = 0; i < chunks.size(); i++)
+		{
+			contactPairs.insert(contactPairs.end(), chunks[i].contactPairs.begin(), chunks[i].contactPairs.end());
+		}
+	}
+
+	contactGraph.Update(contactPairs, ShapeCount() + objects.HalfSpacesSize());
+}
+
+void World::UpdateSensorEvents()
+{
+	if (renumbered)
+		sensorGraph.Clear();
+
+	//once the last sensor has gone, one more update reports whatever was in them as leaving
+	if (!sensing && sensorGraph.GetTouchingCount() == 0)
+	{
+		sensorGraph.Clear();
+		sensorPairs.clear();
+		return;
+	}
+
+	TRACE_SCOPE("World::UpdateSensorEvents");
+
+	//as for the contact graph
+	if (settings.broadphase != BRUTE_FORCE)
+	{
+		sensorPairs.clear();
+		for (unsigned i = 0; i < chunks.size(); i++)
+		{
+			sensorPairs.insert(sensorPairs.end(), chunks[i].sensorPairs.begin(), chunks[i].sensorPairs.end());
+		}
+	}
+
+	sensorGraph.Update(sensorPairs, ShapeCount() + objects.HalfSpacesSize());
+}
+
+bool World::AnySensors() const
+{
+	for (unsigned i = 0; i < objects.Size(); i++)
+	{
+		if (objects.GetShapeAt(i).IsSensor())
+			return true;
+	}
+
+	return false;
+}
+
+void World::MergeStaticPairs()
+{
+	TRACE_SCOPE("World::MergeStaticPairs");
+
+	for (unsigned i = 0; i < chunks.size(); i++)
+	{
+		chunks[i].staticPairs.clear();
+	}
+
+	for (unsigned i = 0; i < chunks.size(); i++)
+	{
+		const std::vector<ShapePair> &earlierPairs = chunks[i].earlierPairs;
+
+		for (unsigned j = 0; j < earlierPairs.size(); j++)
+		{
+			chunks[earlierPairs[j].a / chunkSize].staticPairs.push_back(earlierPairs[j]);
+		}
+	}
+
+	auto task = [&](unsigned chunk, unsigned thread) { StaticPairChunk(chunk, thread); };
+	threadPool->ParallelFor(ChunkCount(), task);
+}
+
+void World::GenerateChunkContacts()
+{
+	TRACE_SCOPE("World::GenerateChunkContacts");
+
+	auto task = [&](unsigned chunk, unsigned thread) { ContactChunk(chunk, thread); };
+	threadPool->ParallelFor(ChunkCount(), task);
+
+	//chunks are in shape order and each chunk's contacts are in pair order, so this is the reference order
+	for (unsigned i = 0; i < chunks.size(); i++)
+	{
+		contacts.insert(contacts.end(), chunks[i].contacts.begin(), chunks[i].contacts.end());
+	}
+}
+
+void World::MeasureHealth()
+{
+	TRACE_SCOPE("World::MeasureHealth");
+
+	auto task = [&](unsigned chunk, unsigned) { HealthChunk(chunk); };
+	threadPool->ParallelFor(ChunkCount(), task);
+
+	//chunks are added in order, so the totals come out the same whatever the number of threads
+	const HealthReading previous = health;
+	health = HealthReading();
+
+	for (unsigned i = 0; i < ChunkCount(); i++)
+	{
+		health.Add(chunks[i].health);
+	}
+
+	MeasurePenetration(contacts, health);
+	CheckHealth(health, previous, settings.healthThresholds);
+}
+
+// Tasks //
+void World::IntegrateChunk( const unsigned chunk, const Real duration )
+{
+	TRACE_SCOPE("World::IntegrateChunk");
+
+	const unsigned end = std::min((chunk+1)*chunkSize, ShapeCount());
+
+	for (unsigned i = chunk*chunkSize; i < end; i++)
+	{
+		GetBodyOf(i)->Integrate(duration, settings.gravity);
+	}
+}
+
+void World::BoundChunk( const unsigned chunk )
+{
+	TRACE_SCOPE("World::BoundChunk");
+
+	const unsigned end = std::min((chunk+1)*chunkSize, ShapeCount());
+	const unsigned boxCount = objects.BoxesSize();
+	const unsigned circleEnd = boxCount + objects.CirclesSize();
+	bool filtered = false;
+	bool sensed = false;
+
+	for (unsigned i = chunk*chunkSize; i < end; i++)
+	{
+		const Shape &shape = objects.GetShapeAt(i);
+		filtered |= !shape.GetFilter().IsOpen();
+		sensed |= shape.IsSensor();
+
+		//static shapes were bounded when they were filed
+		if (immovable[i])
+			continue;
+
+		if (i < boxCount)
+			bounds[i] = GetBounds(objects.GetBoxAt(i), settings.aabbMargin);
+		else if (i < circleEnd)
+			bounds[i] = GetBounds(objects.GetCircleAt(i - boxCount), settings.aabbMargin);
+		else
+			bounds[i] = GetBounds(objects.GetPolygonAt(i - circleEnd), settings.aabbMargin);
+	}
+
+	chunks[chunk].filtered = filtered;
+	chunks[chunk].sensed = sensed;
+}
+
+void World::HealthChunk( const unsigned chunk )
+{
+	TRACE_SCOPE("World::HealthChunk");
+
+	chunks[chunk].health = HealthReading();
+	MeasureBodies(objects, chunk*chunkSize, std::min((chunk+1)*chunkSize, ShapeCount()), chunks[chunk].health);
+}
+
+void World::PairChunk( const unsigned chunk, const unsigned thread )
+{
+	TRACE_SCOPE("World::PairChunk");
+
+	const unsigned end = std::min((chunk+1)*chunkSize, ShapeCount());
+
+	std::vector<ShapePair> &pairs = chunks[chunk].pairs;
+	std::vector<ShapePair> &earlierPairs = chunks[chunk].earlierPairs;
+	std::vector<unsigned> &found = scratch[thread];
+	pairs.clear();
+	earlierPairs.clear();
+
+	for (unsigned i = chunk*chunkSize; i < end; i++)
+	{
+		//static shapes only pair with the movable shapes that find them
+		if (immovable[i])
+			continue;
+
+		//other shapes first, then the halfspaces - the same order GenerateContacts checks them in
+		const size_t rowStart = pairs.size();
+		grid.Query(i, bounds, pairs, found);
+
+		if (!staticShapes.empty())
+		{
+			const size_t movableEnd = pairs.size();
+			staticGrid.Query(bounds[i], staticBounds, found);
+
+			for (unsigned j = 0; j < found.size(); j++)
+			{
+				const unsigned other = staticShapes[found[j]];
+
+				if (other < i)
+				{
+					//the owning chunk never sees these, so they are filtered here
+					if (filtering && !ShouldCollide(GetFilterOf(other), GetFilterOf(i)))
+						continue;
+
+					ShapePair pair = {other, i};
+					earlierPairs.push_back(pair);
+				}
+				else
+				{
+					ShapePair pair = {i, other};
+					pairs.push_back(pair);
+				}
+			}
+
+			if (movableEnd > rowStart && pairs.size() > movableEnd)
+				MergeRuns(pairs, rowStart, movableEnd, mergeScratch[thread]);
+		}
+
+		AddHalfSpacePairs(i, pairs);
+
+		if (filtering)
+			FilterPairs(pairs, rowStart);
+	}
+}
+
+void World::StaticPairChunk( const unsigned chunk, const unsigned thread )
+{
+	std::vector<ShapePair> &staticPairs = chunks[chunk].staticPairs;
+	if (staticPairs.empty())
+		return;
+
+	TRACE_SCOPE("World::StaticPairChunk");
+
+	std::sort(staticPairs.begin(), staticPairs.end(), PairBefore);
+
+	std::vector<ShapePair> &pairs = chunks[chunk].pairs;
+	const size_t middle = pairs.size();
+	pairs.insert(pairs.end(), staticPairs.begin(), staticPairs.end());
+	MergeRuns(pairs, 0, middle, mergeScratch[thread]);
+}
+
+void World::ContactChunk( const unsigned chunk, const unsigned thread )
+{
+	TRACE_SCOPE("World::ContactChunk");
+
+	const unsigned boxCount = objects.BoxesSize();
+	const unsigned circleEnd = boxCount + objects.CirclesSize();
+	const unsigned shapeCount = ShapeCount();
+
+	CollisionDetector &detector = detectors[thread];
+	const std::vector<ShapePair> &pairs = chunks[chunk].pairs;
+	std::vector<Contact> &chunkContacts = chunks[chunk].contacts;
+	std::vector<ShapePair> &chunkContactPairs = chunks[chunk].contactPairs;
+	std::vector<ShapePair> &chunkSensorPairs = chunks[chunk].sensorPairs;
+	chunkContacts.clear();
+	chunkContactPairs.clear();
+	chunkSensorPairs.clear();
+
+	//last step's caches become the ones read from, and this step's are written over the ones before
+	std::vector<CachedPair> &cached = chunks[chunk].cached;
+	std::vector<CachedPair> &lastCached = chunks[chunk].lastCached;
+	cached.swap(lastCached);
+	cached.clear();
+	unsigned last = 0;
+
+	for (unsigned i = 0; i < pairs.size(); i++)
+	{
+		const unsigned a = pairs[i].a;
+		const unsigned b = pairs[i].b;
+
+		//pairs with a sensor in are only tested for overlap, and two sensors ignore each other
+		if (sensing)
+		{
+			const bool oneSensor = objects.GetShapeAt(a).IsSensor();
+			const bool twoSensor = objects.GetShapeAt(b).IsSensor();
+
+			if (oneSensor || twoSensor)
+			{
+				if (oneSensor != twoSensor && detector.ShapesOverlap(objects, a, b))
+					chunkSensorPairs.push_back(pairs[i]);
+				continue;
+			}
+		}
+
+		//box pairs and pairs with a polygon in have a cache (box and circle pairs only when contacts are being reused).
+		//Both steps' pairs are in order, so last step's entry for this pair is found by walking forward. Pairs new this
+		//step start with an empty cache
+		const bool polygonPair = b >= circleEnd && b < shapeCount;
+		const bool cachedPair = polygonPair || (a < boxCount && (b < boxCount || (b < circleEnd && settings.reuseContacts)));
+
+		CachedPair pair;
+		if (cachedPair)
+		{
+			while (last < lastCached.size() && PairBefore(lastCached[last].pair, pairs[i]))
+				last++;
+
+			pair.pair = pairs[i];
+			if (last < lastCached.size() && lastCached[last].pair.a == a && lastCached[last].pair.b == b)
+				pair.cache = lastCached[last].cache;
+		}
+
+		if (a < boxCount)
+		{
+			const Box &box = objects.GetBoxAt(a);
+
+			if (b < boxCount)
+				detector.BoxAndBox(box, objects.GetBoxAt(b), chunkContacts, pair.cache);
+			else if (b < circleEnd && settings.reuseContacts)
+				detector.BoxAndCircle(box, objects.GetCircleAt(b - boxCount), chunkContacts, pair.cache);
+			else if (b < circleEnd)
+				detector.BoxAndCircle(box, objects.GetCircleAt(b - boxCount), chunkContacts);
+			else if (b < shapeCount)
+				detector.BoxAndPolygon(box, objects.GetPolygonAt(b - circleEnd), chunkContacts, pair.cache.simplex);
+			else
+				detector.BoxAndHalfSpace(box, objects.GetHalfSpaceAt(b - shapeCount), chunkContacts);
+		}
+		else if (a < circleEnd)
+		{
+			const Circle &circle = objects.GetCircleAt(a - boxCount);
+
+			if (b < circleEnd)
+				detector.CircleAndCircle(circle, objects.GetCircleAt(b - boxCount), chunkContacts);
+			else if (b < shapeCount)
+				detector.CircleAndPolygon(circle, objects.GetPolygonAt(b - circleEnd), chunkContacts, pair.cache.simplex);
+			else
+				detector.CircleAndHalfSpace(circle, objects.GetHalfSpaceAt(b - shapeCount), chunkContacts);
+		}
+		else
+		{
+			const Polygon &polygon = objects.GetPolygonAt(a - circleEnd);
+
+			if (b < shapeCount)
+				detector.PolygonAndPolygon(polygon, objects.GetPolygonAt(b - circleEnd), chunkContacts, pair.cache.simplex);
+			else
+				detector.PolygonAndHalfSpace(polygon, objects.GetHalfSpaceAt(b - shapeCount), chunkContacts);
+		}
+
+		if (cachedPair)
+			cached.push_back(pair);
+
+		//one entry for each contact the pair made
+		if (settings.trackContacts)
+			chunkContactPairs.resize(chunkContacts.size(), pairs[i]);
+	}
+}
@@ -0,0 +1,458 @@
+#ifndef WORLDH
+#define WORLDH
+
+// Includes //
+#include <deque>
+
+#include "core.h"
+#include "vector2.h"
+#include "shape.h"
+#include "collision.h"
+#include "broadphase.h"
+#include "pairset.h"
+#include "contactgraph.h"
+#include "parallel.h"
+#include "allocation.h"
+#include "footprint.h"
+#include "health.h"
+
+// Settings //
+enum BroadphaseType{BRUTE_FORCE, UNIFORM_GRID};
+
+struct WorldSettings
+{
+	//BRUTE_FORCE runs CollisionDetector::GenerateContacts as it is (every shape against every other, one thread),
+	//so it is the reference everything else has to match
+	BroadphaseType broadphase;
+
+	//width of a grid cell in metres. 0 picks twice the average size of the shapes each step
+	Real cellSize;
+
+	//threads used for integration and collision detection, including the calling one
+	unsigned threads;
+
+	//acceleration added to every movable body each step, in m/s/s
+	Vector2 gravity;
+
+	//how far each bounding box is grown on every side, in metres
+	Real aabbMargin;
+
+	//measure energy, momentum, speed and penetration at the end of every step (see health.h), raising alarms for the
+	//readings past healthThresholds
+	bool measureHealth;
+	HealthThresholds healthThresholds;
+
+	//give box pairs (box and box, box and circle) that have moved less than reuseDistance (metres) and reuseAngle
+	//(degrees) relative to each other since they were last tested the same contact as then, without testing them
+	//again. Suits scenes that are mostly at rest but still awake, at the cost of contacts that are out by up to the
+	//tolerances
+	bool reuseContacts;
+	Real reuseDistance;
+	Real reuseAngle;
+
+	//keep the set of overlapping pairs from step to step, with the pairs that began and ended overlapping each step
+	//(see World::GetOverlappingPairs). Brute force finds the same pairs as the grid, testing every pair's bounds
+	bool trackPairs;
+
+	//index each step's contacts by shape, with the contacts that began, persisted and ended for each shape (see
+	//World::GetContactGraph)
+	bool trackContacts;
+
+	WorldSettings(): broadphase(UNIFORM_GRID), cellSize(0), threads(1), gravity(0,0), aabbMargin(0.01f), measureHealth(false),
+		reuseContacts(false), reuseDistance(0.001f), reuseAngle(0.05f), trackPairs(false),
+		trackContacts(false) {}
+};
+
+// Step Times //
+//how long each phase of the last step took, in milliseconds
+struct StepTimes
+{
+	double integrate;
+	double broadphase;
+	double narrowphase;
+	double resolution;
+	double total;
+
+	StepTimes(): integrate(0), broadphase(0), narrowphase(0), resolution(0), total(0) {}
+};
+
+// Step Allocations //
+//how many times each phase of the last step allocated memory. Only counted in builds with PHYSICS_ALLOCATION_COUNTING
+//(see allocation.h) - otherwise always 0. Once every buffer has grown to fit the scene a step shouldn't allocate at all
+struct StepAllocations
+{
+	uint64_t integrate;
+	uint64_t broadphase;
+	uint64_t narrowphase;
+	uint64_t resolution;
+	uint64_t total;
+
+	StepAllocations(): integrate(0), broadphase(0), narrowphase(0), resolution(0), total(0) {}
+};
+
+// World //
+//holds the shapes in the simulation and steps them forward: integrate, find pairs that might touch (broadphase),
+//generate contacts for those pairs (narrowphase), then resolve penetrations and velocities. Contacts come out in the
+//same order as CollisionDetector::GenerateContacts gives them whatever the broadphase or number of threads, so the
+//results are identical to the reference.
+//
+//Immovable boxes, circles and polygons (and halfspaces) are static: the grid broadphase files them once in a structure of their
+//own and only checks movable shapes against it, so a big static level costs next to nothing each step. Pairs of two
+//static shapes are never tested, as in the reference.
+class World
+{
+public:
+	World();
+	World(const WorldSettings &newSettings);
+	~World();
+
+	// Shapes
+	//copies the shape into the world, which takes ownership of its body and deletes it with the world
+	Box& Create(const Box &box);
+	Circle& Create(const Circle &circle);
+	Polygon& Create(const Polygon &polygon);
+	HalfSpace& Create(const HalfSpace &halfSpace);
+
+	//adds a shape owned by the caller, which has to outlive the world or be removed first
+	void Add(Box &box) { objects.Add(box); ShapesChanged(); }
+	void Add(Circle &circle) { objects.Add(circle); ShapesChanged(); }
+	void Add(Polygon &polygon) { objects.Add(polygon); ShapesChanged(); }
+	void Add(HalfSpace &halfSpace) { objects.Add(halfSpace); ShapesChanged(); }
+
+	void Remove(Box &box) { objects.Remove(box); ShapesChanged(); }
+	void Remove(Circle &circle) { objects.Remove(circle); ShapesChanged(); }
+	void Remove(Polygon &polygon) { objects.Remove(polygon); ShapesChanged(); }
+
+	//rebuilds the static shapes before the next step. Adding and removing shapes does this already, but moving an
+	//immovable shape, or changing a shape's mass to or from infinite, needs it calling
+	void UpdateStatic() { staticChanged = true; queryReady = false; }
+
+	// Simulation
+	//moves everything on by duration seconds and resolves the contacts this makes
+	void Step(const Real duration);
+
+	//fills the contact list for the shapes where they are now, returning the number of contacts
+	unsigned GenerateContacts();
+
+	//resolves positions then velocities for every contact in the contact list
+	void ResolveContacts();
+
+	// Accessors
+	const std::vector<Contact>& GetContacts() const { return contacts; }
+	ObjectList& GetObjects() { return objects; }
+	const StepTimes& GetStepTimes() const { return times; }
+	const StepAllocations& GetStepAllocations() const { return allocations; }
+
+	//energy, momentum, speed and penetration after the last step, with its alarms (all 0 unless measureHealth is set)
+	const HealthReading& GetHealth() const { return health; }
+
+	//bytes used by each subsystem now, and the most each has used at the end of any step so far
+	const MemoryFootprint& GetMemoryFootprint();
+
+	//what every detector and the resolution did since the counters were last reset (Step resets them first)
+	StepCounters GetCounters() const;
+	void ResetCounters();
+	const WorldSettings& GetSettings() const { return settings; }
+
+	//number of pairs handed to the narrowphase by the last GenerateContacts
+	uint64_t GetPairCount() const { return pairCount; }
+
+	//the pairs whose bounds overlap (after filtering), as of the last step, with the ones that began and ended
+	//overlapping in it - empty unless WorldSettings::trackPairs is set. Pairs are numbered as in the broadphase (boxes,
+	//circles, polygons, then halfspaces), so adding or removing shapes starts the set again: the step after reports
+	//every pair as beginning, and none as ending
+	const PairSet& GetOverlappingPairs() const { return overlapping; }
+
+	//each shape's contacts (as indices into GetContacts) and contact events, as of the last step - empty unless
+	//WorldSettings::trackContacts is set. Shapes are numbered as in the broadphase, so box i is node i and circle i is
+	//node i plus the number of boxes, with polygons and then halfspaces after them. Adding or removing shapes starts the
+	//events again, as for the overlapping pairs
+	const ContactGraph& GetContactGraph() const { return contactGraph; }
+
+	//the pair each contact in GetContacts is between, in order - empty unless WorldSettings::trackContacts is set
+	const std::vector<ShapePair>& GetContactPairs() const { return contactPairs; }
+
+	//what overlaps each sensor (see Shape::SetSensor) as of the last step, found by the broadphase and an overlap test
+	//that works out no contact. Each sensor and each shape in one gets its overlaps (as indices into GetSensorOverlaps)
+	//and events: CONTACT_BEGAN when a shape enters a sensor, CONTACT_ENDED when it leaves. Numbered as the contact
+	//graph, and started again when shapes are added or removed
+	const ContactGraph& GetSensorEvents() const { return sensorGraph; }
+
+	//each sensor and shape overlapping, in order
+	const std::vector<ShapePair>& GetSensorOverlaps() const { return sensorPairs; }
+
+	//cell size the grid actually used last time (0 if it wasn't used)
+	float GetCellSize() const { return usedCellSize; }
+
+	// Queries
+	//the nearest shape the ray hits, into hit, with the shapes where they were at the end of the last step. Sensors are
+	//never hit, and the ray's filter decides what it can hit as a shape's would. Returns whether anything was hit
+	bool RayCast(const Ray &ray, RayHit &hit);
+
+	//casts every ray, leaving the hit for rays[i] in hits[i]. The rays are sorted by the grid cell they start in, so
+	//rays starting near each other walk the same cells one after the other, and split between the world's threads
+	void RayCast(const std::vector<Ray> &rays, std::vector<RayHit> &hits);
+
+	//fills shapes with every shape overlapping the region (touching counts) that filter lets through, as a shape's would,
+	//numbered as for RayCast and in order. Sensors are included. Candidates come from the grids by their bounds and are
+	//then tested exactly. Nothing is allocated once shapes and the world's own buffer have grown to fit the most found.
+	//Returns the number found
+	unsigned QueryRegion(const AABB &region, std::vector<unsigned> &shapes, const CollisionFilter &filter = CollisionFilter());
+
+	//the first shape the swept box or circle would hit moving along its translation without turning, into hit: the
+	//fraction of the translation it can move before coming within castTolerance, the normal facing back at it and the
+	//point on the shape hit. Shapes it starts out overlapping or only slides along are passed through (see
+	//CollisionDetector::SweptShapeAndShape). The grids prune the shapes by the bounds of the whole sweep
+	bool ShapeCast(const SweptShape &swept, RayHit &hit);
+	bool ShapeCast(const Box &box, const Vector2 &translation, RayHit &hit) { return ShapeCast(SweptShape(box, translation), hit); }
+	bool ShapeCast(const Circle &circle, const Vector2 &translation, RayHit &hit) { return ShapeCast(SweptShape(circle, translation), hit); }
+
+	//every shape under the point, as QueryRegion
+	unsigned QueryPoint(const Vector2 &point, std::vector<unsigned> &shapes, const CollisionFilter &filter = CollisionFilter());
+
+	//queries go by the grids as they were at the end of the last step, rebuilt before the first query after it.
+	//Adding and removing shapes rebuilds them already, but moving shapes by hand needs this calling first
+	void UpdateQueries() { queryReady = false; }
+
+	void SetSettings(const WorldSettings &newSettings);
+
+	// History
+	//what a step leaves behind for the next one besides the bodies: the contacts, and the overlapping pairs, contact
+	//graph and sensor events the next step's are compared with, the narrowphase's caches, the last health reading
+	//(which the energy alarm is checked against) and the settings. Saving it before stepping the scene on trial, then
+	//putting the bodies back and restoring it, lets the world carry on as if the trial had never been run - so long as
+	//no shapes were added or removed in between
+	struct History;
+	void SaveHistory(History &history) const;
+
+	//restores the history and its settings. Restore the bodies first, as the static shapes are rebuilt from them
+	void RestoreHistory(const History &history);
+
+private:
+	// Cached Pair
+	struct CachedPair
+	{
+		ShapePair pair;
+		PairCache cache;
+	};
+
+	// Chunk
+	//a run of shapes handled as one task, with its own buffers so threads never share one
+	struct Chunk
+	{
+		std::vector<ShapePair> pairs;
+		std::vector<Contact> contacts;
+		std::vector<ShapePair> contactPairs;	//the pair each contact is between, when tracking contacts
+		std::vector<ShapePair> sensorPairs;		//sensors and the shapes overlapping them
+		HealthReading health;
+
+		//pairs of a static shape and a movable one after it belong to the static shape's chunk, but are found by the
+		//movable one's. They are passed from the finding chunk's earlierPairs to the owning chunk's staticPairs
+		std::vector<ShapePair> earlierPairs;
+		std::vector<ShapePair> staticPairs;
+
+		//what the narrowphase found for each box pair (see PairCache), in pair order - this step's, and last step's being
+		//read from
+		std::vector<CachedPair> cached;
+		std::vector<CachedPair> lastCached;
+
+		//whether any of the chunk's shapes has a collision filter that rules anything out
+		bool filtered;
+
+		//whether any of the chunk's shapes is a sensor
+		bool sensed;
+	};
+
+	// Query Scratch
+	//a thread's working space for queries. A shape is tested once per query, however many of the cells the query walks
+	//it is in: stamps[shape] is set to stamp when it is tested, and stamp goes up by one for each query
+	struct QueryScratch
+	{
+		std::vector<unsigned> stamps;
+		unsigned stamp;
+
+		QueryScratch(): stamp(0) {}
+	};
+
+	// Plane
+	//a halfspace as floats, for ruling out shapes by their bounds before the narrowphase
+	struct Plane
+	{
+		float normalX, normalY;
+		float absoluteX, absoluteY;		//size of the normal along each axis
+		float offset;
+	};
+
+	//number of shapes in each chunk
+	static const unsigned chunkSize = 256;
+
+	//room made for each shape's pairs (besides the halfspaces) and contacts whenever the number of shapes changes, so
+	//the buffers don't keep growing as a scene settles into contact. Anything past this grows the buffers as usual
+	static const unsigned reservedPairsPerShape = 16;
+	static const unsigned reservedContactsPerShape = 4;
+
+	//shapes that go through the broadphase are numbered boxes first, then circles, then polygons. Halfspaces are
+	//infinite so never go in it; a pair with b at or past the number of shapes is a shape against halfspace b-shapes
+	unsigned ShapeCount() const { return objects.FiniteSize(); }
+	unsigned ChunkCount() const { return (ShapeCount() + chunkSize-1) / chunkSize; }
+
+	Body* GetBodyOf(const unsigned index) const;
+
+	//shapes have been added or removed, which renumbers them
+	void ShapesChanged() { staticChanged = true; renumbered = true; queryReady = false; }
+
+	//numbered like pairs, so halfspaces come after the boxes, circles and polygons
+	const CollisionFilter& GetFilterOf(const unsigned index) const;
+
+	//grows the pair and contact buffers to fit the number of shapes
+	void ReserveBuffers();
+
+	//measures every subsystem's memory into the footprint, keeping the peaks
+	void UpdateMemoryFootprint();
+
+	//sorts out which shapes are static and files them, and turns the halfspaces into planes
+	void BuildStatic();
+
+	//appends a pair for every halfspace the shape's bounds reach, in halfspace order
+	void AddHalfSpacePairs(const unsigned index, std::vector<ShapePair> &pairs) const;
+
+	//hands every chunk's earlierPairs to the chunks they belong in, and merges them into those chunks' pairs
+	void MergeStaticPairs();
+
+	//drops the pairs from start on that the shapes' collision filters rule out
+	void FilterPairs(std::vector<ShapePair> &pairs, const size_t start) const;
+
+	//brings the overlapping pair set up to date with this step's pairs
+	void UpdateOverlappingPairs();
+
+	//rebuilds the contact graph from this step's contacts
+	void UpdateContactGraph();
+
+	//rebuilds the sensor events from this step's sensor overlaps
+	void UpdateSensorEvents();
+
+	//whether any shape is a sensor (the grid broadphase works this out while bounding)
+	bool AnySensors() const;
+
+	//brings the bounds and grids up to date with where the shapes are, if they have moved since the last query
+	void PrepareQueries();
+
+	//RayCast for one of the threads
+	bool CastRay(const Ray &ray, RayHit &hit, const unsigned thread);
+
+	// Phases
+	void Integrate(const Real duration);
+	void UpdateBounds();
+	void FindPairs();
+	void GenerateChunkContacts();
+	void MeasureHealth();
+
+	// Tasks
+	void IntegrateChunk(const unsigned chunk, const Real duration);
+	void BoundChunk(const unsigned chunk);
+	void PairChunk(const unsigned chunk, const unsigned thread);
+	void ContactChunk(const unsigned chunk, const unsigned thread);
+	void HealthChunk(const unsigned chunk);
+	void StaticPairChunk(const unsigned chunk, const unsigned thread);
+
+	WorldSettings settings;
+	ThreadPool *threadPool;
+
+	ObjectList objects;
+
+	//shapes created by the world (deques so references stay good as more are added)
+	std::deque<Box> ownedBoxes;
+	std::deque<Circle> ownedCircles;
+	std::deque<Polygon> ownedPolygons;
+	std::deque<HalfSpace> ownedHalfSpaces;
+
+	//one detector and set of scratch buffers per thread
+	std::vector<CollisionDetector> detectors;
+	std::vector<std::vector<unsigned> > scratch;
+	std::vector<std::vector<ShapePair> > mergeScratch;
+
+	std::vector<AABB> bounds;		//movable shapes only - static ones are left out of the grid
+	UniformGrid grid;
+	std::vector<Chunk> chunks;
+
+	//whether any shape's collision filter rules anything out - pairs are only filtered if so, as usually nothing does
+	bool filtering;
+
+	//whether any shape is a sensor - pairs are only checked for sensors if so
+	bool sensing;
+	ContactGraph sensorGraph;
+	std::vector<ShapePair> sensorPairs;
+
+	PairSet overlapping;
+	std::vector<ShapePair> brutePairs;		//the overlapping pairs the brute force path found, when tracking them
+	ContactGraph contactGraph;
+	std::vector<ShapePair> contactPairs;	//the pair each contact is between, when tracking contacts
+	bool renumbered;	//since the overlapping pairs and contact graph were last updated
+
+	// Queries
+	bool queryReady;	//whether the bounds and grids are where the shapes are now
+	std::vector<QueryScratch> queryScratch;		//one per thread
+	std::vector<unsigned> rayCells;				//the cell each ray of a batch starts in
+	std::vector<unsigned> rayCellStarts;		//where each cell's rays start in rayOrder, plus one on the end
+	std::vector<unsigned> rayOrder;				//ray indices, sorted by cell
+	std::vector<unsigned> staticFound;			//static shapes a region query found in the static grid
+	std::vector<unsigned> castFound;			//shapes a swept shape's bounds reach
+
+	// Static Shapes
+	bool staticChanged;
+	std::vector<unsigned char> immovable;	//1 for each static box, circle or polygon, by shape index
+	std::vector<unsigned> staticShapes;		//shape index of each static box, circle or polygon, in order
+	std::vector<AABB> staticBounds;			//bounds of each of staticShapes
+	UniformGrid staticGrid;
+	std::vector<Plane> planes;				//one per halfspace
+	std::vector<unsigned> slantedPlanes;	//halfspaces whose normals aren't along an axis
+
+	//the four border halfspaces a scene is usually boxed in by are along the axes, and bounds inside these limits
+	//reach none of them - so most shapes get past every border halfspace with one test
+	float borderMinX, borderMinY, borderMaxX, borderMaxY;
+
+	std::vector<Contact> contacts;
+	unsigned reservedShapes;	//number of shapes the buffers were last reserved for
+	uint64_t pairCount;
+	float usedCellSize;
+
+	StepTimes times;
+	StepAllocations allocations;
+	MemoryFootprint memory;
+	HealthReading health;
+
+	//resolution's counters - the contact generation ones are in the detectors
+	StepCounters resolutionCounters;
+
+	//not copyable
+	World(const World&);
+	void operator=(const World&);
+};
+
+struct World::History
+{
+	WorldSettings settings;
+
+	std::vector<Contact> contacts;
+	std::vector<ShapePair> contactPairs;
+	std::vector<ShapePair> sensorPairs;
+	PairSet overlapping;
+	std::vector<ShapePair> brutePairs;		//the overlapping pairs the brute force path found, when tracking them
+	ContactGraph contactGraph;
+	ContactGraph sensorGraph;
+
+	std::vector<std::vector<CachedPair> > cached;	//each chunk's, from the last step
+	std::vector<CollisionDetector> detectors;		//the reference's caches, and the counters
+	StepCounters resolutionCounters;
+
+	HealthReading health;
+	StepTimes times;
+	StepAllocations allocations;
+	uint64_t pairCount;
+	float usedCellSize;
+
+	bool renumbered;
+	bool staticChanged;
+};
+
+#endif //WORLDH
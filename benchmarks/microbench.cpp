@@ -0,0 +1,543 @@
+// Microbenchmarks //
+// Times each narrowphase routine, Box::GetVertices and the Vector2 primitives on their own, and prints one
+// line per case as CSV (or JSON with --json) so results can be kept and compared between changes.
+//
+// usage: microbench [--json] [--fast-trig] [--min-time seconds] [--filter text]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "collision.h"
+
+// Settings //
+//number of different inputs each case cycles through, so nothing can be worked out once and reused
+const unsigned inputCount = 256;
+
+struct BenchSettings
+{
+	bool json;
+	double minTime;		//seconds each case runs for, at least
+	const char *filter;	//only run cases with this in their name
+};
+
+// Results //
+struct BenchResult
+{
+	std::string name;
+	const char *unit;		//what one operation is - a pair of shapes, a box, a vector
+	unsigned long long operations;
+	double nsPerOp;
+};
+
+//everything computed gets added in here, so the compiler can't throw the work away
+volatile float sink;
+
+static float Sum(const std::vector<Contact> &contacts)
+{
+	float total = 0;
+	for (unsigned i = 0; i < contacts.size(); i++)
+	{
+		total += ToFloat(contacts[i].GetContactPoint().x);
+	}
+	return total;
+}
+
+// Timing //
+typedef std::chrono::steady_clock Clock;
+
+//runs body (which does inputCount operations per call) until minTime has passed, keeping the fastest batch
+template <typename Function>
+BenchResult Run(const BenchSettings &settings, const std::string &name, const char *unit, Function body)
+{
+	BenchResult result;
+	result.name = name;
+	result.unit = unit;
+	result.operations = 0;
+
+	//warm caches and branch predictors
+	for (unsigned i = 0; i < 16; i++)
+		body();
+
+	//grow the batch until it takes long enough to time properly
+	unsigned batch = 1;
+	double best = 1e30;
+	double elapsed = 0;
+
+	while (elapsed < settings.minTime)
+	{
+		Clock::time_point start = Clock::now();
+		for (unsigned i = 0; i < batch; i++)
+			body();
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		elapsed += seconds;
+		result.operations += (unsigned long long)batch * inputCount;
+
+		double nsPerOp = seconds * 1e9 / ((double)batch * inputCount);
+		if (seconds > 1e-3 && nsPerOp < best)
+			best = nsPerOp;
+
+		if (seconds < 1e-3)
+			batch *= 2;
+	}
+
+	result.nsPerOp = best < 1e30 ? best : elapsed * 1e9 / result.operations;
+	return result;
+}
+
+// Output //
+void PrintHeader(const BenchSettings &settings)
+{
+	if (settings.json)
+		printf("[\n");
+	else
+		printf("name,unit,trig,operations,ns_per_op,ops_per_sec\n");
+}
+
+void PrintResult(const BenchSettings &settings, const BenchResult &result, bool first)
+{
+	const char *trig = GetTrigMode() == FAST_TRIG ? "fast" : "precise";
+	double perSecond = 1e9 / result.nsPerOp;
+
+	if (settings.json)
+	{
+		printf("%s  {\"name\": \"%s\", \"unit\": \"%s\", \"trig\": \"%s\", \"operations\": %llu, \"ns_per_op\": %.3f, \"ops_per_sec\": %.0f}",
+			first ? "" : ",\n", result.name.c_str(), result.unit, trig, result.operations, result.nsPerOp, perSecond);
+	}
+	else
+	{
+		printf("%s,%s,%s,%llu,%.3f,%.0f\n", result.name.c_str(), result.unit, trig, result.operations, result.nsPerOp, perSecond);
+	}
+	fflush(stdout);
+}
+
+void PrintFooter(const BenchSettings &settings)
+{
+	if (settings.json)
+		printf("\n]\n");
+}
+
+// Scenes //
+//small random offset, so inputs differ without changing whether a case hits or misses
+static float Jitter()
+{
+	return (rand() / (float)RAND_MAX - 0.5f) * 0.02f;
+}
+
+//rotates a position about the world origin, used to turn a whole case round without changing its result
+static Vector2 Turn(Vector2 position, float rotation)
+{
+	position.RotateAboutWorldOrigin(rotation);
+	return position;
+}
+
+struct CirclePairs { std::vector<Circle> one, two; };
+struct BoxPairs { std::vector<Box> one, two; };
+struct BoxCirclePairs { std::vector<Box> box; std::vector<Circle> circle; };
+struct PolygonPairs { std::vector<Polygon> one, two; };
+
+//two unit radius circles, second one offset from the first
+CirclePairs MakeCirclePairs(Vector2 offset)
+{
+	CirclePairs pairs;
+	for (unsigned i = 0; i < inputCount; i++)
+	{
+		Vector2 position(10 + Jitter(), 10 + Jitter());
+		pairs.one.push_back(Circle(position, 1));
+		pairs.two.push_back(Circle(position + offset, 1));
+	}
+	return pairs;
+}
+
+//2x2 box at the origin (turned by frame), and another 2x2 box at offset with its own orientation (also turned by frame)
+BoxPairs MakeBoxPairs(Vector2 offset, float orientation, float frame)
+{
+	BoxPairs pairs;
+	for (unsigned i = 0; i < inputCount; i++)
+	{
+		Vector2 jitter(Jitter(), Jitter());
+		pairs.one.push_back(Box(jitter, 2, 2, frame));
+		pairs.two.push_back(Box(jitter + Turn(offset, frame), 2, 2, orientation + frame));
+	}
+	return pairs;
+}
+
+//2x2 box at the origin and a unit radius circle at offset, both turned by frame
+BoxCirclePairs MakeBoxCirclePairs(Vector2 offset, float frame)
+{
+	BoxCirclePairs pairs;
+	for (unsigned i = 0; i < inputCount; i++)
+	{
+		Vector2 jitter(Jitter(), Jitter());
+		pairs.box.push_back(Box(jitter, 2, 2, frame));
+		pairs.circle.push_back(Circle(jitter + Turn(offset, frame), 1));
+	}
+	return pairs;
+}
+
+//unit radius hexagon at the origin, and another at offset turned by orientation
+PolygonPairs MakePolygonPairs(Vector2 offset, float orientation)
+{
+	PolygonPairs pairs;
+	for (unsigned i = 0; i < inputCount; i++)
+	{
+		Vector2 jitter(Jitter(), Jitter());
+		pairs.one.push_back(Polygon(jitter, 6u, 1, 0));
+		pairs.two.push_back(Polygon(jitter + offset, 6u, 1, orientation));
+	}
+	return pairs;
+}
+
+// Main //
+int main(int argc, char *argv[])
+{
+	BenchSettings settings;
+	settings.json = false;
+	settings.minTime = 0.25;
+	settings.filter = "";
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--json") == 0)
+			settings.json = true;
+		else if (strcmp(argv[i], "--fast-trig") == 0)
+			SetTrigMode(FAST_TRIG);
+		else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+			settings.minTime = atof(argv[++i]);
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			settings.filter = argv[++i];
+		else
+		{
+			fprintf(stderr, "usage: %s [--json] [--fast-trig] [--min-time seconds] [--filter text]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	srand(1);
+
+	std::vector<BenchResult> results;
+	CollisionDetector detector;
+	std::vector<Contact> contacts;
+	contacts.reserve(inputCount);
+
+	//each case is only set up and run if it gets past the filter
+	#define BENCH_CASE(name) if (strstr(name, settings.filter))
+
+	// Circle and Circle
+	{
+		const char *names[2] = {"CircleAndCircle/hit", "CircleAndCircle/miss"};
+		Vector2 offsets[2] = {Vector2(1.5f, 0.2f), Vector2(3, 0.2f)};
+		for (unsigned c = 0; c < 2; c++) BENCH_CASE(names[c])
+		{
+			CirclePairs pairs = MakeCirclePairs(offsets[c]);
+			results.push_back(Run(settings, names[c], "pair", [&]()
+			{
+				contacts.clear();
+				for (unsigned i = 0; i < inputCount; i++)
+					detector.CircleAndCircle(pairs.one[i], pairs.two[i], contacts);
+				sink = sink + Sum(contacts);
+			}));
+		}
+	}
+
+	// Circle and HalfSpace
+	{
+		const char *names[2] = {"CircleAndHalfSpace/hit", "CircleAndHalfSpace/miss"};
+		float heights[2] = {0.5f, 5};
+		HalfSpace ground(Vector2(0, 1), 0);
+		for (unsigned c = 0; c < 2; c++) BENCH_CASE(names[c])
+		{
+			std::vector<Circle> circles;
+			for (unsigned i = 0; i < inputCount; i++)
+				circles.push_back(Circle(Vector2(Jitter(), heights[c] + Jitter()), 1));
+
+			results.push_back(Run(settings, names[c], "pair", [&]()
+			{
+				contacts.clear();
+				for (unsigned i = 0; i < inputCount; i++)
+					detector.CircleAndHalfSpace(circles[i], ground, contacts);
+				sink = sink + Sum(contacts);
+			}));
+		}
+	}
+
+	// Box and HalfSpace
+	{
+		const char *names[4] = {"BoxAndHalfSpace/hit/unrotated", "BoxAndHalfSpace/miss/unrotated", "BoxAndHalfSpace/hit/rotated", "BoxAndHalfSpace/miss/rotated"};
+		float heights[4] = {0.5f, 5, 0.5f, 5};
+		float orientations[4] = {0, 0, 30, 30};
+		HalfSpace ground(Vector2(0, 1), 0);
+		for (unsigned c = 0; c < 4; c++) BENCH_CASE(names[c])
+		{
+			std::vector<Box> boxes;
+			for (unsigned i = 0; i < inputCount; i++)
+				boxes.push_back(Box(Vector2(Jitter(), heights[c] + Jitter()), 2, 2, orientations[c]));
+
+			results.push_back(Run(settings, names[c], "pair", [&]()
+			{
+				contacts.clear();
+				for (unsigned i = 0; i < inputCount; i++)
+					detector.BoxAndHalfSpace(boxes[i], ground, contacts);
+				sink = sink + Sum(contacts);
+			}));
+		}
+	}
+
+	// Box and Circle
+	{
+		//miss/early fails the first half-size test, miss/late gets past it and fails on the closest point
+		const char *names[6] = {"BoxAndCircle/hit/unrotated", "BoxAndCircle/miss/early/unrotated", "BoxAndCircle/miss/late/unrotated",
+			"BoxAndCircle/hit/rotated", "BoxAndCircle/miss/early/rotated", "BoxAndCircle/miss/late/rotated"};
+		Vector2 offsets[3] = {Vector2(1.5f, 0.2f), Vector2(5, 0.2f), Vector2(1.8f, 1.8f)};
+		for (unsigned c = 0; c < 6; c++) BENCH_CASE(names[c])
+		{
+			BoxCirclePairs pairs = MakeBoxCirclePairs(offsets[c % 3], c < 3 ? 0.0f : 30.0f);
+			results.push_back(Run(settings, names[c], "pair", [&]()
+			{
+				contacts.clear();
+				for (unsigned i = 0; i < inputCount; i++)
+					detector.BoxAndCircle(pairs.box[i], pairs.circle[i], contacts);
+				sink = sink + Sum(contacts);
+			}));
+		}
+	}
+
+	// Box and Box
+	{
+		//miss/early separates on the first axis tested, miss/late only on the third
+		const char *names[6] = {"BoxAndBox/hit/unrotated", "BoxAndBox/miss/early/unrotated", "BoxAndBox/miss/late/unrotated",
+			"BoxAndBox/hit/rotated", "BoxAndBox/miss/early/rotated", "BoxAndBox/miss/late/rotated"};
+		Vector2 offsets[3] = {Vector2(1.5f, 0.2f), Vector2(5, 0.2f), Vector2(1.9f, 1.9f)};
+		float orientations[3] = {0, 0, 45};
+		for (unsigned c = 0; c < 6; c++) BENCH_CASE(names[c])
+		{
+			BoxPairs pairs = MakeBoxPairs(offsets[c % 3], orientations[c % 3], c < 3 ? 0.0f : 30.0f);
+			results.push_back(Run(settings, names[c], "pair", [&]()
+			{
+				contacts.clear();
+				for (unsigned i = 0; i < inputCount; i++)
+					detector.BoxAndBox(pairs.one[i], pairs.two[i], contacts);
+				sink = sink + Sum(contacts);
+			}));
+		}
+
+		//miss/late again, passing back the separating axis each pair gave out last time as World does
+		BENCH_CASE("BoxAndBox/miss/late/rotated/cached")
+		{
+			BoxPairs pairs = MakeBoxPairs(offsets[2], orientations[2], 30.0f);
+			std::vector<unsigned> axes(inputCount, CollisionDetector::noCachedAxis);
+			results.push_back(Run(settings, "BoxAndBox/miss/late/rotated/cached", "pair", [&]()
+			{
+				contacts.clear();
+				for (unsigned i = 0; i < inputCount; i++)
+					detector.BoxAndBox(pairs.one[i], pairs.two[i], contacts, axes[i]);
+				sink = sink + Sum(contacts);
+			}));
+		}
+
+		//hit again, but the pairs never move, so after the first pass every call reuses the contact it made then
+		BENCH_CASE("BoxAndBox/hit/rotated/reused")
+		{
+			BoxPairs pairs = MakeBoxPairs(offsets[0], orientations[0], 30.0f);
+			std::vector<PairCache> caches(inputCount);
+			CollisionDetector reusing;
+			reusing.SetContactReuse(true, 0.001f, 0.05f);
+			results.push_back(Run(settings, "BoxAndBox/hit/rotated/reused", "pair", [&]()
+			{
+				contacts.clear();
+				for (unsigned i = 0; i < inputCount; i++)
+					reusing.BoxAndBox(pairs.one[i], pairs.two[i], contacts, caches[i]);
+				sink = sink + Sum(contacts);
+			}));
+		}
+	}
+
+	// Polygon and Polygon
+	{
+		//miss has the bounds overlapping, so it gets as far as GJK. The warm cases pass back the simplex each pair
+		//finished with last time as World does, and the pairs never move, so after the first pass GJK starts where it
+		//ends
+		const char *names[4] = {"PolygonAndPolygon/hit", "PolygonAndPolygon/miss", "PolygonAndPolygon/hit/warm", "PolygonAndPolygon/miss/warm"};
+		Vector2 offsets[2] = {Vector2(1.5f, 0.2f), Vector2(1.5f, 1.5f)};
+		float orientations[2] = {30, 0};
+		for (unsigned c = 0; c < 4; c++) BENCH_CASE(names[c])
+		{
+			PolygonPairs pairs = MakePolygonPairs(offsets[c % 2], orientations[c % 2]);
+			std::vector<SimplexCache> simplices(inputCount);
+			const bool warm = c >= 2;
+			results.push_back(Run(settings, names[c], "pair", [&]()
+			{
+				contacts.clear();
+				for (unsigned i = 0; i < inputCount; i++)
+				{
+					if (warm)
+						detector.PolygonAndPolygon(pairs.one[i], pairs.two[i], contacts, simplices[i]);
+					else
+						detector.PolygonAndPolygon(pairs.one[i], pairs.two[i], contacts);
+				}
+				sink = sink + Sum(contacts);
+			}));
+		}
+	}
+
+	// Sensor Overlap Tests
+	{
+		//the same hits as BoxAndCircle/hit/rotated and BoxAndBox/hit/rotated, answered yes or no without a contact
+		BENCH_CASE("BoxOverlapsCircle/hit/rotated")
+		{
+			BoxCirclePairs pairs = MakeBoxCirclePairs(Vector2(1.5f, 0.2f), 30.0f);
+			results.push_back(Run(settings, "BoxOverlapsCircle/hit/rotated", "pair", [&]()
+			{
+				unsigned overlaps = 0;
+				for (unsigned i = 0; i < inputCount; i++)
+					overlaps += detector.BoxOverlapsCircle(pairs.box[i], pairs.circle[i]);
+				sink = sink + (float)overlaps;
+			}));
+		}
+
+		BENCH_CASE("BoxOverlapsBox/hit/rotated")
+		{
+			BoxPairs pairs = MakeBoxPairs(Vector2(1.5f, 0.2f), 0, 30.0f);
+			results.push_back(Run(settings, "BoxOverlapsBox/hit/rotated", "pair", [&]()
+			{
+				unsigned overlaps = 0;
+				for (unsigned i = 0; i < inputCount; i++)
+					overlaps += detector.BoxOverlapsBox(pairs.one[i], pairs.two[i]);
+				sink = sink + (float)overlaps;
+			}));
+		}
+	}
+
+	// Box::GetVertices
+	{
+		//0, 180 and square 90/270 take the early outs, the rest rotate every vertex. Each pass moves every box a little
+		//first, leaving its orientation alone, so the vertices are worked out again rather than read from the cache
+		const char *names[6] = {"GetVertices/0", "GetVertices/90/square", "GetVertices/180", "GetVertices/270/square", "GetVertices/90/rectangle", "GetVertices/30"};
+		float orientations[6] = {0, 90, 180, 270, 90, 30};
+		float heights[6] = {2, 2, 2, 2, 3, 2};
+		for (unsigned c = 0; c < 6; c++) BENCH_CASE(names[c])
+		{
+			std::vector<Box> boxes;
+			for (unsigned i = 0; i < inputCount; i++)
+				boxes.push_back(Box(Vector2(Jitter(), Jitter()), 2, heights[c], orientations[c]));
+
+			Real nudge = 0.001f;
+			results.push_back(Run(settings, names[c], "box", [&]()
+			{
+				float total = 0;
+				Vector2 vertices[4];
+				nudge = -nudge;
+				for (unsigned i = 0; i < inputCount; i++)
+				{
+					boxes[i].Translate(nudge, 0);
+					boxes[i].GetVertices(vertices);
+					total += ToFloat(vertices[2].x);
+				}
+				sink = sink + total;
+			}));
+		}
+
+		//boxes that haven't moved since their vertices were last worked out, which read them from the cache
+		BENCH_CASE("GetVertices/30/cached")
+		{
+			std::vector<Box> boxes;
+			for (unsigned i = 0; i < inputCount; i++)
+				boxes.push_back(Box(Vector2(Jitter(), Jitter()), 2, 2, 30));
+
+			results.push_back(Run(settings, "GetVertices/30/cached", "box", [&]()
+			{
+				float total = 0;
+				Vector2 vertices[4];
+				for (unsigned i = 0; i < inputCount; i++)
+				{
+					boxes[i].GetVertices(vertices);
+					total += ToFloat(vertices[2].x);
+				}
+				sink = sink + total;
+			}));
+		}
+	}
+
+	// Vector2
+	{
+		std::vector<Vector2> vectors;
+		for (unsigned i = 0; i < inputCount; i++)
+			vectors.push_back(Vector2(1 + Jitter()*100, 2 + Jitter()*100));
+
+		BENCH_CASE("Vector2/Magnitude") results.push_back(Run(settings, "Vector2/Magnitude", "vector", [&]()
+		{
+			Real total = 0;
+			for (unsigned i = 0; i < inputCount; i++)
+				total += vectors[i].Magnitude();
+			sink = sink + ToFloat(total);
+		}));
+
+		BENCH_CASE("Vector2/GetUnit") results.push_back(Run(settings, "Vector2/GetUnit", "vector", [&]()
+		{
+			Real total = 0;
+			for (unsigned i = 0; i < inputCount; i++)
+				total += vectors[i].GetUnit().x;
+			sink = sink + ToFloat(total);
+		}));
+
+		BENCH_CASE("Vector2/Dot") results.push_back(Run(settings, "Vector2/Dot", "vector", [&]()
+		{
+			Real total = 0;
+			for (unsigned i = 0; i < inputCount; i++)
+				total += vectors[i] * vectors[inputCount - 1 - i];
+			sink = sink + ToFloat(total);
+		}));
+
+		BENCH_CASE("Vector2/AddSubtract") results.push_back(Run(settings, "Vector2/AddSubtract", "vector", [&]()
+		{
+			Vector2 total;
+			for (unsigned i = 0; i < inputCount; i++)
+				total += vectors[i] - vectors[inputCount - 1 - i] * 0.5f;
+			sink = sink + ToFloat(total.x);
+		}));
+
+		BENCH_CASE("Vector2/Perpendicular") results.push_back(Run(settings, "Vector2/Perpendicular", "vector", [&]()
+		{
+			Vector2 total;
+			for (unsigned i = 0; i < inputCount; i++)
+				total += vectors[i].Perpendicular();
+			sink = sink + ToFloat(total.x);
+		}));
+
+		BENCH_CASE("Vector2/RotateAboutWorldOrigin") results.push_back(Run(settings, "Vector2/RotateAboutWorldOrigin", "vector", [&]()
+		{
+			Real total = 0;
+			for (unsigned i = 0; i < inputCount; i++)
+			{
+				Vector2 point = vectors[i];
+				point.RotateAboutWorldOrigin((float)i);
+				total += point.x;
+			}
+			sink = sink + ToFloat(total);
+		}));
+
+		std::vector<Vector2> points(inputCount);
+		BENCH_CASE("Vector2/RotatePointsAboutWorldOrigin") results.push_back(Run(settings, "Vector2/RotatePointsAboutWorldOrigin", "vector", [&]()
+		{
+			std::copy(vectors.begin(), vectors.end(), points.begin());
+			RotatePointsAboutWorldOrigin(&points[0], inputCount, 30);
+			sink = sink + ToFloat(points[inputCount/2].x);
+		}));
+	}
+
+	#undef BENCH_CASE
+
+	PrintHeader(settings);
+	for (unsigned i = 0; i < results.size(); i++)
+	{
+		PrintResult(settings, results[i], i == 0);
+	}
+	PrintFooter(settings);
+
+	return 0;
+}
@@ -0,0 +1,765 @@
+// Scaling Benchmark //
+// Generates scenes of increasing size, steps each one for a number of frames and prints one line of CSV per scene
+// size and thread count, with the average time of each phase of a step - to find where the engine stops scaling.
+//
+// usage: scalebench [--layout uniform|clustered|piles|gas] [--bodies 100,1000,...] [--threads 1,2,...]
+//                   [--frames n] [--warmup n] [--broadphase grid|brute] [--cell-size metres]
+//                   [--box-fraction f] [--static-fraction f] [--debris-fraction f] [--sensor-fraction f] [--seed n]
+//                   [--polygon-fraction f] [--dt seconds]
+//                   [--fast-trig] [--output file.csv] [--trace file.json] [--counters] [--check-allocations] [--memory]
+//                   [--metrics file.prom] [--metrics-interval seconds] [--metrics-labels labels] [--health]
+//                   [--tune] [--tune-profiles file] [--reuse-contacts] [--track-pairs]
+//                   [--track-contacts] [--rays n] [--ray-length metres] [--regions n] [--region-size metres]
+//                   [--casts n]
+//
+// --trace records the timed frames of the last run as a Chrome trace (needs a build with PHYSICS_TRACING).
+// --counters adds columns with the per-frame averages of World's step counters: pairs tested and contacts made for
+// each pair type, BoxAndCircle/BoxAndBox rejections, GJK and EPA runs and iterations (and the GJK runs warm started
+// from last step's simplex), pairs whose contacts were reused, and what the resolution did.
+// --check-allocations adds columns with the allocations made by each phase over the timed frames, and exits with 1 if
+// any timed step allocated at all (needs a build with PHYSICS_ALLOCATION_COUNTING).
+// --memory adds columns with the bytes each subsystem of the world held at the end of the run and at its peak, and
+// prints where the bytes in each of the engine's types go (data, pointers, padding) to stderr.
+// --metrics writes the timed frames' step rate, step times and body and contact counts to a Prometheus text file every
+// --metrics-interval seconds (1 by default), with --metrics-labels (e.g. 'instance="a"') added to every metric.
+// --health measures energy, momentum, speed and penetration every step, adding the last frame's readings and the
+// number of frames that raised each alarm (with the default thresholds) to the CSV.
+// --tune times candidate broadphases, cell sizes, margins and thread counts on each scene once it has warmed up, and
+// runs it with the fastest (--threads and --broadphase are only where it starts). With --tune-profiles the choices are
+// loaded from and saved to the file by layout and body count, so a scene is only tuned the first time.
+// --reuse-contacts turns on WorldSettings::reuseContacts, with its default tolerances.
+// --track-pairs turns on WorldSettings::trackPairs, adding columns with the pairs that began and ended overlapping per
+// frame.
+// --track-contacts turns on WorldSettings::trackContacts, adding columns with the contacts (pairs touching) that began
+// and ended per frame.
+// --rays casts that many rays through the scene after every timed step, as one batch, adding columns with the time the
+// batch took and the rays that hit something. They go from random points in the arena to points up to --ray-length
+// metres (20 by default) away along each axis, the same rays every frame.
+// --regions queries that many squares --region-size metres across (10 by default) after every timed step, one at a
+// time, adding columns with the time they took and the shapes found per frame.
+// --casts sweeps that many shapes through the scene after every timed step, one at a time, half of them circles 0.5
+// metres across and half 1 metre boxes at assorted angles, from random points in the arena along vectors up to 5
+// metres along each axis. Adds columns with the time they took and how many hit something per frame.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "scene.h"
+#include "trace.h"
+#include "metrics.h"
+#include "tuner.h"
+
+// Settings //
+struct ScaleSettings
+{
+	SceneSettings scene;
+	std::vector<unsigned> bodies;
+	std::vector<unsigned> threads;		//0 means every hardware thread
+	unsigned frames;
+	unsigned warmup;					//frames stepped before timing starts
+	BroadphaseType broadphase;
+	float cellSize;
+	float duration;						//seconds per step
+	const char *output;
+	const char *trace;
+	bool counters;
+	bool checkAllocations;
+	bool memory;
+	const char *metrics;
+	double metricsInterval;
+	const char *metricsLabels;
+	bool health;
+	bool tune;
+	const char *tuneProfiles;
+	bool reuseContacts;
+	bool trackPairs;
+	bool trackContacts;
+	unsigned rays;						//cast after every timed step
+	float rayLength;
+	unsigned regions;					//queried after every timed step
+	float regionSize;
+	unsigned casts;						//swept after every timed step
+};
+
+//reads a comma separated list of numbers, returning false if there is anything else in it
+static bool ParseList( const char *text, std::vector<unsigned> &list )
+{
+	list.clear();
+
+	while (*text)
+	{
+		char *end;
+		unsigned long value = strtoul(text, &end, 10);
+
+		if (end == text || (*end != ',' && *end != 0))
+			return false;
+
+		list.push_back((unsigned)value);
+		text = *end == ',' ? end + 1 : end;
+	}
+
+	return !list.empty();
+}
+
+// Run //
+struct ScaleResult
+{
+	double pairs;		//averages per frame
+	double contacts;
+	double pairsBegan;
+	double pairsEnded;
+	double contactsBegan;
+	double contactsEnded;
+	double rayTime;		//milliseconds a frame's rays took
+	double rayHits;
+	uint64_t rayAllocations;
+	double regionTime;	//milliseconds a frame's region queries took
+	double regionFound;
+	uint64_t regionAllocations;
+	double castTime;	//milliseconds a frame's shape casts took
+	double castHits;
+	uint64_t castAllocations;
+	StepTimes times;
+	StepCounters counters;	//totals over the timed frames
+	StepAllocations allocations;
+	unsigned allocatingSteps;
+	MemoryFootprint memory;
+	HealthReading health;						//last frame's
+	unsigned alarmSteps[HEALTH_ALARM_COUNT];	//frames that raised each alarm
+	WorldSettings used;							//what the world ran with, after any tuning
+};
+
+//builds the scene fresh and steps it, so every thread count starts from the same state
+static ScaleResult RunScene( const ScaleSettings &settings, const unsigned bodies, const unsigned threads, TuneProfiles &profiles )
+{
+	WorldSettings worldSettings;
+	worldSettings.broadphase = settings.broadphase;
+	worldSettings.cellSize = settings.cellSize;
+	worldSettings.threads = threads;
+	worldSettings.measureHealth = settings.health;
+	worldSettings.reuseContacts = settings.reuseContacts;
+	worldSettings.trackPairs = settings.trackPairs;
+	worldSettings.trackContacts = settings.trackContacts;
+
+	World world(worldSettings);
+
+	SceneSettings sceneSettings = settings.scene;
+	sceneSettings.bodies = bodies;
+	Scene scene = GenerateScene(world, sceneSettings);
+
+	worldSettings.gravity = scene.gravity;
+	world.SetSettings(worldSettings);
+
+	for (unsigned frame = 0; frame < settings.warmup; frame++)
+	{
+		world.Step(settings.duration);
+	}
+
+	if (settings.tune)
+	{
+		char profile[64];
+		snprintf(profile, sizeof(profile), "%s-%u", GetSceneLayoutName(settings.scene.layout), bodies);
+
+		if (ApplyTunedSettings(world, profiles, profile))
+		{
+			TunedSettings tuned;
+			profiles.Find(profile, tuned);
+			fprintf(stderr, "tuned %s over %u candidates: %.4f ms a step, from %.4f ms\n", profile, tuned.candidates,
+				tuned.stepTime, tuned.startingStepTime);
+		}
+
+		const WorldSettings &tuned = world.GetSettings();
+		fprintf(stderr, "%s: broadphase %s, cell size %g, margin %g, %u threads\n", profile, tuned.broadphase == UNIFORM_GRID ? "grid" : "brute",
+			ToFloat(tuned.cellSize), ToFloat(tuned.aabbMargin), tuned.threads);
+	}
+
+	std::vector<Ray> rays;
+	std::vector<RayHit> hits;
+	GenerateRays(scene, settings.rays, settings.rayLength, sceneSettings.seed, rays);
+
+	std::vector<AABB> regions;
+	std::vector<unsigned> found;
+	GenerateRegions(scene, settings.regions, settings.regionSize, sceneSettings.seed, regions);
+
+	//shapes to sweep, made up front as each has a body of its own
+	std::vector<Ray> castPaths;
+	std::vector<SweptShape> casts;
+	std::deque<Box> castBoxes;
+	std::deque<Circle> castCircles;
+	GenerateRays(scene, settings.casts, 5, sceneSettings.seed + 1, castPaths);
+
+	for (unsigned i = 0; i < castPaths.size(); i++)
+	{
+		const Vector2 translation = castPaths[i].to - castPaths[i].from;
+
+		if (i % 2 == 0)
+		{
+			castCircles.push_back(Circle(castPaths[i].from, 0.5f));
+			casts.push_back(SweptShape(castCircles.back(), translation));
+		}
+		else
+		{
+			castBoxes.push_back(Box(castPaths[i].from, 1, 1, (Real)(i * 37 % 360)));
+			casts.push_back(SweptShape(castBoxes.back(), translation));
+		}
+	}
+
+	//the first batch sizes the buffers
+	RayHit castHit;
+	if (!rays.empty())
+		world.RayCast(rays, hits);
+	for (unsigned i = 0; i < regions.size(); i++)
+		world.QueryRegion(regions[i], found);
+	for (unsigned i = 0; i < casts.size(); i++)
+		world.ShapeCast(casts[i], castHit);
+
+	ScaleResult result;
+	result.used = world.GetSettings();
+	result.pairs = 0;
+	result.contacts = 0;
+	result.pairsBegan = 0;
+	result.pairsEnded = 0;
+	result.contactsBegan = 0;
+	result.contactsEnded = 0;
+	result.rayTime = 0;
+	result.rayHits = 0;
+	result.rayAllocations = 0;
+	result.regionTime = 0;
+	result.regionFound = 0;
+	result.regionAllocations = 0;
+	result.castTime = 0;
+	result.castHits = 0;
+	result.castAllocations = 0;
+	result.allocatingSteps = 0;
+	for (unsigned alarm = 0; alarm < HEALTH_ALARM_COUNT; alarm++)
+		result.alarmSteps[alarm] = 0;
+
+	//only the timed frames of the last scene end up in the trace
+	if (settings.trace)
+	{
+		ClearTrace();
+		SetTracing(true);
+	}
+
+	MetricsExporter *metrics = NULL;
+	if (settings.metrics)
+	{
+		//each run gets labels of its own so they can be told apart
+		char runLabels[128];
+		snprintf(runLabels, sizeof(runLabels), "layout=\"%s\",bodies=\"%u\",threads=\"%u\"", GetSceneLayoutName(settings.scene.layout), bodies, threads);
+
+		std::string labels = settings.metricsLabels;
+		labels += labels.empty() ? runLabels : std::string(",") + runLabels;
+		metrics = new MetricsExporter(settings.metrics, settings.metricsInterval, labels);
+	}
+
+	for (unsigned frame = 0; frame < settings.frames; frame++)
+	{
+		world.Step(settings.duration);
+
+		if (metrics)
+			metrics->Record(world);
+
+		const StepTimes &times = world.GetStepTimes();
+		result.times.integrate += times.integrate;
+		result.times.broadphase += times.broadphase;
+		result.times.narrowphase += times.narrowphase;
+		result.times.resolution += times.resolution;
+		result.times.total += times.total;
+		result.pairs += world.GetPairCount();
+		result.contacts += world.GetContacts().size();
+		result.pairsBegan += world.GetOverlappingPairs().GetBegan().size();
+		result.pairsEnded += world.GetOverlappingPairs().GetEnded().size();
+		result.contactsBegan += world.GetContactGraph().GetPairCount(CONTACT_BEGAN);
+		result.contactsEnded += world.GetContactGraph().GetPairCount(CONTACT_ENDED);
+
+		if (!rays.empty())
+		{
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			const uint64_t startAllocations = GetAllocationCounts().allocations;
+			world.RayCast(rays, hits);
+			result.rayAllocations += GetAllocationCounts().allocations - startAllocations;
+			result.rayTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			for (unsigned i = 0; i < hits.size(); i++)
+				result.rayHits += hits[i].IsHit();
+		}
+
+		if (!regions.empty())
+		{
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			const uint64_t startAllocations = GetAllocationCounts().allocations;
+
+			for (unsigned i = 0; i < regions.size(); i++)
+				result.regionFound += world.QueryRegion(regions[i], found);
+
+			result.regionAllocations += GetAllocationCounts().allocations - startAllocations;
+			result.regionTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		if (!casts.empty())
+		{
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			const uint64_t startAllocations = GetAllocationCounts().allocations;
+
+			for (unsigned i = 0; i < casts.size(); i++)
+				result.castHits += world.ShapeCast(casts[i], castHit);
+
+			result.castAllocations += GetAllocationCounts().allocations - startAllocations;
+			result.castTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		//after the queries, which count until the next step
+		result.counters.Add(world.GetCounters());
+
+		const StepAllocations &allocations = world.GetStepAllocations();
+		result.allocations.integrate += allocations.integrate;
+		result.allocations.broadphase += allocations.broadphase;
+		result.allocations.narrowphase += allocations.narrowphase;
+		result.allocations.resolution += allocations.resolution;
+		result.allocations.total += allocations.total;
+		if (allocations.total > 0)
+			result.allocatingSteps++;
+
+		for (unsigned alarm = 0; alarm < HEALTH_ALARM_COUNT; alarm++)
+		{
+			if (world.GetHealth().alarms & (1 << alarm))
+				result.alarmSteps[alarm]++;
+		}
+	}
+
+	SetTracing(false);
+
+	//writes out the last part-interval too
+	if (metrics)
+		metrics->Flush(world);
+	delete metrics;
+
+	//shapes don't delete their bodies
+	for (unsigned i = 0; i < castBoxes.size(); i++)
+		delete castBoxes[i].GetBody();
+	for (unsigned i = 0; i < castCircles.size(); i++)
+		delete castCircles[i].GetBody();
+
+	result.memory = world.GetMemoryFootprint();
+	result.health = world.GetHealth();
+
+	const double frames = settings.frames > 0 ? settings.frames : 1;
+	result.pairs /= frames;
+	result.contacts /= frames;
+	result.pairsBegan /= frames;
+	result.pairsEnded /= frames;
+	result.contactsBegan /= frames;
+	result.contactsEnded /= frames;
+	result.rayTime /= frames;
+	result.rayHits /= frames;
+	result.regionTime /= frames;
+	result.regionFound /= frames;
+	result.castTime /= frames;
+	result.castHits /= frames;
+	result.times.integrate /= frames;
+	result.times.broadphase /= frames;
+	result.times.narrowphase /= frames;
+	result.times.resolution /= frames;
+	result.times.total /= frames;
+
+	return result;
+}
+
+// Counters //
+static void PrintCounterHeader( FILE *file )
+{
+	for (unsigned type = 0; type < PAIR_TYPE_COUNT; type++)
+	{
+		fprintf(file, ",%s_tested,%s_contacts", GetPairTypeName((PairType)type), GetPairTypeName((PairType)type));
+	}
+
+	fprintf(file, ",box_circle_extent_rejects,box_circle_distance_rejects");
+	fprintf(file, ",box_box_rejects_a_x,box_box_rejects_a_y,box_box_rejects_b_x,box_box_rejects_b_y,box_box_cached_rejects");
+	fprintf(file, ",gjk_runs,gjk_iterations,gjk_warm_starts,epa_runs,epa_iterations");
+
+	for (unsigned type = 0; type < PAIR_TYPE_COUNT; type++)
+	{
+		fprintf(file, ",%s_reused", GetPairTypeName((PairType)type));
+	}
+
+	fprintf(file, ",sensor_pairs_tested,sensor_overlaps,ray_tests,ray_hits,region_tests,region_overlaps,cast_tests,cast_hits");
+
+	fprintf(file, ",position_resolutions,velocity_resolutions,bodies_moved,impulses_applied");
+}
+
+//averages per frame, in the same order as the header
+static void PrintCounters( FILE *file, const StepCounters &counters, const unsigned frames )
+{
+	const double divisor = frames > 0 ? frames : 1;
+
+	for (unsigned type = 0; type < PAIR_TYPE_COUNT; type++)
+	{
+		fprintf(file, ",%.1f,%.1f", counters.pairsTested[type] / divisor, counters.contacts[type] / divisor);
+	}
+
+	fprintf(file, ",%.1f,%.1f", counters.boxCircleRejects[0] / divisor, counters.boxCircleRejects[1] / divisor);
+
+	for (unsigned axis = 0; axis < 4; axis++)
+	{
+		fprintf(file, ",%.1f", counters.boxBoxRejects[axis] / divisor);
+	}
+	fprintf(file, ",%.1f", counters.boxBoxCachedRejects / divisor);
+	fprintf(file, ",%.1f,%.1f,%.1f", counters.gjkRuns / divisor, counters.gjkIterations / divisor, counters.gjkWarmStarts / divisor);
+	fprintf(file, ",%.1f,%.1f", counters.epaRuns / divisor, counters.epaIterations / divisor);
+
+	for (unsigned type = 0; type < PAIR_TYPE_COUNT; type++)
+	{
+		fprintf(file, ",%.1f", counters.pairsReused[type] / divisor);
+	}
+
+	fprintf(file, ",%.1f,%.1f", counters.sensorPairsTested / divisor, counters.sensorOverlaps / divisor);
+	fprintf(file, ",%.1f,%.1f", counters.rayTests / divisor, counters.rayHits / divisor);
+	fprintf(file, ",%.1f,%.1f", counters.regionTests / divisor, counters.regionOverlaps / divisor);
+	fprintf(file, ",%.1f,%.1f", counters.castTests / divisor, counters.castHits / divisor);
+
+	fprintf(file, ",%.1f,%.1f,%.1f,%.1f", counters.positionResolutions / divisor, counters.velocityResolutions / divisor,
+		counters.bodiesMoved / divisor, counters.impulsesApplied / divisor);
+}
+
+// Memory //
+static void PrintMemoryHeader( FILE *file )
+{
+	fprintf(file, ",bodies_bytes,bodies_peak_bytes,shapes_bytes,shapes_peak_bytes,contacts_bytes,contacts_peak_bytes");
+	fprintf(file, ",broadphase_bytes,broadphase_peak_bytes,total_bytes,total_peak_bytes");
+}
+
+static void PrintMemory( FILE *file, const MemoryFootprint &memory )
+{
+	const MemoryUse *uses[] = {&memory.bodies, &memory.shapes, &memory.contacts, &memory.broadphase};
+
+	for (unsigned i = 0; i < sizeof(uses) / sizeof(uses[0]); i++)
+	{
+		fprintf(file, ",%llu,%llu", (unsigned long long)uses[i]->live, (unsigned long long)uses[i]->peak);
+	}
+
+	fprintf(file, ",%llu,%llu", (unsigned long long)memory.TotalLive(), (unsigned long long)memory.TotalPeak());
+}
+
+//to stderr, so it stays out of the CSV
+static void PrintTypeLayouts()
+{
+	std::vector<TypeLayout> layouts = GetTypeLayouts();
+
+	fprintf(stderr, "%-24s %6s %6s %9s %8s\n", "type", "bytes", "data", "pointers", "padding");
+	for (unsigned i = 0; i < layouts.size(); i++)
+	{
+		fprintf(stderr, "%-24s %6u %6u %9u %8u\n", layouts[i].name, (unsigned)layouts[i].size, (unsigned)layouts[i].data,
+			(unsigned)layouts[i].pointers, (unsigned)layouts[i].padding);
+	}
+	fprintf(stderr, "\n");
+}
+
+// Health //
+static void PrintHealthHeader( FILE *file )
+{
+	fprintf(file, ",kinetic_energy,rotational_energy,momentum_x,momentum_y,max_speed,max_penetration");
+
+	for (unsigned alarm = 0; alarm < HEALTH_ALARM_COUNT; alarm++)
+	{
+		fprintf(file, ",%s_alarm_frames", GetHealthAlarmName((HealthAlarm)(1 << alarm)));
+	}
+}
+
+static void PrintHealth( FILE *file, const ScaleResult &result )
+{
+	fprintf(file, ",%g,%g,%g,%g,%g,%g", result.health.kineticEnergy, result.health.rotationalEnergy, result.health.momentumX,
+		result.health.momentumY, result.health.maxSpeed, result.health.maxPenetration);
+
+	for (unsigned alarm = 0; alarm < HEALTH_ALARM_COUNT; alarm++)
+	{
+		fprintf(file, ",%u", result.alarmSteps[alarm]);
+	}
+}
+
+// Main //
+int main(int argc, char *argv[])
+{
+	ScaleSettings settings;
+	settings.bodies.push_back(100);
+	settings.bodies.push_back(1000);
+	settings.bodies.push_back(10000);
+	settings.bodies.push_back(100000);
+	settings.threads.push_back(1);
+	settings.frames = 100;
+	settings.warmup = 10;
+	settings.broadphase = UNIFORM_GRID;
+	settings.cellSize = 0;
+	settings.duration = 1.0f / 60;
+	settings.output = NULL;
+	settings.trace = NULL;
+	settings.counters = false;
+	settings.checkAllocations = false;
+	settings.memory = false;
+	settings.metrics = NULL;
+	settings.metricsInterval = 1;
+	settings.metricsLabels = "";
+	settings.health = false;
+	settings.tune = false;
+	settings.tuneProfiles = NULL;
+	settings.reuseContacts = false;
+	settings.trackPairs = false;
+	settings.trackContacts = false;
+	settings.rays = 0;
+	settings.rayLength = 20;
+	settings.regions = 0;
+	settings.regionSize = 10;
+	settings.casts = 0;
+
+	bool valid = true;
+
+	for (int i = 1; i < argc && valid; i++)
+	{
+		const bool hasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--layout") == 0 && hasValue)
+			valid = ParseSceneLayout(argv[++i], settings.scene.layout);
+		else if (strcmp(argv[i], "--bodies") == 0 && hasValue)
+			valid = ParseList(argv[++i], settings.bodies);
+		else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+			valid = ParseList(argv[++i], settings.threads);
+		else if (strcmp(argv[i], "--frames") == 0 && hasValue)
+			settings.frames = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--warmup") == 0 && hasValue)
+			settings.warmup = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--broadphase") == 0 && hasValue)
+		{
+			i++;
+			if (strcmp(argv[i], "grid") == 0)
+				settings.broadphase = UNIFORM_GRID;
+			else if (strcmp(argv[i], "brute") == 0)
+				settings.broadphase = BRUTE_FORCE;
+			else
+				valid = false;
+		}
+		else if (strcmp(argv[i], "--cell-size") == 0 && hasValue)
+			settings.cellSize = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--box-fraction") == 0 && hasValue)
+			settings.scene.boxFraction = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--polygon-fraction") == 0 && hasValue)
+			settings.scene.polygonFraction = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--static-fraction") == 0 && hasValue)
+			settings.scene.staticFraction = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--debris-fraction") == 0 && hasValue)
+			settings.scene.debrisFraction = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--sensor-fraction") == 0 && hasValue)
+			settings.scene.sensorFraction = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+			settings.scene.seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--dt") == 0 && hasValue)
+			settings.duration = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--fast-trig") == 0)
+			SetTrigMode(FAST_TRIG);
+		else if (strcmp(argv[i], "--output") == 0 && hasValue)
+			settings.output = argv[++i];
+		else if (strcmp(argv[i], "--trace") == 0 && hasValue)
+			settings.trace = argv[++i];
+		else if (strcmp(argv[i], "--counters") == 0)
+			settings.counters = true;
+		else if (strcmp(argv[i], "--check-allocations") == 0)
+			settings.checkAllocations = true;
+		else if (strcmp(argv[i], "--memory") == 0)
+			settings.memory = true;
+		else if (strcmp(argv[i], "--metrics") == 0 && hasValue)
+			settings.metrics = argv[++i];
+		else if (strcmp(argv[i], "--metrics-interval") == 0 && hasValue)
+			settings.metricsInterval = atof(argv[++i]);
+		else if (strcmp(argv[i], "--metrics-labels") == 0 && hasValue)
+			settings.metricsLabels = argv[++i];
+		else if (strcmp(argv[i], "--health") == 0)
+			settings.health = true;
+		else if (strcmp(argv[i], "--tune") == 0)
+			settings.tune = true;
+		else if (strcmp(argv[i], "--tune-profiles") == 0 && hasValue)
+			settings.tuneProfiles = argv[++i];
+		else if (strcmp(argv[i], "--reuse-contacts") == 0)
+			settings.reuseContacts = true;
+		else if (strcmp(argv[i], "--track-pairs") == 0)
+			settings.trackPairs = true;
+		else if (strcmp(argv[i], "--track-contacts") == 0)
+			settings.trackContacts = true;
+		else if (strcmp(argv[i], "--rays") == 0 && hasValue)
+			settings.rays = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--ray-length") == 0 && hasValue)
+			settings.rayLength = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--regions") == 0 && hasValue)
+			settings.regions = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--region-size") == 0 && hasValue)
+			settings.regionSize = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--casts") == 0 && hasValue)
+			settings.casts = atoi(argv[++i]);
+		else
+			valid = false;
+	}
+
+	if (!valid)
+	{
+		fprintf(stderr, "usage: %s [--layout uniform|clustered|piles|gas] [--bodies 100,1000,...] [--threads 1,2,...]\n"
+			"       [--frames n] [--warmup n] [--broadphase grid|brute] [--cell-size metres]\n"
+			"       [--box-fraction f] [--static-fraction f] [--debris-fraction f] [--sensor-fraction f] [--seed n]\n"
+			"       [--polygon-fraction f] [--dt seconds]\n"
+			"       [--fast-trig] [--output file.csv] [--trace file.json] [--counters] [--check-allocations] [--memory]\n"
+			"       [--metrics file.prom] [--metrics-interval seconds] [--metrics-labels labels] [--health]\n"
+			"       [--tune] [--tune-profiles file] [--reuse-contacts] [--track-pairs]\n"
+			"       [--track-contacts] [--rays n] [--ray-length metres] [--regions n] [--region-size metres]\n"
+			"       [--casts n]\n", argv[0]);
+		return 1;
+	}
+
+	if (settings.checkAllocations && !IsCountingAllocations())
+	{
+		fprintf(stderr, "--check-allocations needs a build with PHYSICS_ALLOCATION_COUNTING\n");
+		return 1;
+	}
+
+	if (settings.memory)
+		PrintTypeLayouts();
+
+	//a missing file is fine, it is written at the end
+	TuneProfiles profiles;
+	if (settings.tuneProfiles)
+		profiles.Load(settings.tuneProfiles);
+
+	FILE *file = stdout;
+	if (settings.output)
+	{
+		file = fopen(settings.output, "w");
+		if (!file)
+		{
+			fprintf(stderr, "could not open %s\n", settings.output);
+			return 1;
+		}
+	}
+
+	fprintf(file, "layout,bodies,threads,broadphase,frames,pairs,contacts,integrate_ms,broadphase_ms,narrowphase_ms,resolution_ms,step_ms,steps_per_sec");
+	if (settings.counters)
+		PrintCounterHeader(file);
+	if (settings.checkAllocations)
+		fprintf(file, ",integrate_allocs,broadphase_allocs,narrowphase_allocs,resolution_allocs,step_allocs,allocating_steps");
+	if (settings.memory)
+		PrintMemoryHeader(file);
+	if (settings.health)
+		PrintHealthHeader(file);
+	if (settings.trackPairs)
+		fprintf(file, ",pairs_began,pairs_ended");
+	if (settings.trackContacts)
+		fprintf(file, ",contacts_began,contacts_ended");
+	if (settings.rays > 0)
+		fprintf(file, ",rays,ray_ms,ray_hits%s", settings.checkAllocations ? ",ray_allocs" : "");
+	if (settings.regions > 0)
+		fprintf(file, ",regions,region_ms,region_found%s", settings.checkAllocations ? ",region_allocs" : "");
+	if (settings.casts > 0)
+		fprintf(file, ",casts,cast_ms,cast_hits%s", settings.checkAllocations ? ",cast_allocs" : "");
+	fprintf(file, "\n");
+
+	bool allocated = false;
+
+	for (unsigned b = 0; b < settings.bodies.size(); b++)
+	{
+		//tuning picks the thread count, so each scene is only run once
+		const unsigned threadRuns = settings.tune ? 1 : (unsigned)settings.threads.size();
+
+		for (unsigned t = 0; t < threadRuns; t++)
+		{
+			const unsigned threads = settings.threads[t] > 0 ? settings.threads[t] : ThreadPool::HardwareThreads();
+
+			//progress goes to stderr so it doesn't end up in the CSV
+			fprintf(stderr, "%s: %u bodies, %u threads...\n", GetSceneLayoutName(settings.scene.layout), settings.bodies[b], threads);
+
+			ScaleResult result = RunScene(settings, settings.bodies[b], threads, profiles);
+
+			fprintf(file, "%s,%u,%u,%s,%u,%.1f,%.1f,%.4f,%.4f,%.4f,%.4f,%.4f,%.2f",
+				GetSceneLayoutName(settings.scene.layout), settings.bodies[b], result.used.threads,
+				result.used.broadphase == UNIFORM_GRID ? "grid" : "brute", settings.frames,
+				result.pairs, result.contacts,
+				result.times.integrate, result.times.broadphase, result.times.narrowphase, result.times.resolution,
+				result.times.total, result.times.total > 0 ? 1000.0 / result.times.total : 0.0);
+			if (settings.counters)
+				PrintCounters(file, result.counters, settings.frames);
+			if (settings.checkAllocations)
+			{
+				fprintf(file, ",%llu,%llu,%llu,%llu,%llu,%u", (unsigned long long)result.allocations.integrate,
+					(unsigned long long)result.allocations.broadphase, (unsigned long long)result.allocations.narrowphase,
+					(unsigned long long)result.allocations.resolution, (unsigned long long)result.allocations.total,
+					result.allocatingSteps);
+				allocated = allocated || result.allocatingSteps > 0;
+			}
+			if (settings.memory)
+				PrintMemory(file, result.memory);
+			if (settings.health)
+				PrintHealth(file, result);
+			if (settings.trackPairs)
+				fprintf(file, ",%.1f,%.1f", result.pairsBegan, result.pairsEnded);
+			if (settings.trackContacts)
+				fprintf(file, ",%.1f,%.1f", result.contactsBegan, result.contactsEnded);
+			if (settings.rays > 0)
+			{
+				fprintf(file, ",%u,%.4f,%.1f", settings.rays, result.rayTime, result.rayHits);
+				if (settings.checkAllocations)
+				{
+					fprintf(file, ",%llu", (unsigned long long)result.rayAllocations);
+					allocated = allocated || result.rayAllocations > 0;
+				}
+			}
+			if (settings.regions > 0)
+			{
+				fprintf(file, ",%u,%.4f,%.1f", settings.regions, result.regionTime, result.regionFound);
+				if (settings.checkAllocations)
+				{
+					fprintf(file, ",%llu", (unsigned long long)result.regionAllocations);
+					allocated = allocated || result.regionAllocations > 0;
+				}
+			}
+			if (settings.casts > 0)
+			{
+				fprintf(file, ",%u,%.4f,%.1f", settings.casts, result.castTime, result.castHits);
+				if (settings.checkAllocations)
+				{
+					fprintf(file, ",%llu", (unsigned long long)result.castAllocations);
+					allocated = allocated || result.castAllocations > 0;
+				}
+			}
+			fprintf(file, "\n");
+			fflush(file);
+		}
+	}
+
+	if (file != stdout)
+		fclose(file);
+
+	if (settings.tuneProfiles && !profiles.Save(settings.tuneProfiles))
+	{
+		fprintf(stderr, "could not write %s\n", settings.tuneProfiles);
+		return 1;
+	}
+
+	if (settings.trace)
+	{
+#ifndef PHYSICS_TRACING
+		fprintf(stderr, "built without PHYSICS_TRACING, so the trace will be empty\n");
+#endif
+		if (!WriteTrace(settings.trace))
+		{
+			fprintf(stderr, "could not write %s\n", settings.trace);
+			return 1;
+		}
+	}
+
+	if (allocated)
+	{
+		fprintf(stderr, "steps or queries allocated after warming up\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,1108 @@
+// Golden Trajectories //
+// Runs a library of scenes with the reference physics (brute force CollisionDetector::GenerateContacts on one thread,
+// C library sine/cosine), recording every body and contact after every step, then runs each optimised configuration
+// of World on the same scenes and checks it against the reference - bit for bit for the configurations that are meant
+// to be deterministic, within tolerances for the ones that aren't. Exits with 1 if anything doesn't match.
+//
+// usage: golden [--frames n] [--scene name] [--config name] [--record dir] [--golden dir] [--list]
+//
+// Each scene is also put through checks of what World reports besides its bodies and contacts, frame by frame:
+// "tuning" tunes one of two worlds half way through the run and checks neither its bodies nor its pair deltas, contact
+// and sensor events or health alarms come out any different from the other's. "pairs", "contacts" and "sensors" step
+// a grid world and a brute force world side by side and check both against lists worked out apart from the pair set
+// and contact graphs they share: the pairs whose bounds overlap, found by testing every pair, and each shape's contacts
+// or sensor overlaps and events, worked out from the pairs the contacts and overlaps are between. "rays" checks a grid
+// world's ray casts, one at a time and in batches, against CollisionDetector testing every shape, every ten frames,
+// "regions" does the same for its region and point queries and "casts" for its shape casts. "reuse" checks every
+// contact of a world reusing contacts against a fresh narrowphase test of the same shapes: the bodies in the same order
+// exactly, and only reused contacts out by as much as the shapes can drift within reuseDistance and reuseAngle.
+// --config picks a check by name too.
+//
+// --record saves the reference runs to dir/<scene>.traj instead of checking anything, and --golden checks against
+// those saved runs rather than running the reference again - so a change to the reference itself shows up too.
+
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "scene.h"
+#include "trajectory.h"
+#include "tuner.h"
+
+// Scenes //
+struct GoldenScene
+{
+	const char *name;
+	SceneLayout layout;	//ignored for the demo scene
+	unsigned bodies;
+	uint32_t seed;
+	float staticFraction;	//share of the bodies made immovable
+	float debrisFraction;	//share of the movable bodies that don't collide with each other
+	float sensorFraction;	//share of the immovable bodies made sensors
+	float polygonFraction;	//share of the bodies made polygons
+};
+
+//"demo" is the scene from WinMain, everything else comes from GenerateScene
+static const GoldenScene scenes[] =
+{
+	{"demo", UNIFORM_SCENE, 0, 0, 0, 0, 0, 0},
+	{"uniform", UNIFORM_SCENE, 400, 1, 0, 0, 0, 0},
+	{"clustered", CLUSTERED_SCENE, 1500, 2, 0, 0, 0, 0},
+	{"piles", PILES_SCENE, 300, 3, 0, 0, 0, 0},
+	{"gas", GAS_SCENE, 400, 4, 0, 0, 0, 0},
+	{"static", GAS_SCENE, 600, 5, 0.4f, 0, 0, 0},
+	{"debris", PILES_SCENE, 400, 6, 0.2f, 0.5f, 0, 0},
+	{"sensors", GAS_SCENE, 600, 7, 0.4f, 0, 0.5f, 0},
+	{"polygons", PILES_SCENE, 300, 8, 0.1f, 0, 0, 0.5f},
+};
+
+static const unsigned sceneCount = sizeof(scenes) / sizeof(scenes[0]);
+
+//the shapes WinMain starts with, including the user's box, inside the same border
+static Scene BuildDemoScene( World &world )
+{
+	const float width = PixelsToMetres(1200.0f);
+	const float height = PixelsToMetres(800.0f);
+
+	world.Create(HalfSpace(Vector2(0.0f, 1.0f), 1.0f));
+	world.Create(HalfSpace(Vector2(-1.0f, 0.0f), -(width - 1.0f)));
+	world.Create(HalfSpace(Vector2(0.0f, -1.0f), -(height - 2.0f)));
+	world.Create(HalfSpace(Vector2(1.0f, 0.0f), 1.0f));
+
+	world.Create(Circle(Vector2(32, 12), 4.0f));
+	world.Create(Box(Vector2(20, 12), 5, 8));
+
+	Box &box2 = world.Create(Box(Vector2(30, 22), 7, 9));
+	box2.SetVelocity(-10, 0);
+	box2.SetMass(20);
+
+	world.Create(HalfSpace(Vector2(1, 1), 15));
+	world.Create(Box());
+
+	Scene scene;
+	scene.width = width;
+	scene.height = height;
+	scene.gravity = Vector2(0, 0);
+	return scene;
+}
+
+//returns the arena, for the queries
+static Scene BuildScene( World &world, const GoldenScene &scene )
+{
+	Scene arena;
+
+	if (strcmp(scene.name, "demo") == 0)
+	{
+		arena = BuildDemoScene(world);
+	}
+	else
+	{
+		SceneSettings settings;
+		settings.layout = scene.layout;
+		settings.bodies = scene.bodies;
+		settings.seed = scene.seed;
+		settings.staticFraction = scene.staticFraction;
+		settings.debrisFraction = scene.debrisFraction;
+		settings.sensorFraction = scene.sensorFraction;
+		settings.polygonFraction = scene.polygonFraction;
+		arena = GenerateScene(world, settings);
+	}
+
+	WorldSettings worldSettings = world.GetSettings();
+	worldSettings.gravity = arena.gravity;
+	world.SetSettings(worldSettings);
+	return arena;
+}
+
+// Configurations //
+struct GoldenConfig
+{
+	const char *name;
+	WorldSettings settings;
+	TrigMode trig;
+	TrajectoryTolerance tolerance;
+
+	//restart every step from the reference's last frame, so each frame only holds one step's worth of difference.
+	//Needed for anything that isn't exact - collisions are chaotic, so tiny differences grow without limit otherwise
+	bool resync;
+};
+
+static std::vector<GoldenConfig> MakeConfigs()
+{
+	std::vector<GoldenConfig> configs;
+
+	//deterministic - the broadphase and threading must not change a single bit
+	GoldenConfig grid;
+	grid.name = "grid";
+	grid.settings.broadphase = UNIFORM_GRID;
+	grid.trig = PRECISE_TRIG;
+	grid.resync = false;
+	configs.push_back(grid);
+
+	GoldenConfig smallCells = grid;
+	smallCells.name = "grid-small-cells";
+	smallCells.settings.cellSize = 0.75f;
+	configs.push_back(smallCells);
+
+	GoldenConfig threaded = grid;
+	threaded.name = "grid-4-threads";
+	threaded.settings.threads = 4;
+	configs.push_back(threaded);
+
+	//polynomial trig rounds differently, which is fine as long as it stays close
+	GoldenConfig fastTrig = grid;
+	fastTrig.name = "fast-trig";
+	fastTrig.trig = FAST_TRIG;
+	fastTrig.tolerance.exact = false;
+	fastTrig.tolerance.position = 0.01f;
+	fastTrig.tolerance.velocity = 0.05f;
+	fastTrig.tolerance.orientation = 0.1f;
+	fastTrig.tolerance.normal = 0.01f;
+	fastTrig.tolerance.contactMismatches = 4;
+	fastTrig.tolerance.badFrames = 4;
+	fastTrig.resync = true;
+	configs.push_back(fastTrig);
+
+	//reused contacts are out by up to the reuse tolerances, and a pair that was just apart last time it was tested can
+	//touch by less than them without a contact (or the other way round), so a few more contacts are allowed to differ.
+	//The "reuse" check holds each contact to a fresh test of the same shapes, so these only allow for the drift
+	GoldenConfig reuse = fastTrig;
+	reuse.name = "contact-reuse";
+	reuse.trig = PRECISE_TRIG;
+	reuse.settings.reuseContacts = true;
+	reuse.tolerance.contactMismatches = 10;
+	reuse.tolerance.badFrames = 10;
+	configs.push_back(reuse);
+
+	return configs;
+}
+
+// Running //
+//runs the scene for a number of frames, recording each one. If resyncing, each step starts from the frame before it in
+//the reference instead of from where the last step left off
+static void Run( const GoldenScene &scene, const WorldSettings &settings, const TrigMode trig, const unsigned frames, Trajectory &trajectory, const Trajectory *resyncTo )
+{
+	const TrigMode previousTrig = GetTrigMode();
+	SetTrigMode(trig);
+
+	World world(settings);
+	BuildScene(world, scene);
+
+	trajectory.Clear();
+	for (unsigned frame = 0; frame < frames; frame++)
+	{
+		if (resyncTo && frame > 0)
+			resyncTo->Restore(world, frame-1);
+
+		world.Step(1.0f / 60);
+		trajectory.Record(world);
+	}
+
+	SetTrigMode(previousTrig);
+}
+
+static void RunReference( const GoldenScene &scene, const unsigned frames, Trajectory &trajectory )
+{
+	WorldSettings reference;
+	reference.broadphase = BRUTE_FORCE;
+	reference.threads = 1;
+	Run(scene, reference, PRECISE_TRIG, frames, trajectory, NULL);
+}
+
+// Step Comparison //
+//a check's result, passing until a frame doesn't match
+static TrajectoryComparison Passed()
+{
+	TrajectoryComparison result;
+	result.matches = true;
+	result.firstBadFrame = -1;
+	result.badFrames = 0;
+	result.positionError = result.velocityError = result.orientationError = result.normalError = 0;
+	result.contactMismatches = 0;
+	return result;
+}
+
+//counts the frame as bad, keeping the reason if it is the first
+static void Mismatch( TrajectoryComparison &result, const unsigned frame, const std::string &reason )
+{
+	if (result.firstBadFrame < 0)
+	{
+		result.firstBadFrame = frame;
+		result.reason = reason;
+	}
+
+	result.matches = false;
+	result.badFrames++;
+}
+
+//folds a comparison of the two runs' bodies and contacts into a check's result
+static void AddTrajectories( TrajectoryComparison &result, const Trajectory &one, const Trajectory &two )
+{
+	const TrajectoryComparison bodies = CompareTrajectories(one, two, TrajectoryTolerance());
+	if (bodies.matches)
+		return;
+
+	if (result.firstBadFrame < 0 || bodies.firstBadFrame < result.firstBadFrame)
+	{
+		result.firstBadFrame = bodies.firstBadFrame;
+		result.reason = bodies.reason;
+	}
+
+	result.matches = false;
+	result.badFrames = std::max(result.badFrames, bodies.badFrames);
+	result.contactMismatches = bodies.contactMismatches;
+}
+
+static bool SamePair( const ShapePair &one, const ShapePair &two )
+{
+	return one.a == two.a && one.b == two.b;
+}
+
+static bool SamePairs( const std::vector<ShapePair> &one, const std::vector<ShapePair> &two )
+{
+	if (one.size() != two.size())
+		return false;
+
+	for (unsigned i = 0; i < one.size(); i++)
+	{
+		if (!SamePair(one[i], two[i]))
+			return false;
+	}
+
+	return true;
+}
+
+//the first difference between the overlapping pairs and the pairs that began and ended overlapping, or "" if none.
+//Both sets started the same, so matching deltas every step means they hold the same pairs
+static std::string ComparePairSets( const PairSet &one, const PairSet &two )
+{
+	if (one.Size() != two.Size())
+		return "overlapping pair counts differ";
+	if (!SamePairs(one.GetBegan(), two.GetBegan()))
+		return "pairs that began overlapping differ";
+	if (!SamePairs(one.GetEnded(), two.GetEnded()))
+		return "pairs that ended overlapping differ";
+	return "";
+}
+
+//the first difference between each node's contacts and events, or "" if none
+static std::string CompareGraphs( const ContactGraph &one, const ContactGraph &two, const std::string &name )
+{
+	for (unsigned type = 0; type < CONTACT_EVENT_TYPE_COUNT; type++)
+	{
+		if (one.GetPairCount((ContactEventType)type) != two.GetPairCount((ContactEventType)type))
+			return name + " event counts differ";
+	}
+
+	const unsigned nodeCount = std::max(one.GetNodeCount(), two.GetNodeCount());
+
+	for (unsigned node = 0; node < nodeCount; node++)
+	{
+		const unsigned contactCount = one.GetContactCount(node);
+		if (contactCount != two.GetContactCount(node) || (contactCount > 0 && memcmp(one.GetContacts(node), two.GetContacts(node), contactCount*sizeof(unsigned)) != 0))
+			return name + " contacts differ for shape " + std::to_string(node);
+
+		const unsigned eventCount = one.GetEventCount(node);
+		if (eventCount != two.GetEventCount(node))
+			return name + " events differ for shape " + std::to_string(node);
+
+		for (unsigned i = 0; i < eventCount; i++)
+		{
+			if (one.GetEvents(node)[i].other != two.GetEvents(node)[i].other || one.GetEvents(node)[i].type != two.GetEvents(node)[i].type)
+				return name + " events differ for shape " + std::to_string(node);
+		}
+	}
+
+	return "";
+}
+
+//the first difference between what two worlds' last steps reported besides their bodies and contacts, or "" if none
+static std::string CompareSteps( const World &one, const World &two )
+{
+	std::string reason = ComparePairSets(one.GetOverlappingPairs(), two.GetOverlappingPairs());
+	if (reason.empty())
+		reason = CompareGraphs(one.GetContactGraph(), two.GetContactGraph(), "contact");
+	if (reason.empty())
+		reason = CompareGraphs(one.GetSensorEvents(), two.GetSensorEvents(), "sensor");
+	if (reason.empty() && one.GetHealth().alarms != two.GetHealth().alarms)
+		reason = "health alarms differ";
+	return reason;
+}
+
+// Checks //
+//what World reports besides its bodies and contacts, checked against a second world that should report the same or
+//against the brute force detector, frame by frame. Listed and reported like the configurations, with every frame that
+//doesn't match counted as bad
+struct GoldenCheck
+{
+	const char *name;
+	TrajectoryComparison (*run)(const GoldenScene &scene, const unsigned frames);
+};
+
+//tuning half way through the run mustn't change anything the world reports afterwards
+static TrajectoryComparison CheckTuning( const GoldenScene &scene, const unsigned frames )
+{
+	WorldSettings settings;
+	settings.trackPairs = true;
+	settings.trackContacts = true;
+	settings.measureHealth = true;
+
+	World untuned(settings);
+	World tuned(settings);
+	BuildScene(untuned, scene);
+	BuildScene(tuned, scene);
+
+	//short runs of each candidate, on more threads than the world has so the detectors are made and thrown away
+	TuneOptions options;
+	options.steps = 3;
+	options.warmup = 1;
+	options.maxThreads = 4;
+
+	TrajectoryComparison result = Passed();
+	Trajectory one, two;
+
+	for (unsigned frame = 0; frame < frames; frame++)
+	{
+		if (frame == frames/2)
+			TuneWorld(tuned, options);
+
+		untuned.Step(1.0f / 60);
+		tuned.Step(1.0f / 60);
+		one.Record(untuned);
+		two.Record(tuned);
+
+		//the counters show whether the caches were put back too, which the events and bodies needn't
+		std::string reason = CompareSteps(untuned, tuned);
+		const StepCounters untunedCounters = untuned.GetCounters();
+		const StepCounters tunedCounters = tuned.GetCounters();
+		if (reason.empty() && memcmp(&untunedCounters, &tunedCounters, sizeof(StepCounters)) != 0)
+			reason = "step counters differ";
+
+		if (!reason.empty())
+			Mismatch(result, frame, reason);
+	}
+
+	AddTrajectories(result, one, two);
+	return result;
+}
+
+//what the checks against brute force work out for themselves, from the brute force world's shapes, without the pair
+//set and contact graphs both worlds share - comparing the two worlds alone can't show a bug in those
+struct Expected
+{
+	std::vector<ShapePair> pairs;		//the overlapping pairs, in order
+	std::vector<ShapePair> lastPairs;	//and last step's
+	std::vector<ShapePair> touching;	//the pairs with contacts, in order
+	std::vector<ShapePair> lastTouching;
+	std::vector<ShapePair> sensed;		//each sensor and shape overlapping, in order
+	std::vector<ShapePair> lastSensed;
+	unsigned nodeCount;					//shapes, halfspaces included
+};
+
+//steps a grid world and a brute force one side by side with the same settings otherwise. prepare (if any) works out
+//what the brute force world's next step should report before it is taken, and compare checks both worlds against it
+static TrajectoryComparison CheckAgainstBruteForce( const GoldenScene &scene, const unsigned frames, const WorldSettings &settings,
+	void (*prepare)(World &bruteForce, Expected &expected), std::string (*compare)(const World &grid, const World &bruteForce, Expected &expected) )
+{
+	WorldSettings gridSettings = settings;
+	gridSettings.broadphase = UNIFORM_GRID;
+	WorldSettings bruteSettings = settings;
+	bruteSettings.broadphase = BRUTE_FORCE;
+	bruteSettings.threads = 1;
+
+	World grid(gridSettings);
+	World bruteForce(bruteSettings);
+	BuildScene(grid, scene);
+	BuildScene(bruteForce, scene);
+
+	TrajectoryComparison result = Passed();
+	Trajectory one, two;
+	Expected expected;
+	expected.nodeCount = bruteForce.GetObjects().Size();
+
+	for (unsigned frame = 0; frame < frames; frame++)
+	{
+		if (prepare)
+			prepare(bruteForce, expected);
+
+		grid.Step(1.0f / 60);
+		bruteForce.Step(1.0f / 60);
+		one.Record(grid);
+		two.Record(bruteForce);
+
+		const std::string reason = compare(grid, bruteForce, expected);
+		if (!reason.empty())
+			Mismatch(result, frame, reason);
+	}
+
+	AddTrajectories(result, one, two);
+	return result;
+}
+
+//moves the bodies as the world's next step will before it looks for pairs and contacts, keeping where they were
+static void MoveAsStepWill( World &world, std::vector<Body> &saved )
+{
+	ObjectList &objects = world.GetObjects();
+	saved.clear();
+
+	for (unsigned i = 0; i < objects.FiniteSize(); i++)
+	{
+		Body *body = objects.GetShapeAt(i).GetBody();
+		saved.push_back(*body);
+		body->Integrate(1.0f / 60, world.GetSettings().gravity);
+	}
+}
+
+static void PutBack( World &world, const std::vector<Body> &saved )
+{
+	ObjectList &objects = world.GetObjects();
+
+	for (unsigned i = 0; i < objects.FiniteSize(); i++)
+		*objects.GetShapeAt(i).GetBody() = saved[i];
+}
+
+//the pairs whose bounds overlap once the step has moved the shapes, which is when the step looks for them
+static void FindExpectedPairs( World &bruteForce, Expected &expected )
+{
+	std::vector<Body> saved;
+	MoveAsStepWill(bruteForce, saved);
+
+	expected.lastPairs.swap(expected.pairs);
+	expected.pairs.clear();
+	CollisionDetector().FindOverlappingPairs(bruteForce.GetObjects(), bruteForce.GetSettings().aabbMargin, expected.pairs);
+
+	PutBack(bruteForce, saved);
+}
+
+static bool PairBefore( const ShapePair &one, const ShapePair &two )
+{
+	return one.a < two.a || (one.a == two.a && one.b < two.b);
+}
+
+//the pairs in one sorted list but not the other
+static std::vector<ShapePair> PairsOnlyIn( const std::vector<ShapePair> &pairs, const std::vector<ShapePair> &others )
+{
+	std::vector<ShapePair> only;
+	std::set_difference(pairs.begin(), pairs.end(), others.begin(), others.end(), std::back_inserter(only), PairBefore);
+	return only;
+}
+
+//the pair set against the expected pairs: the pairs that began are reported in pair order, and the ones that ended in
+//any order
+static std::string CheckPairSet( const PairSet &pairSet, const Expected &expected, const std::string &name )
+{
+	if (pairSet.Size() != expected.pairs.size())
+		return name + " overlapping pair count is wrong";
+
+	for (unsigned i = 0; i < expected.pairs.size(); i++)
+	{
+		if (!pairSet.Contains(expected.pairs[i].a, expected.pairs[i].b))
+			return name + " is missing an overlapping pair";
+	}
+
+	if (!SamePairs(pairSet.GetBegan(), PairsOnlyIn(expected.pairs, expected.lastPairs)))
+		return name + " pairs that began overlapping are wrong";
+
+	std::vector<ShapePair> ended = pairSet.GetEnded();
+	std::sort(ended.begin(), ended.end(), PairBefore);
+	if (!SamePairs(ended, PairsOnlyIn(expected.lastPairs, expected.pairs)))
+		return name + " pairs that ended overlapping are wrong";
+
+	return "";
+}
+
+static std::string CompareOverlappingPairs( const World &grid, const World &bruteForce, Expected &expected )
+{
+	std::string reason = CheckPairSet(grid.GetOverlappingPairs(), expected, "grid");
+	if (reason.empty())
+		reason = CheckPairSet(bruteForce.GetOverlappingPairs(), expected, "brute force");
+	return reason;
+}
+
+//both worlds' overlapping pairs and their deltas against every pair's bounds tested
+static TrajectoryComparison CheckPairs( const GoldenScene &scene, const unsigned frames )
+{
+	WorldSettings settings;
+	settings.trackPairs = true;
+	settings.threads = 2;
+	return CheckAgainstBruteForce(scene, frames, settings, FindExpectedPairs, CompareOverlappingPairs);
+}
+
+//this step's pairs, once each and in order, keeping last step's
+static void UpdateTouching( const std::vector<ShapePair> &pairs, std::vector<ShapePair> &touching, std::vector<ShapePair> &lastTouching )
+{
+	lastTouching.swap(touching);
+	touching = pairs;
+	std::sort(touching.begin(), touching.end(), PairBefore);
+	touching.erase(std::unique(touching.begin(), touching.end(), SamePair), touching.end());
+}
+
+static bool OtherBefore( const ContactEvent &one, const ContactEvent &two )
+{
+	return one.other < two.other;
+}
+
+//lists each pair's event under both of its shapes
+static void AddEvents( const std::vector<ShapePair> &pairs, const ContactEventType type, std::vector<std::vector<ContactEvent> > &events )
+{
+	for (unsigned i = 0; i < pairs.size(); i++)
+	{
+		const ContactEvent underA = {pairs[i].b, type};
+		events[pairs[i].a].push_back(underA);
+
+		const ContactEvent underB = {pairs[i].a, type};
+		events[pairs[i].b].push_back(underB);
+	}
+}
+
+//a contact graph against what it should hold after an update with pairs (one per contact), worked out a node at a time:
+//its contacts in order, and an event for each pair it is in now or was in last step, in order of the other shape
+static std::string CheckGraph( const ContactGraph &graph, const std::vector<ShapePair> &pairs, const std::vector<ShapePair> &touching,
+	const std::vector<ShapePair> &lastTouching, const unsigned nodeCount, const std::string &name )
+{
+	std::vector<std::vector<unsigned> > contacts(nodeCount);
+
+	for (unsigned i = 0; i < pairs.size(); i++)
+	{
+		contacts[pairs[i].a].push_back(i);
+		contacts[pairs[i].b].push_back(i);
+	}
+
+	std::vector<ShapePair> persisted;
+	std::set_intersection(touching.begin(), touching.end(), lastTouching.begin(), lastTouching.end(), std::back_inserter(persisted), PairBefore);
+
+	const std::vector<ShapePair> pairsOf[CONTACT_EVENT_TYPE_COUNT] = {PairsOnlyIn(touching, lastTouching), persisted, PairsOnlyIn(lastTouching, touching)};
+	std::vector<std::vector<ContactEvent> > events(nodeCount);
+
+	for (unsigned type = 0; type < CONTACT_EVENT_TYPE_COUNT; type++)
+	{
+		if (graph.GetPairCount((ContactEventType)type) != pairsOf[type].size())
+			return name + " event counts are wrong";
+
+		AddEvents(pairsOf[type], (ContactEventType)type, events);
+	}
+
+	//a graph with nothing to report may have been cleared
+	if (graph.GetNodeCount() != nodeCount && (graph.GetNodeCount() != 0 || !touching.empty() || !lastTouching.empty()))
+		return name + " node count is wrong";
+
+	for (unsigned node = 0; node < nodeCount; node++)
+	{
+		const unsigned contactCount = graph.GetContactCount(node);
+		if (contactCount != contacts[node].size() || (contactCount > 0 && memcmp(graph.GetContacts(node), contacts[node].data(), contactCount*sizeof(unsigned)) != 0))
+			return name + " contacts are wrong for shape " + std::to_string(node);
+
+		std::sort(events[node].begin(), events[node].end(), OtherBefore);
+		if (graph.GetEventCount(node) != events[node].size())
+			return name + " events are wrong for shape " + std::to_string(node);
+
+		for (unsigned i = 0; i < events[node].size(); i++)
+		{
+			if (graph.GetEvents(node)[i].other != events[node][i].other || graph.GetEvents(node)[i].type != events[node][i].type)
+				return name + " events are wrong for shape " + std::to_string(node);
+		}
+	}
+
+	return "";
+}
+
+static std::string CompareContactEvents( const World &grid, const World &bruteForce, Expected &expected )
+{
+	const std::vector<ShapePair> &pairs = bruteForce.GetContactPairs();
+	if (!SamePairs(grid.GetContactPairs(), pairs))
+		return "contact pairs differ";
+
+	UpdateTouching(pairs, expected.touching, expected.lastTouching);
+
+	std::string reason = CheckGraph(grid.GetContactGraph(), pairs, expected.touching, expected.lastTouching, expected.nodeCount, "grid contact");
+	if (reason.empty())
+		reason = CheckGraph(bruteForce.GetContactGraph(), pairs, expected.touching, expected.lastTouching, expected.nodeCount, "brute force contact");
+	return reason;
+}
+
+//both worlds' contact graphs against each shape's contacts and the pairs that began, persisted and ended touching
+static TrajectoryComparison CheckContactEvents( const GoldenScene &scene, const unsigned frames )
+{
+	WorldSettings settings;
+	settings.trackContacts = true;
+	settings.threads = 2;
+	return CheckAgainstBruteForce(scene, frames, settings, NULL, CompareContactEvents);
+}
+
+static std::string CompareSensorEvents( const World &grid, const World &bruteForce, Expected &expected )
+{
+	const std::vector<ShapePair> &pairs = bruteForce.GetSensorOverlaps();
+	if (!SamePairs(grid.GetSensorOverlaps(), pairs))
+		return "sensor overlaps differ";
+
+	UpdateTouching(pairs, expected.sensed, expected.lastSensed);
+
+	std::string reason = CheckGraph(grid.GetSensorEvents(), pairs, expected.sensed, expected.lastSensed, expected.nodeCount, "grid sensor");
+	if (reason.empty())
+		reason = CheckGraph(bruteForce.GetSensorEvents(), pairs, expected.sensed, expected.lastSensed, expected.nodeCount, "brute force sensor");
+	return reason;
+}
+
+//the grid's sensor overlaps against brute force's, and both worlds' sensor events against the shapes that entered,
+//stayed in and left each sensor
+static TrajectoryComparison CheckSensorEvents( const GoldenScene &scene, const unsigned frames )
+{
+	WorldSettings settings;
+	settings.threads = 2;
+	return CheckAgainstBruteForce(scene, frames, settings, NULL, CompareSensorEvents);
+}
+
+//steps a grid world through the scene, checking its queries every few frames against the brute force detector's on
+//the same shapes. query runs them, seeded by the frame, and returns the first difference or ""
+static TrajectoryComparison CheckQueries( const GoldenScene &scene, const unsigned frames,
+	std::string (*query)(World &world, const Scene &arena, const unsigned frame) )
+{
+	WorldSettings settings;
+	settings.threads = 2;
+
+	World world(settings);
+	const Scene arena = BuildScene(world, scene);
+
+	TrajectoryComparison result = Passed();
+
+	for (unsigned frame = 0; frame < frames; frame++)
+	{
+		world.Step(1.0f / 60);
+		if (frame % 10 != 0)
+			continue;
+
+		const std::string reason = query(world, arena, frame);
+		if (!reason.empty())
+			Mismatch(result, frame, reason);
+	}
+
+	return result;
+}
+
+static bool SameHit( const RayHit &one, const RayHit &two )
+{
+	return one.shape == two.shape && one.fraction == two.fraction && one.normal.x == two.normal.x && one.normal.y == two.normal.y
+		&& one.point.x == two.point.x && one.point.y == two.point.y;
+}
+
+//rays cast one at a time and in a batch against each shape tested in turn
+static std::string CompareRays( World &world, const Scene &arena, const unsigned frame )
+{
+	std::vector<Ray> rays;
+	GenerateRays(arena, 200, 10, frame + 1, rays);
+
+	std::vector<RayHit> hits;
+	world.RayCast(rays, hits);
+
+	CollisionDetector detector;
+
+	for (unsigned i = 0; i < rays.size(); i++)
+	{
+		RayHit expected;
+		detector.RayCast(world.GetObjects(), rays[i], expected);
+
+		RayHit hit;
+		world.RayCast(rays[i], hit);
+
+		if (!SameHit(hit, expected))
+			return "ray " + std::to_string(i) + " hit differs";
+		if (!SameHit(hits[i], expected))
+			return "batched ray " + std::to_string(i) + " hit differs";
+	}
+
+	return "";
+}
+
+//the grid's ray casts against the brute force detector's
+static TrajectoryComparison CheckRays( const GoldenScene &scene, const unsigned frames )
+{
+	return CheckQueries(scene, frames, CompareRays);
+}
+
+//regions and points queried against each shape tested in turn, every other one leaving debris out
+static std::string CompareRegions( World &world, const Scene &arena, const unsigned frame )
+{
+	std::vector<AABB> regions;
+	GenerateRegions(arena, 100, 4, frame + 1, regions);
+
+	const CollisionFilter noDebris(1, (uint16_t)~debrisCategory);
+	CollisionDetector detector;
+	std::vector<unsigned> found, expected;
+
+	for (unsigned i = 0; i < regions.size(); i++)
+	{
+		const CollisionFilter filter = i % 2 == 0 ? CollisionFilter() : noDebris;
+
+		detector.QueryRegion(world.GetObjects(), regions[i], filter, expected);
+		world.QueryRegion(regions[i], found, filter);
+		if (found != expected)
+			return "region " + std::to_string(i) + " shapes differ";
+
+		//a region with no size is a point
+		AABB point;
+		point.min = point.max = (regions[i].min + regions[i].max) * 0.5f;
+
+		detector.QueryRegion(world.GetObjects(), point, filter, expected);
+		world.QueryPoint(point.min, found, filter);
+		if (found != expected)
+			return "point " + std::to_string(i) + " shapes differ";
+	}
+
+	return "";
+}
+
+//the grid's region and point queries against the brute force detector's
+static TrajectoryComparison CheckRegions( const GoldenScene &scene, const unsigned frames )
+{
+	return CheckQueries(scene, frames, CompareRegions);
+}
+
+//boxes and circles swept through the world against each shape tested in turn
+static std::string CompareShapeCasts( World &world, const Scene &arena, const unsigned frame )
+{
+	std::vector<Ray> paths;
+	GenerateRays(arena, 100, 5, frame + 1, paths);
+
+	CollisionDetector detector;
+
+	for (unsigned i = 0; i < paths.size(); i++)
+	{
+		const Vector2 translation = paths[i].to - paths[i].from;
+		Box box(paths[i].from, 1, 1, (Real)(i * 37 % 360));
+		Circle circle(paths[i].from, 0.5f);
+		const SweptShape swept = i % 2 == 0 ? SweptShape(box, translation) : SweptShape(circle, translation);
+
+		RayHit hit, expected;
+		world.ShapeCast(swept, hit);
+		detector.ShapeCast(world.GetObjects(), swept, expected);
+
+		//shapes don't delete their bodies
+		delete box.GetBody();
+		delete circle.GetBody();
+
+		if (!SameHit(hit, expected))
+			return std::string(i % 2 == 0 ? "box" : "circle") + " cast " + std::to_string(i) + " hit differs";
+	}
+
+	return "";
+}
+
+//the grid's shape casts against the brute force detector's
+static TrajectoryComparison CheckShapeCasts( const GoldenScene &scene, const unsigned frames )
+{
+	return CheckQueries(scene, frames, CompareShapeCasts);
+}
+
+//whether the pair is one that can reuse its contact: a box with a box or a circle (boxes are numbered first)
+static bool CanReuse( const ObjectList &objects, const ShapePair &pair )
+{
+	return pair.a < objects.BoxesSize() && pair.b < objects.BoxesSize() + objects.CirclesSize();
+}
+
+static bool SameContact( const Contact &one, const Contact &two )
+{
+	const Vector2 onePoint = one.GetContactPoint(), twoPoint = two.GetContactPoint();
+	const Vector2 oneNormal = one.GetContactNormal(), twoNormal = two.GetContactNormal();
+	const Real onePenetration = one.GetPenetration(), twoPenetration = two.GetPenetration();
+
+	return memcmp(&onePoint, &twoPoint, sizeof(Vector2)) == 0 && memcmp(&oneNormal, &twoNormal, sizeof(Vector2)) == 0
+		&& memcmp(&onePenetration, &twoPenetration, sizeof(Real)) == 0;
+}
+
+//the first difference between a contact and a fresh one for the same pair, or "". It must be between the same bodies
+//in the same order. A contact the pair can have reused can be out by up to drift, with its normal the same way round;
+//anything else must match exactly
+static std::string CompareContact( const Contact &one, const Contact &two, const bool reused, const float drift, const ShapePair &pair )
+{
+	const std::string shapes = std::to_string(pair.a) + " and " + std::to_string(pair.b);
+
+	if (one.GetBody(0) != two.GetBody(0) || one.GetBody(1) != two.GetBody(1))
+		return "contact bodies swapped for shapes " + shapes;
+
+	if (SameContact(one, two))
+		return "";
+
+	if (ToFloat(one.GetContactNormal() * two.GetContactNormal()) < 0)
+		return "contact normal reversed for shapes " + shapes;
+
+	const Vector2 point = one.GetContactPoint() - two.GetContactPoint();
+	const Vector2 normal = one.GetContactNormal() - two.GetContactNormal();
+	const float error = std::max(std::max(ToFloat(point.Magnitude()), ToFloat(normal.Magnitude())), ToFloat(abs(one.GetPenetration() - two.GetPenetration())));
+
+	if (!reused || error > drift)
+		return "contact differs from a fresh one for shapes " + shapes;
+	return "";
+}
+
+//the first difference between the world's contacts and fresh ones for the same shapes, or "". A pair touching by less
+//than drift can have a reused contact in one and not the other
+static std::string CompareReusedContacts( const World &world, const std::vector<Contact> &fresh, const std::vector<ShapePair> &freshPairs, const float drift )
+{
+	const ObjectList &objects = const_cast<World&>(world).GetObjects();
+	const std::vector<Contact> &contacts = world.GetContacts();
+	const std::vector<ShapePair> &pairs = world.GetContactPairs();
+
+	unsigned i = 0;
+	unsigned j = 0;
+
+	while (i < pairs.size() || j < freshPairs.size())
+	{
+		if (j == freshPairs.size() || (i < pairs.size() && PairBefore(pairs[i], freshPairs[j])))
+		{
+			if (!CanReuse(objects, pairs[i]) || ToFloat(contacts[i].GetPenetration()) > drift)
+				return "contact only in the world for shapes " + std::to_string(pairs[i].a) + " and " + std::to_string(pairs[i].b);
+			i++;
+			continue;
+		}
+
+		if (i == pairs.size() || PairBefore(freshPairs[j], pairs[i]))
+		{
+			if (!CanReuse(objects, freshPairs[j]) || ToFloat(fresh[j].GetPenetration()) > drift)
+				return "contact missing from the world for shapes " + std::to_string(freshPairs[j].a) + " and " + std::to_string(freshPairs[j].b);
+			j++;
+			continue;
+		}
+
+		const std::string reason = CompareContact(contacts[i], fresh[j], CanReuse(objects, pairs[i]), drift, pairs[i]);
+		if (!reason.empty())
+			return reason;
+
+		i++;
+		j++;
+	}
+
+	return "";
+}
+
+//each box pair's fresh contact against the one it is given reused straight after, without moving. Few pairs in the
+//scenes stay still enough to be reused, so this makes sure of it - BoxAndBox makes some contacts from box2's side,
+//with the boxes the other way round, and the reused contact must keep them that way
+static std::string CompareReusedInPlace( const ObjectList &objects, const std::vector<Contact> &fresh, const std::vector<ShapePair> &freshPairs,
+	const WorldSettings &settings, const float drift )
+{
+	CollisionDetector reusing;
+	reusing.SetContactReuse(true, settings.reuseDistance, settings.reuseAngle);
+	std::vector<Contact> contacts;
+
+	for (unsigned i = 0; i < fresh.size(); i++)
+	{
+		const ShapePair &pair = freshPairs[i];
+		if (!CanReuse(objects, pair))
+			continue;
+
+		const Box &box = objects.GetBoxAt(pair.a);
+		PairCache cache;
+		contacts.clear();
+
+		//tested, then reused
+		for (unsigned j = 0; j < 2; j++)
+		{
+			if (pair.b < objects.BoxesSize())
+				reusing.BoxAndBox(box, objects.GetBoxAt(pair.b), contacts, cache);
+			else
+				reusing.BoxAndCircle(box, objects.GetCircleAt(pair.b - objects.BoxesSize()), contacts, cache);
+		}
+
+		if (contacts.size() != 2)
+			return "no contact reused for shapes " + std::to_string(pair.a) + " and " + std::to_string(pair.b);
+
+		const std::string reason = CompareContact(contacts[1], fresh[i], true, drift, pair);
+		if (!reason.empty())
+			return "in place, " + reason;
+	}
+
+	return "";
+}
+
+//every contact a world reusing contacts makes against a fresh narrowphase test of the same shapes, made just before
+//each step with the bodies moved as the step will, and each box pair's reused contact against its fresh one
+static TrajectoryComparison CheckContactReuse( const GoldenScene &scene, const unsigned frames )
+{
+	WorldSettings settings;
+	settings.reuseContacts = true;
+	settings.trackContacts = true;
+
+	World world(settings);
+	BuildScene(world, scene);
+
+	//how far the pair can have moved since it was tested: reuseDistance along each of the box's axes, and reuseAngle
+	//turning the shapes' contact points about their centres, none of which is more than 2 metres out
+	const float drift = ToFloat(settings.reuseDistance)*2 + ToFloat(DegreesToRadians(settings.reuseAngle))*2;
+
+	//keeps its GJK simplexes from step to step, as the world does
+	CollisionDetector detector;
+	std::vector<Contact> fresh;
+	std::vector<ShapePair> freshPairs;
+	std::vector<Body> saved;
+
+	TrajectoryComparison result = Passed();
+
+	for (unsigned frame = 0; frame < frames; frame++)
+	{
+		MoveAsStepWill(world, saved);
+		fresh.clear();
+		freshPairs.clear();
+		detector.GenerateContacts(world.GetObjects(), fresh, freshPairs);
+		std::string reason = CompareReusedInPlace(world.GetObjects(), fresh, freshPairs, settings, drift);
+		PutBack(world, saved);
+
+		world.Step(1.0f / 60);
+
+		if (reason.empty())
+			reason = CompareReusedContacts(world, fresh, freshPairs, drift);
+		if (!reason.empty())
+			Mismatch(result, frame, reason);
+	}
+
+	return result;
+}
+
+static const GoldenCheck checks[] =
+{
+	{"tuning", CheckTuning},
+	{"pairs", CheckPairs},
+	{"contacts", CheckContactEvents},
+	{"sensors", CheckSensorEvents},
+	{"rays", CheckRays},
+	{"regions", CheckRegions},
+	{"casts", CheckShapeCasts},
+	{"reuse", CheckContactReuse},
+};
+
+static const unsigned checkCount = sizeof(checks) / sizeof(checks[0]);
+
+// Main //
+int main(int argc, char *argv[])
+{
+	unsigned frames = 240;
+	const char *sceneFilter = NULL;
+	const char *configFilter = NULL;
+	const char *recordDirectory = NULL;
+	const char *goldenDirectory = NULL;
+	bool list = false;
+	bool valid = true;
+
+	for (int i = 1; i < argc && valid; i++)
+	{
+		const bool hasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--frames") == 0 && hasValue)
+			frames = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--scene") == 0 && hasValue)
+			sceneFilter = argv[++i];
+		else if (strcmp(argv[i], "--config") == 0 && hasValue)
+			configFilter = argv[++i];
+		else if (strcmp(argv[i], "--record") == 0 && hasValue)
+			recordDirectory = argv[++i];
+		else if (strcmp(argv[i], "--golden") == 0 && hasValue)
+			goldenDirectory = argv[++i];
+		else if (strcmp(argv[i], "--list") == 0)
+			list = true;
+		else
+			valid = false;
+	}
+
+	if (!valid)
+	{
+		fprintf(stderr, "usage: %s [--frames n] [--scene name] [--config name] [--record dir] [--golden dir] [--list]\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<GoldenConfig> configs = MakeConfigs();
+
+	if (list)
+	{
+		for (unsigned s = 0; s < sceneCount; s++)
+			printf("scene %s\n", scenes[s].name);
+		for (unsigned c = 0; c < configs.size(); c++)
+			printf("config %s (%s)\n", configs[c].name, configs[c].tolerance.exact ? "exact" : "tolerance, resynced every step");
+		for (unsigned c = 0; c < checkCount; c++)
+			printf("config %s (exact, check)\n", checks[c].name);
+		return 0;
+	}
+
+	bool passed = true;
+	Trajectory reference;
+	Trajectory candidate;
+
+	printf("scene,config,mode,result,bad_frames,first_bad_frame,position_error,velocity_error,orientation_error,normal_error,contact_mismatches,reason\n");
+
+	for (unsigned s = 0; s < sceneCount; s++)
+	{
+		const GoldenScene &scene = scenes[s];
+		if (sceneFilter && strcmp(sceneFilter, scene.name) != 0)
+			continue;
+
+		// Reference
+		if (recordDirectory)
+		{
+			RunReference(scene, frames, reference);
+
+			std::string filename = std::string(recordDirectory) + "/" + scene.name + ".traj";
+			if (!reference.Save(filename))
+			{
+				fprintf(stderr, "could not write %s\n", filename.c_str());
+				return 1;
+			}
+
+			fprintf(stderr, "recorded %s (%u frames)\n", filename.c_str(), reference.FrameCount());
+			continue;
+		}
+
+		unsigned sceneFrames = frames;
+
+		if (goldenDirectory)
+		{
+			std::string filename = std::string(goldenDirectory) + "/" + scene.name + ".traj";
+			if (!reference.Load(filename))
+			{
+				fprintf(stderr, "could not read %s (missing, or recorded by a build with a different Real)\n", filename.c_str());
+				return 1;
+			}
+			sceneFrames = reference.FrameCount();
+		}
+		else
+		{
+			RunReference(scene, frames, reference);
+		}
+
+		// Configurations
+		for (unsigned c = 0; c < configs.size(); c++)
+		{
+			const GoldenConfig &config = configs[c];
+			if (configFilter && strcmp(configFilter, config.name) != 0)
+				continue;
+
+			Run(scene, config.settings, config.trig, sceneFrames, candidate, config.resync ? &reference : NULL);
+			TrajectoryComparison result = CompareTrajectories(reference, candidate, config.tolerance);
+
+			printf("%s,%s,%s,%s,%u,%d,%g,%g,%g,%g,%u,%s\n", scene.name, config.name, config.tolerance.exact ? "exact" : "tolerance",
+				result.matches ? "pass" : "FAIL", result.badFrames, result.firstBadFrame, result.positionError, result.velocityError,
+				result.orientationError, result.normalError, result.contactMismatches, result.reason.c_str());
+
+			passed = passed && result.matches;
+		}
+
+		// Checks
+		for (unsigned c = 0; c < checkCount; c++)
+		{
+			const GoldenCheck &check = checks[c];
+			if (configFilter && strcmp(configFilter, check.name) != 0)
+				continue;
+
+			TrajectoryComparison result = check.run(scene, sceneFrames);
+
+			printf("%s,%s,check,%s,%u,%d,%g,%g,%g,%g,%u,%s\n", scene.name, check.name, result.matches ? "pass" : "FAIL", result.badFrames,
+				result.firstBadFrame, result.positionError, result.velocityError, result.orientationError, result.normalError,
+				result.contactMismatches, result.reason.c_str());
+
+			passed = passed && result.matches;
+		}
+	}
+
+	return passed ? 0 : 1;
+}